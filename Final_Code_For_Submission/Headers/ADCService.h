@@ -0,0 +1,29 @@
+/****************************************************************************
+
+  Header file for the background ADC sampling module
+
+ ****************************************************************************/
+
+#ifndef ADCService_H
+#define ADCService_H
+
+#include "Headers.h"
+
+#define MAX_ADC_CHANNELS 4
+
+// What is wired to each channel
+#define KART_SELECT_CHANNEL 0
+#define BATTERY_CHANNEL 1
+#define LEFT_TAPE_CHANNEL 2
+#define RIGHT_TAPE_CHANNEL 3
+#define NUM_ADC_CHANNELS 4
+
+/*----------------------- Public Function Prototypes ----------------------*/
+bool InitADCService( uint8_t HowMany, uint16_t Rate );
+void SetADCSampleRate( uint16_t Rate );
+void ADCSampleResponse( void );
+uint16_t QueryADCLatest( uint8_t Channel );
+uint32_t QueryADCSampleCount( void );
+uint8_t ReadADCHistory( uint8_t Channel, uint16_t *Samples, uint8_t Count );
+
+#endif /* ADCService_H */
@@ -18,11 +18,17 @@
 #include "bitdefs.h"
 
 /*----------------------------- Module Defines ----------------------------*/
-typedef enum {ShooterReady, ShooterResetting}ShooterState;
+typedef enum {ShooterReady, ShooterResetting, ShooterFiring}ShooterState;
+
+// Balls fired per beacon lock until SetShotCount changes it
+#define DEFAULT_SHOT_COUNT 3
 
 /*----------------------- Public Function Prototypes ----------------------*/
 bool InitBallShooter ( void );
 ES_Event RunBallShooter ( ES_Event ThisEvent );									
 void FireBallShooter(void);
+void SetShotCount( uint8_t Count );
+uint8_t QueryShotCount( void );
+uint16_t QueryBurstTime( void );
 
 #endif /*BallShooter_H*/
@@ -0,0 +1,19 @@
+/****************************************************************************
+
+  Header file for the battery monitor
+
+ ****************************************************************************/
+
+#ifndef Battery_H
+#define Battery_H
+
+#include "Headers.h"
+
+/*----------------------- Public Function Prototypes ----------------------*/
+uint16_t QueryBatteryMillivolts( void );
+float QueryDutyScale( void );
+
+ES_Event RunBattery ( ES_Event CurrentEvent );
+void StartBattery ( ES_Event CurrentEvent );
+
+#endif /* Battery_H */
@@ -0,0 +1,44 @@
+/****************************************************************************
+
+  Header file for the beacon detector
+
+ ****************************************************************************/
+
+#ifndef BeaconDetector_H
+#define BeaconDetector_H
+
+#include "Headers.h"
+
+// Number of beacon bands that can be tracked at once, band 0 is our target
+#define MAX_BEACON_BANDS 4
+#define BEACON_TARGET_BAND 0
+
+// DetectedBeacon packs the band in the top bits of EventParam and the time
+// since the center of the beacon (ES timer ticks) in the rest
+#define BEACON_BAND_SHIFT 14
+#define BEACON_TIME_MASK ((1 << BEACON_BAND_SHIFT) - 1)
+#define BEACON_EVENT_BAND(Param) ((Param) >> BEACON_BAND_SHIFT)
+#define BEACON_EVENT_TIME(Param) ((Param) & BEACON_TIME_MASK)
+
+// Range of capture periods (40MHz ticks) for one beacon
+typedef struct {
+			uint32_t		Low;
+			uint32_t		High;
+			bool				Target;					// False for beacons we only want to recognize
+			bool				Enabled;
+} BEACON_BAND_t;
+
+/*----------------------- Public Function Prototypes ----------------------*/
+bool InitBeaconCaptureResponse( void );
+void BeaconCaptureResponse( void );
+void StartBeaconSweep( void );
+void StopBeaconSweep( void );
+uint16_t QueryBeaconBearing( uint8_t Band );
+bool CheckBeaconSweep( void );
+bool SetBeaconBand( uint8_t Band, uint32_t Low, uint32_t High, bool Target );
+void ClearBeaconBand( uint8_t Band );
+uint8_t QueryBeaconConfidence( uint8_t Band );
+uint8_t QueryDetectedBand( void );
+uint32_t QueryBeaconPeriod( void );
+
+#endif /* BeaconDetector_H */
@@ -0,0 +1,49 @@
+/****************************************************************************
+
+  Header file for the calibration store
+
+ ****************************************************************************/
+
+#ifndef CalStore_H
+#define CalStore_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Calibration records. The position is the ID stored in the EEPROM, so new
+// records go on the end and a record that is no longer used keeps its place.
+typedef enum {
+			// Wheel speed PI loop (float), only read by EncoderService.c which
+			// isn't in the MasterCode build. Kept for an encoder build.
+			CAL_P_GAIN,
+			CAL_I_GAIN,
+			CAL_ROTATION_TIME,		// ms for one full turn on the spot
+			CAL_PIXELS_PER_3SEC,	// Distance covered at half speed in 3 s
+			CAL_BEACON_LOW,				// Our beacon's period band (timer ticks)
+			CAL_BEACON_HIGH,
+			CAL_SHOOTER_SET,			// Flicker servo widths (uS)
+			CAL_SHOOTER_FLICK,
+			CAL_SHOOTER_RESET,
+			CAL_HOPPER_SET,				// Hopper servo widths (uS)
+			CAL_HOPPER_RELEASE,
+			CAL_KART_SELECT_LOW,	// Kart select ADC counts, below is kart 3
+			CAL_KART_SELECT_HIGH,	// and above is kart 1
+			CAL_HALF_SPEED_PORT,	// Motor duties (%) for half and quarter speed
+			CAL_HALF_SPEED_STARBOARD,
+			CAL_QUARTER_SPEED_PORT,
+			CAL_QUARTER_SPEED_STARBOARD,
+			NUM_CAL_RECORDS
+} CalId_t;
+
+/*----------------------- Public Function Prototypes ----------------------*/
+bool InitCalStore( void );
+uint16_t GetCalU16( CalId_t Id );
+float GetCalFloat( CalId_t Id );
+bool SetCalU16( CalId_t Id, uint16_t Value );
+bool SetCalFloat( CalId_t Id, float Value );
+uint32_t GetCalRaw( CalId_t Id );
+bool SetCalRaw( CalId_t Id, uint32_t Value );
+bool QueryCalInfo( CalId_t Id, const char **pName, bool *pIsFloat );
+void ResetCalStore( void );
+
+#endif /* CalStore_H */
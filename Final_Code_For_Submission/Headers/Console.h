@@ -0,0 +1,50 @@
+/****************************************************************************
+
+  Header file for the binary tuning console
+
+ ****************************************************************************/
+
+#ifndef Console_H
+#define Console_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Frames both ways are
+//   CONSOLE_SYNC, command, payload length, payload, CRC-16 low, CRC-16 high
+// with the CRC (CCITT, starting at 0xFFFF) over the command, length and
+// payload. Everything is little endian. Tools/console.py is the host side.
+#define CONSOLE_SYNC 0xA5
+#define CONSOLE_MAX_PAYLOAD 48
+// Sync, command, length and the CRC
+#define CONSOLE_FRAME_OVERHEAD 5
+
+// Commands from the host. The reply has the same command with
+// CONSOLE_REPLY set and starts with a CONSOLE_STATUS_t byte.
+#define CONSOLE_PING 0x01					// -> version, records, events, telemetry channels
+#define CONSOLE_PARAM_INFO 0x02		// id -> id, is float, value, name
+#define CONSOLE_PARAM_GET 0x03		// id -> id, value
+#define CONSOLE_PARAM_SET 0x04		// id, value -> id, value now
+#define CONSOLE_PARAM_RESET 0x05	// Every parameter back to its default
+#define CONSOLE_POST_EVENT 0x06		// event type, param (16 bits each)
+#define CONSOLE_TELEMETRY 0x07			// channel, decimation pairs, 0 turns it off
+#define CONSOLE_TELEMETRY_INFO 0x08	// channel -> channel, decimation, name
+#define CONSOLE_TELEMETRY_STOP 0x09	// Every channel off
+#define CONSOLE_REPLY 0x80
+
+// Telemetry frame, see Telemetry.c
+#define CONSOLE_TELEMETRY_DATA 0x40
+
+typedef enum {
+			CONSOLE_OK,
+			CONSOLE_BAD_COMMAND,
+			CONSOLE_BAD_LENGTH,
+			CONSOLE_BAD_ID,
+			CONSOLE_REJECTED
+} CONSOLE_STATUS_t;
+
+/*----------------------- Public Function Prototypes ----------------------*/
+bool Check4Console( void );
+bool SendConsoleFrame( uint8_t Command, const uint8_t *Payload, uint8_t Length );
+
+#endif /* Console_H */
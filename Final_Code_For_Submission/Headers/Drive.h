@@ -8,12 +8,23 @@
 #define Drive_H
 
 #include "Headers.h"
+#include "Points.h"
+
+// Time between wheel speed setpoints on CONTROL_TIMER
+#define CONTROL_TICK 20
+
+// Lowest duty that still turns the wheels over, SetWheelSpeeds maps a
+// speed of 0 to 1 onto this up to the half speed duty
+#define MIN_DRIVE_DUTY 30
 
 /*----------------------- Public Function Prototypes ----------------------*/
 void Calculate( uint16_t X, uint16_t Y );
 void DriveForward( void );
 void TurnTheta( void );
+void TurnToHeading( uint16_t Theta );
 bool CheckVal ( uint16_t val, int select);
+void SetWheelSpeeds( float PortSpeed, float StarboardSpeed );
+POINT_t QueryDriveTarget( void );
 
 ES_Event RunDrive ( ES_Event CurrentEvent );
 void StartDrive (ES_Event CurrentEvent );
@@ -6,7 +6,7 @@
 #ifndef Driving_H
 #define Driving_H
 
-typedef enum { AtPositionState, GeneratePathState, TurningState, DrivingForwardState } DrivingState ;
+typedef enum { AtPositionState, GeneratePathState, TurningState, DrivingForwardState, FollowingPathState } DrivingState ;
 
 // Public Function Prototypes
 ES_Event RunDriving( ES_Event CurrentEvent );
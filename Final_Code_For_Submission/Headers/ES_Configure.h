@@ -280,43 +280,55 @@ typedef enum {  ES_NO_EVENT = 0,
 								ToDriving,
 								ToShooting,
 								ToObstacle,
+								ServoSequenceDone,
+								BallsFired,
+								KartUpdated,			/* EventParam is a pooled KART_t */
 								//THESE ARE ONLY FOR CHECKPOINT3
 								Waypoint_BR,
 								Waypoint_TR,
 								Waypoint_TL,
 								Waypoint_BL,
 								Waypoint_S,
-								Waypoint_O} ES_EventTyp_t ;
+								Waypoint_O,
+								NUM_ES_EVENTS				/* must be last, sizes the state machine lookups */
+								} ES_EventTyp_t ;
 
 /****************************************************************************/
-// These are the definitions for the Distribution lists. Each definition
-// should be a comma separated list of post functions to indicate which
-// services are on that distribution list.
-#define NUM_DIST_LISTS 1
-#if NUM_DIST_LISTS > 0 
-#define DIST_LIST0 PostMaster
-#endif
-#if NUM_DIST_LISTS > 1 
-#define DIST_LIST1 PostTestHarnessService1, PostTestHarnessService1
-#endif
-#if NUM_DIST_LISTS > 2 
-#define DIST_LIST2 PostTemplateFSM
-#endif
-#if NUM_DIST_LISTS > 3 
-#define DIST_LIST3 PostTemplateFSM
-#endif
-#if NUM_DIST_LISTS > 4 
-#define DIST_LIST4 PostTemplateFSM
-#endif
-#if NUM_DIST_LISTS > 5 
-#define DIST_LIST5 PostTemplateFSM
-#endif
-#if NUM_DIST_LISTS > 6 
-#define DIST_LIST6 PostTemplateFSM
-#endif
-#if NUM_DIST_LISTS > 7 
-#define DIST_LIST7 PostTemplateFSM
-#endif
+// Event payload pool. Events of the types in POOLED_EVENTS carry a handle
+// to a block of EVENT_POOL_BLOCK_SIZE bytes in EventParam, see
+// ES_EventPool.c
+#define EVENT_POOL_BLOCKS 8
+#define EVENT_POOL_BLOCK_SIZE 16
+#define POOLED_EVENTS KartUpdated
+
+/****************************************************************************/
+// Event bus. Services subscribe to event types in their init functions and
+// published events go to every subscriber, see ES_EventBus.c. This is the
+// most subscriptions filtered on EventParam there can be at once.
+#define EVENT_BUS_FILTERS 8
+
+/****************************************************************************/
+// Most events ES_Run posts back from the priority deferral queues each time
+// the service queues run empty, see ES_DeferRecall.c. Keep it below the
+// smallest queue size so a recall leaves room for new events.
+#define DEFER_RECALL_BUDGET 2
+
+/****************************************************************************/
+// Coalesced events. These only say what the newest value is, so a post of
+// one of these types overwrites the event of the same type still waiting
+// in the queue instead of taking a new entry. ES_QueryMergeCount says how
+// many have been merged. Types whose order against each other matters,
+// like AtRatio and OffRatio, must not go here.
+#define COALESCED_EVENTS EV_DRSNewQuery, KartUpdated
+
+/****************************************************************************/
+// Deadline monitor, see ES_Watchdog.c. A run function that takes longer than
+// DISPATCH_BUDGET_MS is reported. After DEADLINE_STRIKES of those in a row
+// the watchdog is no longer fed, and it resets the board WATCHDOG_TIMEOUT_MS
+// after the last feed.
+#define DISPATCH_BUDGET_MS 10
+#define DEADLINE_STRIKES 3
+#define WATCHDOG_TIMEOUT_MS 500
 
 /****************************************************************************/
 // This are the name of the Event checking funcion header file. 
@@ -324,7 +336,7 @@ typedef enum {  ES_NO_EVENT = 0,
 
 /****************************************************************************/
 // This is the list of event checking functions 
-#define EVENT_CHECK_LIST Check4Keystroke
+#define EVENT_CHECK_LIST Check4Console, CheckTelemetry, CheckBeaconSweep
 
 /****************************************************************************/
 // These are the definitions for the post functions to be executed when the
@@ -345,9 +357,9 @@ typedef enum {  ES_NO_EVENT = 0,
 #define TIMER9_RESP_FUNC PostMaster
 #define TIMER10_RESP_FUNC PostMaster
 #define TIMER11_RESP_FUNC PostMaster
-#define TIMER12_RESP_FUNC TIMER_UNUSED
-#define TIMER13_RESP_FUNC TIMER_UNUSED
-#define TIMER14_RESP_FUNC TIMER_UNUSED
+#define TIMER12_RESP_FUNC PostMaster
+#define TIMER13_RESP_FUNC PostMaster
+#define TIMER14_RESP_FUNC PostMaster
 #define TIMER15_RESP_FUNC TIMER_UNUSED
 
 /****************************************************************************/
@@ -365,10 +377,13 @@ typedef enum {  ES_NO_EVENT = 0,
 #define OBS_TIMER 5
 #define OFF_TAPE_TIMER 6
 #define BACK_TO_COURSE_TIMER 7
-#define BALL_SHOOTER_TIMER 8
+#define SERVO_TIMER 8
 #define CHECK_TIMER 9
 #define NITRO_TIMER 10
 #define GIVE_UP_TIMER 11 //currently not used
-#define numTimers 12
+#define CONTROL_TIMER 12
+#define BATTERY_TIMER 13
+#define KART_SELECT_TIMER 14
+#define numTimers 15
 
 #endif /* CONFIGURE_H */
@@ -3,6 +3,30 @@
 
 #include "ES_Queue.h"
 #include "ES_Events.h"
+#include "ES_EventBus.h"
+
+// One event held in a deferral queue made with ES_InitDeferral
+typedef struct {
+    ES_Event Event;
+    uint16_t Expires;     // ES_Timer_GetTime() when it goes stale
+    uint8_t Priority;     // higher is recalled first
+    bool CanExpire;
+}ES_DeferredEvent_t;
+
+// A deferral queue. Declare one along with an array of entries for it and
+// set it up with ES_InitDeferral, the framework recalls from it.
+typedef struct ES_DeferralQueue {
+    ES_DeferredEvent_t *pEntries;
+    uint8_t Size;
+    uint8_t NumEntries;
+    pPostFunc PostFunc;           // where recalled events go
+    bool Recalling;
+    struct ES_DeferralQueue *pNext;
+}ES_DeferralQueue_t;
+
+// Lifetime (ES timer ticks) for an event that stays deferred until it is
+// recalled
+#define ES_DEFER_FOREVER 0
 
 /****************************************************************************
  Function
@@ -26,17 +50,17 @@
 
 /****************************************************************************
  Function
-   ES_DeferEvent  (wrapper for ES_EnQueueLIFO)
-   this is a straight re-naming to aid readability
+   ES_DeferEvent
  Parameters
    ES_Event * pBlock : pointer to the block of memory in use as the Queue
    ES_Event Event2Add : event to be added to the Queue
  Returns
    bool : true if the add was successful, false if not
  Description
-   if it will fit, adds Event2Add to the Queue
+   if it will fit, adds Event2Add to the Queue LIFO, holding its payload
+   until it is recalled
  ***************************************************************************/
-#define ES_DeferEvent( a,b ) ES_EnQueueLIFO( a, b )
+bool ES_DeferEvent( ES_Event * pBlock, ES_Event Event2Add );
 
 /****************************************************************************
  Function
@@ -58,4 +82,15 @@
 ****************************************************************************/
 bool ES_RecallEvents( uint8_t WhichService, ES_Event * pBlock );
 
+/* prototypes for the priority deferral queues, see ES_DeferRecall.c */
+void ES_DeferRecall_Init( void );
+void ES_DeferRecall_Run( void );
+void ES_InitDeferral( ES_DeferralQueue_t *pQueue, ES_DeferredEvent_t *pEntries,
+                      uint8_t Size, pPostFunc PostFunc );
+bool ES_DeferEventWith( ES_DeferralQueue_t *pQueue, ES_Event Event2Add,
+                        uint8_t Priority, uint16_t Lifetime );
+void ES_RecallDeferred( ES_DeferralQueue_t *pQueue );
+void ES_FlushDeferred( ES_DeferralQueue_t *pQueue );
+uint8_t ES_QueryDeferred( ES_DeferralQueue_t *pQueue );
+
 #endif
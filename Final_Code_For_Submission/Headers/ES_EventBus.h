@@ -0,0 +1,33 @@
+/****************************************************************************
+ Module
+     ES_EventBus.h
+ Description
+     header file for the publish/subscribe event bus of the Events &
+     Services framework
+ Notes
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/19/26 11:15 Alex     started coding, replaces ES_PostList.h
+*****************************************************************************/
+#ifndef ES_EventBus_H
+#define ES_EventBus_H
+
+#include "ES_Types.h"
+#include "ES_Events.h"
+
+typedef bool PostFunc_t( ES_Event );
+
+typedef PostFunc_t (*pPostFunc);
+
+/* prototypes for public functions */
+void ES_EventBus_Init( void );
+bool ES_EventBus_Subscribe( uint8_t WhichService, ES_EventTyp_t EventType );
+bool ES_EventBus_SubscribeFiltered( uint8_t WhichService, ES_EventTyp_t EventType,
+                                    uint16_t ParamMask, uint16_t ParamValue );
+void ES_EventBus_Unsubscribe( uint8_t WhichService, ES_EventTyp_t EventType );
+bool ES_EventBus_Publish( ES_Event ThisEvent );
+uint16_t ES_EventBus_QuerySubscribers( ES_Event ThisEvent );
+
+#endif /* ES_EventBus_H */
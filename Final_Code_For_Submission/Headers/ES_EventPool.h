@@ -0,0 +1,33 @@
+/****************************************************************************
+ Module
+     ES_EventPool.h
+ Description
+     header file for the event payload pool of the Events & Services
+     framework
+ Notes
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/19/26 09:40 Alex     started coding
+*****************************************************************************/
+#ifndef ES_EventPool_H
+#define ES_EventPool_H
+
+#include "ES_Types.h"
+#include "ES_Events.h"
+
+// EventParam of a pooled event that has no payload
+#define ES_NO_PAYLOAD 0
+
+/* prototypes for public functions */
+void ES_EventPool_Init( void );
+uint16_t ES_EventPool_Alloc( uint8_t Size, void **pPayload );
+void *ES_EventPool_Get( uint16_t Handle );
+void ES_EventPool_Release( uint16_t Handle );
+bool ES_EventPool_IsPooled( ES_EventTyp_t EventType );
+void ES_EventPool_HoldEvent( ES_Event ThisEvent );
+void ES_EventPool_ReleaseEvent( ES_Event ThisEvent );
+uint8_t ES_EventPool_QueryFree( void );
+
+#endif /* ES_EventPool_H */
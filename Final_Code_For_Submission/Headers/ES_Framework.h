@@ -8,6 +8,10 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/19/26 19:20 Alex     added ES_QueryQueuePeak prototype
+ 10/19/26 15:40 Alex     include ES_Watchdog.h for the deadline monitor
+ 10/19/26 14:30 Alex     added ES_QueryMergeCount prototype
+ 10/19/26 11:15 Alex     ES_EventBus.h replaces ES_PostList.h
  11/02/13 17:06 jec      added ES_PostToServiceLIFO prototype
  08/05/13 15:00 jec      added #include for ES_Port.h to get portability stuff
  10/17/06 07:41 jec      started coding
@@ -20,9 +24,11 @@
 #include "ES_Types.h"
 #include "ES_General.h"
 #include "ES_CheckEvents.h"
-#include "ES_PostList.h"
+#include "ES_EventBus.h"
 #include "ES_Events.h"
 #include "ES_Timers.h"
+#include "ES_EventPool.h"
+#include "ES_Watchdog.h"
 
 typedef enum {
               Success = 0,
@@ -38,5 +44,7 @@ ES_Return_t ES_Run( void );
 bool ES_PostAll( ES_Event ThisEvent );
 bool ES_PostToService( uint8_t WhichService, ES_Event ThisEvent);
 bool ES_PostToServiceLIFO( uint8_t WhichService, ES_Event TheEvent);
+uint16_t ES_QueryMergeCount( ES_EventTyp_t EventType );
+uint8_t ES_QueryQueuePeak( uint8_t WhichService );
 
 #endif   // ES_Framework_H
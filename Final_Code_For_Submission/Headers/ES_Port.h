@@ -9,6 +9,7 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/19/26 15:40 Alex    added the hardware watchdog prototypes
  01/18/15 13:24 jec     cleaned up and removed ASM functions that were not 
                         needed and screwing up the code completion in uVision
  03/13/14		joa		      Updated files to use with Cortex M4 processor core.
@@ -95,5 +96,7 @@ void _HW_Timer_Init(TimerRate_t Rate);
 bool _HW_Process_Pending_Ints( void );
 uint16_t _HW_GetTickCount(void);
 void ConsoleInit(void);
+void _HW_Watchdog_Init(uint16_t TimeoutMS);
+void _HW_Watchdog_Feed(void);
 
 #endif
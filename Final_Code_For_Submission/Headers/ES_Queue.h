@@ -9,6 +9,8 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/19/26 19:20 Alex     added ES_QueueCount
+ 10/19/26 14:30 Alex     added ES_EnQueueReplace for coalesced events
  08/05/13 15:19 jec      modifications to suit new portable type definitions
  01/15/12 09:36 jec      converted to use new types from ES_Types.h
  10/17/11 07:49 jec      new header to match the rest of the framework
@@ -25,9 +27,11 @@
 uint8_t ES_InitQueue( ES_Event * pBlock, uint8_t BlockSize );
 bool ES_EnQueueFIFO( ES_Event * pBlock, ES_Event Event2Add );
 bool ES_EnQueueLIFO( ES_Event * pBlock, ES_Event Event2Add );
+bool ES_EnQueueReplace( ES_Event * pBlock, ES_Event Event2Add, ES_Event * pReplaced );
 uint8_t ES_DeQueue( ES_Event * pBlock, ES_Event * pReturnEvent );
 //void EF_FlushQueue( unsigned char * pBlock );
 bool ES_IsQueueEmpty( ES_Event * pBlock );
+uint8_t ES_QueueCount( ES_Event * pBlock );
 
 #endif /*ES_Queue_H */
 
@@ -47,6 +47,9 @@ ES_TimerReturn_t ES_Timer_StartTimer(uint8_t Num);
 ES_TimerReturn_t ES_Timer_StopTimer(uint8_t Num);
 ES_TimerReturn_t ES_Timer_IsTimerActive(uint8_t Num);
 uint16_t         ES_Timer_GetTime(void);
+void             ES_Timer_FreezeGroup(uint16_t Group);
+void             ES_Timer_ThawGroup(uint16_t Group);
+void             ES_Timer_FlushGroup(uint16_t Group);
 
 bool ES_Timer_isActive( uint8_t Num );
 
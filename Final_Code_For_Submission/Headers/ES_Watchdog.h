@@ -0,0 +1,43 @@
+/****************************************************************************
+ Module
+     ES_Watchdog.h
+ Description
+     header file for the run to completion deadline monitor and watchdog of
+     the Events & Services framework
+ Notes
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/19/26 15:40 Alex     started coding
+*****************************************************************************/
+#ifndef ES_Watchdog_H
+#define ES_Watchdog_H
+
+#include "ES_Types.h"
+#include "ES_Events.h"
+
+// Returns the state a service's machines are in, packed into 16 bits
+typedef uint16_t ES_StateQuery_t( void );
+
+// One dispatch that went over DISPATCH_BUDGET_MS
+typedef struct {
+    ES_Event Event;       // event being run
+    uint16_t Duration;    // ms the run function took
+    uint16_t When;        // tick count when it returned
+    uint16_t State;       // from the service's state query, 0 if none
+    uint8_t Service;      // priority of the service
+}ES_Overrun_t;
+
+/* prototypes for public functions */
+void ES_Watchdog_Init( void );
+void ES_Watchdog_SetStateQuery( uint8_t WhichService, ES_StateQuery_t *QueryFunc );
+void ES_Watchdog_Start( void );
+uint16_t ES_Watchdog_BeginDispatch( void );
+void ES_Watchdog_EndDispatch( uint8_t WhichService, ES_Event ThisEvent, uint16_t Started );
+void ES_Watchdog_Idle( void );
+uint16_t ES_Watchdog_QueryOverruns( void );
+bool ES_Watchdog_GetWorstOverrun( ES_Overrun_t *pOverrun );
+bool ES_Watchdog_GetLastOverrun( ES_Overrun_t *pOverrun );
+
+#endif /* ES_Watchdog_H */
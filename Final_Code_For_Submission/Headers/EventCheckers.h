@@ -8,6 +8,8 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/19/26 19:20 Alex     added CheckTelemetry
+ 10/19/26 18:10 Alex     Check4Console replaces Check4Keystroke
  08/06/13 14:37 jec      started coding
 *****************************************************************************/
 
@@ -16,7 +18,9 @@
 
 // prototypes for event checkers
 
-bool Check4Keystroke(void);
+bool Check4Console(void);
+bool CheckTelemetry(void);
+bool CheckBeaconSweep(void);
 
 
 #endif /* EventCheckers_H */
@@ -0,0 +1,66 @@
+/****************************************************************************
+
+  Header file for the table driven hierarchical state machine engine
+
+ ****************************************************************************/
+
+#ifndef HSM_H
+#define HSM_H
+
+#include "Headers.h"
+
+// Target for a transition that runs its action without leaving the state
+#define HSM_INTERNAL 0xFE
+// Lookup entry for an event the state has no transition for
+#define HSM_NO_TRANSITION 0xFF
+
+// Bytes of lookup storage a machine with this many states needs
+#define HSM_LOOKUP_SIZE(NumStates) ((NumStates)*NUM_ES_EVENTS)
+
+// Entry and exit hooks get ES_ENTRY, ES_ENTRY_HISTORY or ES_EXIT
+typedef void (*HSMHook_t)( const ES_Event *Event );
+// During hooks run the lower machines and may consume or remap the event
+typedef void (*HSMDuring_t)( ES_Event *Event );
+typedef bool (*HSMGuard_t)( const ES_Event *Event );
+typedef void (*HSMAction_t)( const ES_Event *Event );
+
+// One row of a state's transition table. Rows for the same event must be
+// next to each other, the first one whose guard passes is taken.
+typedef struct {
+			ES_EventTyp_t		Event;
+			uint8_t					Target;				// State index or HSM_INTERNAL
+			HSMGuard_t			Guard;				// NULL to always take it
+			HSMAction_t			Action;				// Run between exit and entry, may be NULL
+			bool						History;			// Enter the target with ES_ENTRY_HISTORY
+			const char			*Trace;				// Printed when taken, may be NULL
+} HSM_TRANSITION_t;
+
+typedef struct {
+			const char							*Name;
+			HSMHook_t								Entry;
+			HSMHook_t								Exit;
+			HSMDuring_t							During;
+			const HSM_TRANSITION_t	*Transitions;
+			uint8_t									NumTransitions;
+} HSM_STATE_t;
+
+// Runtime state of one machine, set up with HSM_MACHINE
+typedef struct {
+			const HSM_STATE_t		*States;
+			uint8_t							NumStates;
+			uint8_t							*Lookup;				// First transition row per state and event
+			uint8_t							CurrentState;
+			bool								Built;					// Lookup has been filled in
+			bool								Started;				// CurrentState is valid history
+} HSM_t;
+
+#define HSM_TRANSITIONS(Table) (Table), (sizeof(Table)/sizeof((Table)[0]))
+#define HSM_MACHINE(States, Lookup) \
+	{ (States), (sizeof(States)/sizeof((States)[0])), (Lookup), 0, false, false }
+
+/*----------------------- Public Function Prototypes ----------------------*/
+bool HSM_Start( HSM_t *Machine, uint8_t InitialState, const ES_Event *EntryEvent );
+bool HSM_Run( HSM_t *Machine, ES_Event *Event );
+uint8_t HSM_Query( const HSM_t *Machine );
+
+#endif /* HSM_H */
@@ -18,6 +18,7 @@
 #include "ES_Port.h"
 #include "ES_Types.h"
 #include "ES_Events.h"
+#include "ES_DeferRecall.h"
 
 // TIVA Headers
 #include "inc/hw_memmap.h"
@@ -46,6 +47,19 @@
 #include "Points.h"
 #include "DriveAlgorithm.h"
 #include "ADMulti.h"
+#include "MotionProfile.h"
+#include "PathFollower.h"
+#include "RacingLine.h"
+#include "Opponents.h"
+#include "BeaconDetector.h"
+#include "ADCService.h"
+#include "Battery.h"
+#include "KartSelect.h"
+#include "LineFollower.h"
+#include "ShotPlanner.h"
+#include "ServoSequencer.h"
+#include "HSM.h"
+#include "CalStore.h"
 
 // Defines
 #define ONE_SEC 976
@@ -0,0 +1,18 @@
+/****************************************************************************
+
+  Header file for the kart select self-test
+
+ ****************************************************************************/
+
+#ifndef KartSelect_H
+#define KartSelect_H
+
+#include "Headers.h"
+
+/*----------------------- Public Function Prototypes ----------------------*/
+bool QueryKartSelectDone( void );
+
+ES_Event RunKartSelect ( ES_Event CurrentEvent );
+void StartKartSelect ( ES_Event CurrentEvent );
+
+#endif /* KartSelect_H */
@@ -0,0 +1,19 @@
+/****************************************************************************
+
+  Header file for the tape line follower
+
+ ****************************************************************************/
+
+#ifndef LineFollower_H
+#define LineFollower_H
+
+#include "Headers.h"
+
+/*----------------------- Public Function Prototypes ----------------------*/
+void StartLineFollower( float Speed );
+void SetLineFollowerSpeed( float Speed );
+void StopLineFollower( void );
+void UpdateLineFollower( void );
+bool QueryLineError( float *Error );
+
+#endif /* LineFollower_H */
@@ -12,6 +12,7 @@ ES_Event RunMaster( ES_Event CurrentEvent );
 void StartMaster ( ES_Event CurrentEvent );
 bool PostMaster( ES_Event ThisEvent );
 bool InitMaster ( uint8_t Priority );
+uint16_t QueryMasterState( void );
 
 #endif /*MasterMachine_H */
 
@@ -0,0 +1,30 @@
+/****************************************************************************
+
+  Header file for the motion profile module
+
+ ****************************************************************************/
+
+#ifndef MotionProfile_H
+#define MotionProfile_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Trapezoidal velocity profile for a single move. Units are pixels for
+// straight-line moves and degrees for in-place rotations, times are in
+// framework ticks
+typedef struct {
+			float				Distance;				// Magnitude of the move
+			float				PeakVelocity;		// Velocity held during cruise (units/sec)
+			float				Acceleration;		// Ramp rate in and out of cruise (units/sec^2)
+			uint16_t		AccelTime;			// Ticks spent ramping up (and down)
+			uint16_t		CruiseTime;			// Ticks spent at PeakVelocity
+			uint16_t		TotalTime;			// Predicted time for the whole move
+} PROFILE_t;
+
+/*----------------------- Public Function Prototypes ----------------------*/
+void PlanProfile( PROFILE_t *Profile, float Distance, float MaxVelocity, float Acceleration );
+float QueryProfileVelocity( const PROFILE_t *Profile, uint16_t Time );
+float ProfileDistanceForTime( uint16_t Time, float MaxVelocity, float Acceleration );
+
+#endif /* MotionProfile_H */
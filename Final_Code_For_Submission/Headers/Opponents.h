@@ -0,0 +1,30 @@
+/****************************************************************************
+
+  Header file for the opponent tracking module
+
+ ****************************************************************************/
+
+#ifndef Opponents_H
+#define Opponents_H
+
+#include "Headers.h"
+
+#define NUM_KARTS 3
+
+// Track of one kart built from successive DRS frames
+typedef struct {
+			bool				Valid;					// False for our kart and karts we haven't seen move
+			float				X;
+			float				Y;
+			float				VX;							// Pixels/sec
+			float				VY;							// Pixels/sec
+			uint16_t		LastUpdate;			// Framework time of the last position
+} OPPONENT_t;
+
+/*----------------------- Public Function Prototypes ----------------------*/
+void UpdateOpponent( uint8_t KartNumber, uint16_t X, uint16_t Y );
+OPPONENT_t QueryOpponent( uint8_t KartNumber );
+POINT_t PredictOpponent( uint8_t KartNumber, uint16_t Ticks );
+void PlanAroundOpponents( KART_t myKart, float Speed, float *SpeedScale, float *LateralOffset );
+
+#endif /* Opponents_H */
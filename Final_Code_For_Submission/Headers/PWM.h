@@ -14,20 +14,27 @@
 #include "inc/hw_sysctl.h"
 #include "inc/hw_types.h"
 #include "bitdefs.h"
+#include "CalStore.h"
 
 #define PORT_MOTOR 1
 #define STARBOARD_MOTOR 0
-#define HALF_SPEED_PORT 71
-#define QUARTER_SPEED_PORT 50
+// Calibrated, see CalStore.c for the defaults
+#define HALF_SPEED_PORT (GetCalU16(CAL_HALF_SPEED_PORT))
+#define QUARTER_SPEED_PORT (GetCalU16(CAL_QUARTER_SPEED_PORT))
 #define FULL_SPEED_PORT 100
-#define HALF_SPEED_STARBOARD 75
-#define QUARTER_SPEED_STARBOARD 53
+#define HALF_SPEED_STARBOARD (GetCalU16(CAL_HALF_SPEED_STARBOARD))
+#define QUARTER_SPEED_STARBOARD (GetCalU16(CAL_QUARTER_SPEED_STARBOARD))
 #define FULL_SPEED_STARBOARD 100
 
 #define ONE_SEC 976
-#define ROTATION_TIME (ONE_SEC*2-190) //ONE_SEC*2 - 190
+// Calibrated, the defaults are literals so Tools/racing_line.py can read
+// them. The racing line table is planned for PIXELS_PER_3SEC_DEFAULT, so
+// regenerate it if the default speed changes.
+#define ROTATION_TIME (GetCalU16(CAL_ROTATION_TIME))
+#define ROTATION_TIME_DEFAULT 1762
 #define BANK_90_DEGREE_TIME (1800)
-#define PIXELS_PER_3SEC (115)
+#define PIXELS_PER_3SEC (GetCalU16(CAL_PIXELS_PER_3SEC))
+#define PIXELS_PER_3SEC_DEFAULT 115
 
 void InitPWM(void);
 void SetPWMDuty(uint8_t duty, int channel);
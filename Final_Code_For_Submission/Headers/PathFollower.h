@@ -0,0 +1,24 @@
+/****************************************************************************
+
+  Header file for the pure pursuit path follower
+
+ ****************************************************************************/
+
+#ifndef PathFollower_H
+#define PathFollower_H
+
+#include "Headers.h"
+
+// Waypoints owned by the driving state machine
+extern uint16_t cornerPointMatrix_X[4];
+extern uint16_t cornerPointMatrix_Y[4];
+extern POINT_t ObstacleEntry;
+extern POINT_t ShootingPoint;
+
+/*----------------------- Public Function Prototypes ----------------------*/
+bool PathFollowable( bool ShotPending, bool ObstaclePending );
+void StartPathFollower( void );
+void StopPathFollower( void );
+void UpdatePathFollower( void );
+
+#endif /* PathFollower_H */
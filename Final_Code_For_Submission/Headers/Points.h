@@ -19,6 +19,8 @@ typedef struct {
 } POINT_t;
 
 /*----------------------- Public Function Prototypes ----------------------*/
+void InitMapSections( void );
+void SetSectionOverlays( bool ShotComplete, bool ObstacleComplete );
 MapSection FindSection( POINT_t current );
 MapSection FindNextSection( MapSection current );
 
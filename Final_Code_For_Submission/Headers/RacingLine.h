@@ -0,0 +1,42 @@
+/****************************************************************************
+
+  Header file for the racing line lookup table
+
+ ****************************************************************************/
+
+#ifndef RacingLine_H
+#define RacingLine_H
+
+#include "Headers.h"
+
+// Samples per straight, each straight owns the corner at its far end
+#define RACING_LINE_SECTIONS 4
+#define RACING_LINE_SAMPLES 32
+
+// One sample along the racing line
+typedef struct {
+			float				X;
+			float				Y;
+			float				Heading;				// Kart theta convention (degrees)
+			float				Curvature;			// 1/pixels, positive slows the port wheel
+			float				Speed;					// Fraction of half speed
+} RACING_POINT_t;
+
+// Where each section's samples start and the direction of its straight
+typedef struct {
+			float				StartX;
+			float				StartY;
+			float				DirX;
+			float				DirY;
+			float				Spacing;				// Pixels between samples
+} RACING_SECTION_t;
+
+// Generated by Tools/racing_line.py into RacingLineTable.c
+extern const RACING_SECTION_t RacingLineSections[RACING_LINE_SECTIONS];
+extern const RACING_POINT_t RacingLine[RACING_LINE_SECTIONS][RACING_LINE_SAMPLES];
+
+/*----------------------- Public Function Prototypes ----------------------*/
+bool RacingLineProgress( MapSection section, POINT_t current, float *Progress );
+const RACING_POINT_t *QueryRacingLine( MapSection section, float Progress, float Ahead );
+
+#endif /* RacingLine_H */
@@ -42,5 +42,9 @@ ES_Event RunDRS ( ES_Event CurrentEvent );
 void EOTResponse( void );
 DRSState_t QueryDRS ( void );
 KART_t QueryMyKart ( void );
+uint8_t QueryMyKartNumber ( void );
+void SetMyKartNumber ( uint8_t KartNumber );
+KART_t QueryKart ( uint8_t KartNumber );
+bool QueryGameStateRead ( void );
 
 #endif /* DRS_H */
@@ -0,0 +1,30 @@
+/****************************************************************************
+
+  Header file for the servo keyframe sequencer
+
+ ****************************************************************************/
+
+#ifndef ServoSequencer_H
+#define ServoSequencer_H
+
+#include "Headers.h"
+
+// One servo PWM period, tracks are stepped this often on SERVO_TIMER
+#define SERVO_TICK 20
+
+// Move to Width (uS) over Duration (ms), 0 jumps straight there
+typedef struct {
+			uint16_t		Width;
+			uint16_t		Duration;
+} SERVO_KEYFRAME_t;
+
+/*----------------------- Public Function Prototypes ----------------------*/
+void InitServoSequencer( void );
+bool PlayServoTrack( uint8_t Channel, const SERVO_KEYFRAME_t *Frames, uint8_t NumFrames );
+bool ArmServoTrack( uint8_t Channel, const SERVO_KEYFRAME_t *Frames, uint8_t NumFrames );
+bool TriggerServoTrack( uint8_t Channel );
+void SetServoInterlock( uint8_t Channel, uint8_t BlockingChannel );
+bool QueryServoTrack( uint8_t Channel );
+ES_Event RunServoSequencer( ES_Event ThisEvent );
+
+#endif /* ServoSequencer_H */
@@ -24,14 +24,13 @@
 #include "termio.h"
 
 // State definitions for use with the query function
-typedef enum { OrientState, FindYState, ShootingTurningState, FindXState,
+typedef enum { PlanShotState, ShotTurningState, ShotDrivingState, AimState,
 								FindBeaconState, FireState, ReturnToTapeState } ShootingState ;
 
 // Public Function Prototypes
 ES_Event RunShooting( ES_Event CurrentEvent );
 void StartShooting ( ES_Event CurrentEvent );
 ShootingState QueryShooting ( void );
-bool InitBeaconCaptureResponse (void);
 
 #endif /*Shooting_H */
 
@@ -0,0 +1,24 @@
+/****************************************************************************
+
+  Header file for the shot planner
+
+ ****************************************************************************/
+
+#ifndef ShotPlanner_H
+#define ShotPlanner_H
+
+#include "Headers.h"
+
+// Where to fire from and which way to face
+typedef struct {
+			POINT_t			FirePoint;
+			uint16_t		FireHeading;		// Heading that points at the beacon
+			uint16_t		SweepHeading;		// Heading to start the beacon sweep from
+} SHOT_PLAN_t;
+
+/*----------------------- Public Function Prototypes ----------------------*/
+bool PlanShot( KART_t myKart, SHOT_PLAN_t *Plan );
+bool InFiringZone( POINT_t current );
+uint16_t BeaconHeading( POINT_t from );
+
+#endif /* ShotPlanner_H */
@@ -0,0 +1,45 @@
+/****************************************************************************
+
+  Header file for the telemetry streamer
+
+ ****************************************************************************/
+
+#ifndef Telemetry_H
+#define Telemetry_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Telemetry channels, the position is the bit in a frame's channel mask.
+// Tools/console.py gets the names from the kart, so new channels can go
+// anywhere before NUM_TELEMETRY_CHANNELS, up to 16 of them.
+typedef enum {
+			TEL_KART_X,						// DRS position (pixels)
+			TEL_KART_Y,
+			TEL_KART_THETA,				// DRS heading (degrees)
+			TEL_HEADING,					// Averaged DRS heading (degrees)
+			TEL_TARGET_X,					// Point the drive is heading for
+			TEL_TARGET_Y,
+			TEL_PORT_DUTY,				// Requested motor duty (%)
+			TEL_STARBOARD_DUTY,
+			TEL_MASTER_STATE,			// GamePlay state << 8 | RunningGame state
+			TEL_DRIVING_STATE,
+			TEL_BEACON_PERIOD,		// Last capture (40MHz ticks, 65535 if longer)
+			TEL_QUEUE_PEAK,				// Deepest the Master queue has been since last sample
+			TEL_BATTERY,					// mV
+			TEL_OVERRUNS,					// Deadline monitor overruns
+			TEL_DROPPED,					// Telemetry frames dropped for bandwidth
+			NUM_TELEMETRY_CHANNELS
+} TelemetryChannel_t;
+
+// Time between samples (ES timer ticks), channels are sent every
+// Decimation samples
+#define TELEMETRY_TICK 20
+
+/*----------------------- Public Function Prototypes ----------------------*/
+bool SetTelemetryChannel( uint8_t Channel, uint8_t Decimation );
+void StopTelemetry( void );
+bool QueryTelemetryChannel( uint8_t Channel, const char **pName, uint8_t *pDecimation );
+bool CheckTelemetry( void );
+
+#endif /* Telemetry_H */
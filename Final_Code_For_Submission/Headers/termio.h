@@ -14,6 +14,7 @@ extern "C" {
 
 #include <stdio.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include <stdlib.h>
 #include "utils/uartstdio.h"
 
@@ -26,9 +27,22 @@ extern "C" {
 unsigned char TERMIO_GetChar(void);
 
 /* sends a character to the terminal channel
-   wait for output buffer empty */
+   waits with interrupts enabled if the transmit buffer is full, or drops
+   the character if it was called with interrupts disabled */
 void TERMIO_PutChar(unsigned char ch);
 
+/* characters TERMIO_PutChar has dropped */
+uint16_t TERMIO_TxDropped(void);
+
+/* queues a block to send, false and nothing queued if it doesn't fit */
+bool TERMIO_Write(const uint8_t *data, uint16_t length);
+
+/* bytes TERMIO_Write can take right now */
+uint16_t TERMIO_TxFree(void);
+
+/* tops up the UART FIFO from the transmit buffer, never waits */
+void TERMIO_Service(void);
+
 /* initializes the communication channel */
 /* set baud rate to 115.2 kbaud and turn on Rx and Tx */
 void TERMIO_Init(void);
@@ -0,0 +1,268 @@
+/****************************************************************************
+ Module
+	ADCService.c
+
+ Revision			Revised by:
+	0.1.1				Alex
+
+ Description
+	Background sampling of up to four analog inputs on ADC0 sample sequencer
+	2. Timer 2A triggers the sequence at a fixed rate and the hardware
+	averages each conversion, so nothing waits on the ADC. The sequence
+	interrupt copies the results into a ring buffer and the latest sample
+	for each channel. Readers never turn interrupts off: single samples are
+	one aligned read, and the history is copied again if a new sequence came
+	in part way through.
+
+	Channels use the same pins as ADMulti.c:
+		channel 0: PE0 (AIN3)
+		channel 1: PE1 (AIN2)
+		channel 2: PE2 (AIN1)
+		channel 3: PE3 (AIN0)
+
+ Edits:
+	0.1.1 - Initial version, replaces the busy-wait ADC_MultiRead
+****************************************************************************/
+
+/*----------------------------- Include Files -----------------------------*/
+#include "Headers.h"
+#include "inc/hw_adc.h"
+#include "inc/hw_timer.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define TICKS_PER_SEC (TicksPerMS*1000)
+
+// Hardware averaging applied to every conversion
+#define ADC_AVERAGING ADC_SAC_AVG_16X
+
+// Samples kept per channel, must be a power of 2
+#define ADC_RING_LENGTH 16
+#define ADC_RING_MASK (ADC_RING_LENGTH - 1)
+
+/*---------------------------- Module Functions ---------------------------*/
+
+/*---------------------------- Module Variables ---------------------------*/
+static const uint8_t ChannelMask[MAX_ADC_CHANNELS] = {0x01,0x03,0x07,0x0F};
+// this mapping puts PE0 as result 0, PE1 as result 1...
+static const uint32_t ChannelMux[MAX_ADC_CHANNELS] = {0x03,0x023,0x123,0x0123};
+static const uint32_t ChannelCTL[MAX_ADC_CHANNELS] = {ADC_SSCTL2_END0|ADC_SSCTL2_IE0,
+                                                      ADC_SSCTL2_END1|ADC_SSCTL2_IE1,
+                                                      ADC_SSCTL2_END2|ADC_SSCTL2_IE2,
+                                                      ADC_SSCTL2_END3|ADC_SSCTL2_IE3};
+
+static uint8_t NumChannels = 0;
+static volatile uint16_t Latest[MAX_ADC_CHANNELS];
+static volatile uint16_t Ring[ADC_RING_LENGTH][MAX_ADC_CHANNELS];
+// Number of sequences completed, the next ring slot is SampleCount & ADC_RING_MASK
+static volatile uint32_t SampleCount = 0;
+
+/*------------------------------ Module Code ------------------------------*/
+
+/****************************************************************************
+ Function
+	InitADCService
+
+ Parameters
+	uint8_t number of channels to convert (1-4)
+	uint16_t samples per second for each channel
+
+ Returns
+	bool false if the number of channels or the rate is invalid
+
+ Description
+	Sets up the analog pins, ADC0 SS2 triggered by Timer 2A and the
+	sequence interrupt
+****************************************************************************/
+bool InitADCService( uint8_t HowMany, uint16_t Rate )
+{
+	if(HowMany == 0 || HowMany > MAX_ADC_CHANNELS || Rate == 0) {
+		return false;
+	}
+	uint8_t index = HowMany - 1;
+	NumChannels = HowMany;
+	SampleCount = 0;
+
+	// Enable the clocks to ADC0, Timer 2 and Port E
+	HWREG(SYSCTL_RCGCADC) |= SYSCTL_RCGCADC_R0;
+	HWREG(SYSCTL_RCGCTIMER) |= SYSCTL_RCGCTIMER_R2;
+	HWREG(SYSCTL_RCGCGPIO) |= SYSCTL_RCGCGPIO_R4;
+	while ((HWREG(SYSCTL_PRGPIO) & SYSCTL_PRGPIO_R4) != SYSCTL_PRGPIO_R4)
+		;
+	while ((HWREG(SYSCTL_PRADC) & SYSCTL_PRADC_R0) != SYSCTL_PRADC_R0)
+		;
+	while ((HWREG(SYSCTL_PRTIMER) & SYSCTL_PRTIMER_R2) != SYSCTL_PRTIMER_R2)
+		;
+
+	// Make the pins analog inputs
+	HWREG(GPIO_PORTE_BASE+GPIO_O_DIR) &= ~ChannelMask[index];
+	HWREG(GPIO_PORTE_BASE+GPIO_O_AFSEL) |= ChannelMask[index];
+	HWREG(GPIO_PORTE_BASE+GPIO_O_DEN) &= ~ChannelMask[index];
+	HWREG(GPIO_PORTE_BASE+GPIO_O_AMSEL) |= ChannelMask[index];
+
+	// Disable SS2 while it is set up
+	HWREG(ADC0_BASE+ADC_O_ACTSS) &= ~ADC_ACTSS_ASEN2;
+	// 125K samples/sec is plenty with averaging
+	HWREG(ADC0_BASE+ADC_O_PC) = (HWREG(ADC0_BASE+ADC_O_PC) & ~ADC_PC_SR_M) | ADC_PC_SR_125K;
+	// Sequencer 3 is lowest priority
+	HWREG(ADC0_BASE+ADC_O_SSPRI) = 0x3210;
+	// SS2 is triggered by a timer
+	HWREG(ADC0_BASE+ADC_O_EMUX) = (HWREG(ADC0_BASE+ADC_O_EMUX) & ~ADC_EMUX_EM2_M) | ADC_EMUX_EM2_TIMER;
+	HWREG(ADC0_BASE+ADC_O_SSMUX2) = ChannelMux[index];
+	HWREG(ADC0_BASE+ADC_O_SSCTL2) = ChannelCTL[index];
+	HWREG(ADC0_BASE+ADC_O_SAC) = ADC_AVERAGING;
+	// Clear anything pending and enable the SS2 interrupt
+	HWREG(ADC0_BASE+ADC_O_ISC) = ADC_ISC_IN2;
+	HWREG(ADC0_BASE+ADC_O_IM) |= ADC_IM_MASK2;
+	HWREG(ADC0_BASE+ADC_O_ACTSS) |= ADC_ACTSS_ASEN2;
+
+	// ADC0 sequence 2 is interrupt number 16 so appears in EN0 at bit 16
+	HWREG(NVIC_EN0) |= BIT16HI;
+
+	// Timer 2A as a 32 bit periodic timer that triggers the ADC
+	HWREG(TIMER2_BASE+TIMER_O_CTL) &= ~TIMER_CTL_TAEN;
+	HWREG(TIMER2_BASE+TIMER_O_CFG) = TIMER_CFG_32_BIT_TIMER;
+	HWREG(TIMER2_BASE+TIMER_O_TAMR) =
+		(HWREG(TIMER2_BASE+TIMER_O_TAMR) & ~TIMER_TAMR_TAMR_M) | TIMER_TAMR_TAMR_PERIOD;
+	HWREG(TIMER2_BASE+TIMER_O_TAILR) = TICKS_PER_SEC/Rate - 1;
+
+	// make sure interrupts are enabled globally
+	__enable_irq();
+
+	// Start the timer with the ADC trigger on, stalled by the debugger
+	HWREG(TIMER2_BASE+TIMER_O_CTL) |= (TIMER_CTL_TAOTE | TIMER_CTL_TAEN | TIMER_CTL_TASTALL);
+
+	printf("ADC Initialized\n\r");
+	return true;
+}
+
+/****************************************************************************
+ Function
+	SetADCSampleRate
+
+ Parameters
+	uint16_t samples per second for each channel
+
+ Returns
+	none
+
+ Description
+	Changes the trigger rate, takes effect at the next trigger
+****************************************************************************/
+void SetADCSampleRate( uint16_t Rate )
+{
+	if(Rate == 0) {
+		return;
+	}
+	HWREG(TIMER2_BASE+TIMER_O_TAILR) = TICKS_PER_SEC/Rate - 1;
+}
+
+/****************************************************************************
+ Function
+	ADCSampleResponse
+
+ Parameters
+	none
+
+ Returns
+	none
+
+ Description
+	ADC0 SS2 interrupt, moves the sequence results into the ring buffer
+****************************************************************************/
+void ADCSampleResponse( void )
+{
+	uint8_t slot = SampleCount & ADC_RING_MASK;
+
+	// Clear the interrupt source
+	HWREG(ADC0_BASE+ADC_O_ISC) = ADC_ISC_IN2;
+
+	for(uint8_t i = 0; i < NumChannels; i++) {
+		uint16_t sample = HWREG(ADC0_BASE+ADC_O_SSFIFO2) & 0xFFF;
+		Ring[slot][i] = sample;
+		Latest[i] = sample;
+	}
+	SampleCount++;
+}
+
+/****************************************************************************
+ Function
+	QueryADCLatest
+
+ Parameters
+	uint8_t channel (0-3)
+
+ Returns
+	uint16_t most recent 12 bit result, 0 if the channel is not converting
+
+ Description
+	Safe to call from anywhere, the sample is a single read
+****************************************************************************/
+uint16_t QueryADCLatest( uint8_t Channel )
+{
+	if(Channel >= NumChannels) {
+		return 0;
+	}
+	return Latest[Channel];
+}
+
+/****************************************************************************
+ Function
+	QueryADCSampleCount
+
+ Parameters
+	none
+
+ Returns
+	uint32_t number of sequences converted since InitADCService
+
+ Description
+	Lets callers tell if a new sample has come in
+****************************************************************************/
+uint32_t QueryADCSampleCount( void )
+{
+	return SampleCount;
+}
+
+/****************************************************************************
+ Function
+	ReadADCHistory
+
+ Parameters
+	uint8_t channel (0-3)
+	uint16_t * where to put the samples, oldest first
+	uint8_t how many samples to read (at most ADC_RING_LENGTH - 1)
+
+ Returns
+	uint8_t number of samples copied
+
+ Description
+	Copies the most recent samples of a channel. If a sequence completes
+	while copying the oldest sample may have been overwritten, so the copy
+	is done again.
+****************************************************************************/
+uint8_t ReadADCHistory( uint8_t Channel, uint16_t *Samples, uint8_t Count )
+{
+	uint32_t before;
+	uint32_t after;
+
+	if(Channel >= NumChannels) {
+		return 0;
+	}
+	// Leave one slot for the sequence that may be landing while we copy
+	if(Count > ADC_RING_LENGTH - 1) {
+		Count = ADC_RING_LENGTH - 1;
+	}
+
+	do {
+		before = SampleCount;
+		if(Count > before) {
+			Count = before;
+		}
+		for(uint8_t i = 0; i < Count; i++) {
+			Samples[i] = Ring[(before - Count + i) & ADC_RING_MASK][Channel];
+		}
+		after = SampleCount;
+	} while(after - before > 1);
+
+	return Count;
+}
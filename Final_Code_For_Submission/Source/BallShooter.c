@@ -4,11 +4,26 @@
 
  Revision			Revised by: 
 	0.1.1					Eric			
+	0.2.1					Alex
+	0.2.2					Alex
+	0.2.3					Alex
+	0.2.4					Alex
 
  Description
   State Machine for launching and reloading the balls
 	 
  Edits:
+	0.2.1 - Servo moves are keyframe tracks on the servo sequencer. The shot
+	        is armed as soon as the last one is away, so firing only waits
+	        for the flick.
+	0.2.2 - Rapid fire, one trigger fires a burst of ShotCount balls. Between
+	        shots the hopper lets the next ball out while the flicker is still
+	        resetting, and the flicker is interlocked on the hopper so it
+	        never strikes while the hopper is moving.
+	0.2.3 - Servo positions come from the calibration store and are loaded
+	        into the tracks each time a shot is armed.
+	0.2.4 - QueryBurstTime gives the longest a burst can take, for the
+	        shooting state's backstop
 
  Notes:
 	Ball Servo Limits: Width = 500-2500 (moves ~ 180 degrees)
@@ -19,27 +34,68 @@
 #include "Headers.h"
 
 /*----------------------------- Module Defines ----------------------------*/
-// Symbolic defines for time
-#define BALL_TIME ONE_SEC
+// Symbolic defines for time (ms)
+#define HOPPER_MOVE_TIME			200		// Hopper open or closed
+#define FLICKER_RESET_TIME		300		// Flicker back to take the next ball
+#define FLICKER_SET_TIME			300		// Flicker forward to the start position
+#define BALL_DROP_TIME				300		// Ball rolls out of the open hopper
+#define FLICK_TIME						200		// Flick and follow through
 
-// Symbolic defines for servo positions/PWM channel
-#define SHOOTER_SET						1400
-#define SHOOTER_FLICK					850	
-#define SHOOTER_RESET					1900	
+// Symbolic defines for PWM channel, the positions are in the calibration store
 #define SHOOTER_CHANNEL				2
-#define HOPPER_SET						1000
-#define HOPPER_RELEASE				1500
 #define HOPPER_CHANNEL				3
 
+// Balls fired per beacon lock
+#define MAX_SHOT_COUNT				5
+
+#define NUM_FRAMES(Track) (sizeof(Track)/sizeof(Track[0]))
+
 /*---------------------------- Module Functions ---------------------------*/
-static void FlickerSetStartPosition( void );
-static void FlickerFlickBall( void );
-static void FlickerReset( void );
-static void HopperSet( void );
-static void HopperRelease( void );
+static void ArmShot( void );
+static void ArmRapidShot( void );
+static void LoadServoWidths( void );
+static uint16_t TrackTime( const SERVO_KEYFRAME_t *Frames, uint8_t NumFrames );
 
 /*---------------------------- Module Variables ---------------------------*/
 static ShooterState BallShootState;
+static uint8_t ShotCount = DEFAULT_SHOT_COUNT;
+static uint8_t ShotsLeft = 0;
+
+// The widths are filled in by LoadServoWidths, the comment on each keyframe
+// is the position it goes to
+
+// Reset the flicker, bring it to the start position, wait for the ball to
+// drop in and flick. Arming plays everything but the flick.
+static SERVO_KEYFRAME_t FlickerTrack[] = {
+	{.Duration = FLICKER_RESET_TIME},									// Reset
+	{.Duration = FLICKER_SET_TIME},										// Set
+	{.Duration = HOPPER_MOVE_TIME + BALL_DROP_TIME},	// Set
+	{.Duration = FLICK_TIME}													// Flick
+};
+
+// Hopper stays shut while the flicker resets, then lets one ball out once
+// the flicker is at the start position
+static SERVO_KEYFRAME_t HopperTrack[] = {
+	{.Duration = HOPPER_MOVE_TIME},																				// Set
+	{.Duration = FLICKER_RESET_TIME + FLICKER_SET_TIME - HOPPER_MOVE_TIME},	// Set
+	{.Duration = HOPPER_MOVE_TIME}																				// Release
+};
+
+// Reload in the middle of a burst, the flicker goes back and forward again
+// without waiting for the hopper
+static SERVO_KEYFRAME_t RapidFlickerTrack[] = {
+	{.Duration = FLICKER_RESET_TIME},	// Reset
+	{.Duration = FLICKER_SET_TIME},		// Set
+	{.Duration = BALL_DROP_TIME},			// Set
+	{.Duration = FLICK_TIME}					// Flick
+};
+
+// Hopper shuts behind the ball just fired and lets the next one out while
+// the flicker is resetting
+static SERVO_KEYFRAME_t RapidHopperTrack[] = {
+	{.Duration = HOPPER_MOVE_TIME},		// Set
+	{.Duration = HOPPER_MOVE_TIME}		// Release
+};
 
 /*------------------------------ Module Code ------------------------------*/
 
@@ -58,13 +114,12 @@ static ShooterState BallShootState;
 ****************************************************************************/
 bool InitBallShooter(void)
 {
-	// Put both servos into their default positions
-	FlickerReset(); 
-	HopperSet();
+	InitServoSequencer();
+	// The flick waits for the hopper to stop, whatever the track timing
+	SetServoInterlock(SHOOTER_CHANNEL, HOPPER_CHANNEL);
 	
-	// Set current state to ShooterResetting
-	BallShootState = ShooterResetting;
-	ES_Timer_InitTimer(BALL_SHOOTER_TIMER,BALL_TIME);
+	// Get the first ball ready
+	ArmShot();
 	printf("Ball Shooter Initialized\r\n");
 	return true;
 }
@@ -74,26 +129,39 @@ bool InitBallShooter(void)
 	RunBallShooter
 
  Description
-  Runs a pseudo-state machine to test our servo motors
+  Moves between arming, armed and firing as the flicker track stops.
+  Posts BallsFired once the last ball of a burst is away.
 ****************************************************************************/
 ES_Event RunBallShooter ( ES_Event ThisEvent )
 {
 	ES_Event ReturnEvent = {ES_NO_EVENT};
 	
-	if(ThisEvent.EventType == ES_TIMEOUT && ThisEvent.EventParam == BALL_SHOOTER_TIMER) {
+	if(ThisEvent.EventType == ServoSequenceDone && ThisEvent.EventParam == SHOOTER_CHANNEL) {
 		switch (BallShootState)
 		{
-			case ShooterReady:
-				// Reset after shot
-				FlickerReset();
-				BallShootState = ShooterResetting;
-				ES_Timer_InitTimer(BALL_SHOOTER_TIMER,BALL_TIME);
-				break;
 			case ShooterResetting:
-				// Set the start position and reload the ball
-				FlickerSetStartPosition();
+				// Flicker is holding at the start with a ball on it
+				printf("Flicker is armed\r\n");
 				BallShootState = ShooterReady;
 				break;
+			case ShooterFiring:
+				// Ball is away, fire the next one as soon as it is loaded
+				printf("Flicker has fired the ball\r\n");
+				if(ShotsLeft > 0) {
+					ShotsLeft--;
+				}
+				if(ShotsLeft > 0) {
+					ArmRapidShot();
+					TriggerServoTrack(SHOOTER_CHANNEL);
+				}
+				else {
+					ArmShot();
+					ES_Event newEvent = {BallsFired, ShotCount};
+					PostMaster(newEvent);
+				}
+				break;
+			case ShooterReady:
+				break;
 		}
 	}
 	return ReturnEvent;
@@ -103,79 +171,135 @@ ES_Event RunBallShooter ( ES_Event ThisEvent )
  Function
 	FireBallShooter
  Description
-	Moves ball shooting servo to shooting position to flick ruler and shoot ball
+	Fires a burst of ShotCount balls, if the shot is still arming the first
+	flick follows as soon as it is ready
 ****************************************************************************/
 void FireBallShooter(void)
 {
-	FlickerFlickBall();
-	ES_Timer_InitTimer(BALL_SHOOTER_TIMER,BALL_TIME);
+	if(BallShootState == ShooterFiring) {
+		return;
+	}
+	ShotsLeft = ShotCount;
+	TriggerServoTrack(SHOOTER_CHANNEL);
+	BallShootState = ShooterFiring;
 }
 
 /****************************************************************************
  Function
-	SetStartPosition
+	SetShotCount
+
+ Parameters
+	uint8_t balls to fire per beacon lock (1-MAX_SHOT_COUNT)
+
+ Returns
+	none
 
  Description
-    
+	Takes effect at the next FireBallShooter, 1 is a single shot
 ****************************************************************************/
-static void FlickerSetStartPosition( void )
+void SetShotCount( uint8_t Count )
 {
-	SetPWMWidth( SHOOTER_SET, SHOOTER_CHANNEL);
-	printf("Flicker is set to Start position\r\n");
-	HopperRelease();
+	if(Count == 0) {
+		Count = 1;
+	}
+	if(Count > MAX_SHOT_COUNT) {
+		Count = MAX_SHOT_COUNT;
+	}
+	ShotCount = Count;
 }
 
 /****************************************************************************
  Function
-	FlickBall
+	QueryShotCount
 
- Description
-   
+ Parameters
+	none
+
+ Returns
+	uint8_t balls fired per beacon lock
 ****************************************************************************/
-static void FlickerFlickBall( void )
+uint8_t QueryShotCount( void )
 {
-	SetPWMWidth( SHOOTER_FLICK, SHOOTER_CHANNEL);
-	printf("Flicker has fired the ball\r\n");
+	return ShotCount;
 }
 
 /****************************************************************************
  Function
-	Reset
+	QueryBurstTime
+
+ Parameters
+	none
+
+ Returns
+	uint16_t ms from FireBallShooter to BallsFired at the most
 
  Description
-    
+	Allows for the whole first reload, in case the burst is started while
+	the shot is still arming, then a rapid reload for every other ball
 ****************************************************************************/
-static void FlickerReset( void )
+uint16_t QueryBurstTime( void )
 {
-	SetPWMWidth( SHOOTER_RESET, SHOOTER_CHANNEL);
-	printf("Flicker has been reset\r\n");
-	HopperSet();
+	return TrackTime(FlickerTrack, NUM_FRAMES(FlickerTrack)) +
+		(ShotCount - 1)*TrackTime(RapidFlickerTrack, NUM_FRAMES(RapidFlickerTrack));
 }
 
-/****************************************************************************
- Function
-	HopperSet
+/***************************************************************************
+ private functions
+ ***************************************************************************/
 
- Description
-   
-****************************************************************************/
-static void HopperSet( void )
+// Starts the reload on both servos, ends holding before the flick
+static void ArmShot( void )
 {
-	SetPWMWidth( HOPPER_SET, HOPPER_CHANNEL);
-	printf("hopper is set\r\n");
+	LoadServoWidths();
+	ArmServoTrack(SHOOTER_CHANNEL, FlickerTrack, NUM_FRAMES(FlickerTrack));
+	PlayServoTrack(HOPPER_CHANNEL, HopperTrack, NUM_FRAMES(HopperTrack));
+	BallShootState = ShooterResetting;
 }
 
-/****************************************************************************
- Function
-	HopperRelease
+// Reload between shots of a burst with the hopper and flicker overlapped
+static void ArmRapidShot( void )
+{
+	LoadServoWidths();
+	ArmServoTrack(SHOOTER_CHANNEL, RapidFlickerTrack, NUM_FRAMES(RapidFlickerTrack));
+	PlayServoTrack(HOPPER_CHANNEL, RapidHopperTrack, NUM_FRAMES(RapidHopperTrack));
+}
 
- Description
-    
-****************************************************************************/
-static void HopperRelease( void )
+// Copies the calibrated servo positions into the tracks, so a new value is
+// used from the next shot armed
+static void LoadServoWidths( void )
+{
+	uint16_t shooterSet = GetCalU16(CAL_SHOOTER_SET);
+	uint16_t shooterFlick = GetCalU16(CAL_SHOOTER_FLICK);
+	uint16_t shooterReset = GetCalU16(CAL_SHOOTER_RESET);
+	uint16_t hopperSet = GetCalU16(CAL_HOPPER_SET);
+	uint16_t hopperRelease = GetCalU16(CAL_HOPPER_RELEASE);
+
+	FlickerTrack[0].Width = shooterReset;
+	FlickerTrack[1].Width = shooterSet;
+	FlickerTrack[2].Width = shooterSet;
+	FlickerTrack[3].Width = shooterFlick;
+
+	HopperTrack[0].Width = hopperSet;
+	HopperTrack[1].Width = hopperSet;
+	HopperTrack[2].Width = hopperRelease;
+
+	RapidFlickerTrack[0].Width = shooterReset;
+	RapidFlickerTrack[1].Width = shooterSet;
+	RapidFlickerTrack[2].Width = shooterSet;
+	RapidFlickerTrack[3].Width = shooterFlick;
+
+	RapidHopperTrack[0].Width = hopperSet;
+	RapidHopperTrack[1].Width = hopperRelease;
+}
+
+// Time to play a whole track (ms)
+static uint16_t TrackTime( const SERVO_KEYFRAME_t *Frames, uint8_t NumFrames )
 {
-	SetPWMWidth( HOPPER_RELEASE, HOPPER_CHANNEL);
-	printf("hopper is released\r\n");
+	uint16_t time = 0;
+	for(uint8_t i = 0; i < NumFrames; i++) {
+		time += Frames[i].Duration;
+	}
+	return time;
 }
 
 /*
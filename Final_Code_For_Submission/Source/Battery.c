@@ -0,0 +1,246 @@
+/****************************************************************************
+ Module
+	Battery.c
+
+ Revision			Revised by:
+	0.1.1				Alex
+	0.1.2				Alex
+
+ Description
+	Battery monitor on ADC channel BATTERY_CHANNEL (PE1 through a resistor
+	divider). Every BATTERY_PERIOD the voltage is filtered and turned into a
+	scale factor that SetPWMDuty applies to the motor channels, so the
+	duty constants give the same wheel speed on a full battery and a tired
+	one. While a race is running the voltage is logged every
+	BATTERY_LOG_PERIOD and the log is printed when the race is over, a few
+	lines each update so no one event takes long.
+
+ Edits:
+	0.1.1 - Initial version
+	0.1.2 - The log prints the period it was really taken at, and is
+	        printed over several updates
+****************************************************************************/
+
+/*----------------------------- Include Files -----------------------------*/
+#include "Headers.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+// ADC full scale is 3.3V over 4096 counts, the divider takes a quarter of
+// the battery voltage
+#define ADC_FULL_SCALE_MV 3300
+#define ADC_COUNTS 4096
+#define BATTERY_DIVIDER 4
+
+// Voltage the speed constants were tuned at (mV)
+#define BATTERY_NOMINAL_MV 9600
+
+// Readings outside this range mean the divider is not connected (mV)
+#define BATTERY_MIN_VALID_MV 6000
+#define BATTERY_MAX_VALID_MV 14000
+
+// Limits on the duty scale so a bad reading can't run the motors away
+#define MIN_DUTY_SCALE 0.8f
+#define MAX_DUTY_SCALE 1.3f
+
+// Filter update period and weight given to each new reading
+#define BATTERY_PERIOD 100
+#define BATTERY_FILTER_GAIN 0.2f
+#define BATTERY_SAMPLES 8
+
+// One log entry every BATTERY_LOG_PERIOD, enough entries for a long race
+#define BATTERY_LOG_PERIOD ONE_SEC
+#define BATTERY_LOG_LENGTH 256
+#define UPDATES_PER_LOG (BATTERY_LOG_PERIOD/BATTERY_PERIOD)
+// Rounded down to whole updates, so a little under BATTERY_LOG_PERIOD
+#define LOG_ENTRY_PERIOD (UPDATES_PER_LOG*BATTERY_PERIOD)
+
+// Log lines printed each update once the race is over
+#define BATTERY_DUMP_LINES 8
+
+/*---------------------------- Module Functions ---------------------------*/
+static void UpdateBattery( void );
+static void StartBatteryDump( void );
+static void DumpBatteryLog( void );
+
+/*---------------------------- Module Variables ---------------------------*/
+static float FilteredMillivolts = 0;
+static float DutyScale = 1;
+
+static bool Logging = false;
+static uint16_t BatteryLog[BATTERY_LOG_LENGTH];
+static uint16_t LogLength;
+static uint8_t UpdatesSinceLog;
+static bool Dumping = false;
+static uint16_t DumpIndex;
+
+/*------------------------------ Module Code ------------------------------*/
+
+/****************************************************************************
+ Function
+     StartBattery
+
+ Parameters
+     ES_Event CurrentEvent
+
+ Returns
+     nothing
+
+ Description
+     Starts the filter update timer, the ADC must already be sampling
+****************************************************************************/
+void StartBattery ( ES_Event CurrentEvent )
+{
+	FilteredMillivolts = 0;
+	DutyScale = 1;
+	Logging = false;
+	Dumping = false;
+	ES_Timer_InitTimer(BATTERY_TIMER,BATTERY_PERIOD);
+}
+
+/****************************************************************************
+ Function
+    RunBattery
+
+ Parameters
+   ES_Event : the event to process
+
+ Returns
+   ES_Event, ES_NO_EVENT
+
+ Description
+   Updates the battery voltage on each timeout, starts the log when the
+   flag first drops and prints it at the end of the race
+****************************************************************************/
+ES_Event RunBattery ( ES_Event ThisEvent )
+{
+	ES_Event ReturnEvent = {ES_NO_EVENT};
+
+	if(ThisEvent.EventType == ES_TIMEOUT && ThisEvent.EventParam == BATTERY_TIMER) {
+		UpdateBattery();
+		if(Dumping) {
+			DumpBatteryLog();
+		}
+		ES_Timer_InitTimer(BATTERY_TIMER,BATTERY_PERIOD);
+	}
+	// Flag drops again after every caution, only the first one starts a log
+	else if(ThisEvent.EventType == FlagDropped && !Logging) {
+		if(Dumping) {
+			printf("Battery log cut short \r\n");
+			Dumping = false;
+		}
+		Logging = true;
+		LogLength = 0;
+		UpdatesSinceLog = UPDATES_PER_LOG;
+	}
+	else if(ThisEvent.EventType == GameOver && Logging) {
+		Logging = false;
+		StartBatteryDump();
+	}
+	return ReturnEvent;
+}
+
+/****************************************************************************
+ Function
+    QueryBatteryMillivolts
+
+ Parameters
+   none
+
+ Returns
+   uint16_t filtered battery voltage (mV), 0 before the first reading
+
+ Description
+   Battery voltage as of the last update
+****************************************************************************/
+uint16_t QueryBatteryMillivolts( void )
+{
+	return (uint16_t)FilteredMillivolts;
+}
+
+/****************************************************************************
+ Function
+    QueryDutyScale
+
+ Parameters
+   none
+
+ Returns
+   float factor to multiply motor duty by
+
+ Description
+   Nominal over measured battery voltage, 1 if there is no good reading
+****************************************************************************/
+float QueryDutyScale( void )
+{
+	return DutyScale;
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+
+// Averages the recent ADC samples into the filter and updates the scale
+static void UpdateBattery( void )
+{
+	uint16_t samples[BATTERY_SAMPLES];
+	uint8_t count = ReadADCHistory(BATTERY_CHANNEL, samples, BATTERY_SAMPLES);
+	if(count == 0) {
+		return;
+	}
+
+	uint32_t sum = 0;
+	for(uint8_t i = 0; i < count; i++) {
+		sum += samples[i];
+	}
+	float millivolts = (float)sum/count*ADC_FULL_SCALE_MV/ADC_COUNTS*BATTERY_DIVIDER;
+
+	if(FilteredMillivolts == 0) {
+		FilteredMillivolts = millivolts;
+	}
+	else {
+		FilteredMillivolts += BATTERY_FILTER_GAIN*(millivolts - FilteredMillivolts);
+	}
+
+	// Leave the duty alone if the reading can't be a battery
+	if(FilteredMillivolts < BATTERY_MIN_VALID_MV || FilteredMillivolts > BATTERY_MAX_VALID_MV) {
+		DutyScale = 1;
+	}
+	else {
+		DutyScale = BATTERY_NOMINAL_MV/FilteredMillivolts;
+		if(DutyScale < MIN_DUTY_SCALE) {
+			DutyScale = MIN_DUTY_SCALE;
+		}
+		if(DutyScale > MAX_DUTY_SCALE) {
+			DutyScale = MAX_DUTY_SCALE;
+		}
+	}
+
+	if(Logging) {
+		UpdatesSinceLog++;
+		if(UpdatesSinceLog >= UPDATES_PER_LOG && LogLength < BATTERY_LOG_LENGTH) {
+			BatteryLog[LogLength++] = (uint16_t)FilteredMillivolts;
+			UpdatesSinceLog = 0;
+		}
+	}
+}
+
+// Starts printing the voltage trace for the race, the lines follow on the
+// next updates
+static void StartBatteryDump( void )
+{
+	printf("Battery log, %d ms per entry \r\n", LOG_ENTRY_PERIOD*1000/ONE_SEC);
+	Dumping = true;
+	DumpIndex = 0;
+}
+
+// Prints the next few lines of the voltage trace, one line per log entry
+static void DumpBatteryLog( void )
+{
+	for(uint8_t i = 0; i < BATTERY_DUMP_LINES && DumpIndex < LogLength; i++, DumpIndex++) {
+		printf("%d,%d\r\n", DumpIndex, BatteryLog[DumpIndex]);
+	}
+	if(DumpIndex >= LogLength) {
+		printf("Battery log end \r\n");
+		Dumping = false;
+	}
+}
@@ -0,0 +1,567 @@
+/****************************************************************************
+ Module
+	BeaconDetector.c
+
+ Revision			Revised by:
+	0.1.1				Alex
+	0.1.2				Alex
+	0.1.3				Alex
+	0.1.4				Alex
+	0.1.5				Alex
+	0.1.6				Alex
+
+ Description
+	Input capture on the IR beacon sensor (WTIMER0A on PC4). Several beacon
+	bands are tracked at once: our target, the other teams' targets and any
+	noise sources we want to recognize. Each capture period is turned into a
+	coarse period bin, and a lookup table rebuilt whenever the bands change
+	gives the band for that bin, so the ISR does the same small amount of
+	work no matter how many bands are set up. The last HISTORY_LENGTH bins
+	are kept in a histogram and a beacon only counts as seen once
+	CONSISTENT_PERIODS of them agree. The share of the history in each band
+	is its confidence. During a sweep the first and last consistent edge are
+	recorded for every band, and once the beam of a target band has passed
+	the shooting state machine is told which band it was and how far it is
+	past the center of the beacon.
+
+ Edits:
+	0.1.1 - Moved beacon capture out of Shooting.c, a single in-band period no
+	        longer fires the shot
+	0.1.2 - Tracks several configurable bands with a confidence for each
+	0.1.3 - DetectedBeacon is published on the event bus
+	0.1.4 - Our beacon's band comes from the calibration store when the
+	        detector starts
+	0.1.5 - Keeps the last capture period for telemetry
+	0.1.6 - Times are labelled as ES timer ticks, which is what they are
+****************************************************************************/
+
+/*----------------------------- Include Files -----------------------------*/
+#include "Headers.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+// Periods are binned 256 ticks at a time, the last bin holds every period
+// too long to be a beacon
+#define PERIOD_SHIFT 8
+#define PERIOD_BINS 256
+#define OVERFLOW_BIN (PERIOD_BINS - 1)
+
+// Band id used for bins that are not in any band
+#define NO_BAND MAX_BEACON_BANDS
+
+#define HISTORY_LENGTH 8
+
+// Periods in or next to the same bin needed to believe it is the beacon
+#define CONSISTENT_PERIODS 4
+
+// Share of the history a target band needs at its best during the pass
+// before it is reported (percent)
+#define MIN_CONFIDENCE 50
+
+// Time without a consistent edge before the beam has passed (ES timer
+// ticks, ONE_SEC to the second)
+#define BEACON_LOST_TIME 20
+
+/*---------------------------- Module Functions ---------------------------*/
+static void ClearHistogram( void );
+static void BuildBandTable( void );
+
+/*---------------------------- Module Variables ---------------------------*/
+static BEACON_BAND_t Bands[MAX_BEACON_BANDS];
+// Band for each period bin, rebuilt from Bands
+static uint8_t BinToBand[PERIOD_BINS];
+
+static uint32_t LastCapture;
+static volatile uint32_t LastPeriod;
+static uint8_t History[HISTORY_LENGTH];
+static uint8_t HistoryIndex;
+static uint8_t BinCounts[PERIOD_BINS];
+static uint8_t BandCounts[MAX_BEACON_BANDS + 1];
+
+static volatile bool Sweeping = false;
+// Bit per band, set once that band has had a consistent edge this pass
+static volatile uint8_t BandsSeen = 0;
+static volatile uint8_t PeakCounts[MAX_BEACON_BANDS];
+static volatile uint16_t FirstEdgeTime[MAX_BEACON_BANDS];
+static volatile uint16_t LastEdgeTime[MAX_BEACON_BANDS];
+static volatile uint16_t FirstEdgeTheta[MAX_BEACON_BANDS];
+static volatile uint16_t LastEdgeTheta[MAX_BEACON_BANDS];
+// Band the last DetectedBeacon was posted for
+static uint8_t DetectedBand = BEACON_TARGET_BAND;
+
+/*------------------------------ Module Code ------------------------------*/
+
+/****************************************************************************
+ Function
+   InitBeaconCaptureResponse
+
+ Parameters
+     none
+
+ Returns
+     none
+
+ Description
+		Initializes input capture response on pin C4
+****************************************************************************/
+bool InitBeaconCaptureResponse (void)
+{
+	// Only our own beacon until told about any others
+	for(uint8_t i = 0; i < MAX_BEACON_BANDS; i++) {
+		Bands[i].Enabled = false;
+	}
+	// Capture periods for our beacon (40MHz ticks)
+	Bands[BEACON_TARGET_BAND].Low = GetCalU16(CAL_BEACON_LOW);
+	Bands[BEACON_TARGET_BAND].High = GetCalU16(CAL_BEACON_HIGH);
+	Bands[BEACON_TARGET_BAND].Target = true;
+	Bands[BEACON_TARGET_BAND].Enabled = true;
+	BuildBandTable();
+	ClearHistogram();
+	
+	// Start by enabling the clock to the timer (Wide Timer 0)
+  HWREG(SYSCTL_RCGCWTIMER) |= SYSCTL_RCGCWTIMER_R0;
+	// Enable the clock to Port C
+	HWREG(SYSCTL_RCGCGPIO) |= SYSCTL_RCGCGPIO_R2;
+	// Since we added this Port C clock init, we can immediately start
+  // into configuring the timer, no need for further delay
+  
+  // Make sure that Wide Timer 0 Timer A is disabled before configuring
+  HWREG(WTIMER0_BASE+TIMER_O_CTL) &= ~TIMER_CTL_TAEN;
+  
+	// Set Wide Timer 0 Timer A in 32bit wide (individual, not concatenated) mode
+	// the constant name derives from the 16/32 bit timer, but this is a 32/64
+	// bit timer so we are setting the 32bit mode
+  HWREG(WTIMER0_BASE+TIMER_O_CFG) = TIMER_CFG_16_BIT;
+
+	// We want to use the full 32 bit count, so initialize the Interval Load
+	// register to 0xffff.ffff (this is its default value)
+  HWREG(WTIMER0_BASE+TIMER_O_TAILR) = 0xffffffff;
+
+	// Vet up Wide Timer 0 Timer A in capture mode (TAMR=3, TAAMS = 0), 
+	// for edge time (TACMR = 1) and up-counting (TACDIR = 1)
+  HWREG(WTIMER0_BASE+TIMER_O_TAMR) = 
+      (HWREG(WTIMER0_BASE+TIMER_O_TAMR) & ~TIMER_TAMR_TAAMS) | 
+        (TIMER_TAMR_TACDIR | TIMER_TAMR_TACMR | TIMER_TAMR_TAMR_CAP);
+
+	// To set the event to rising edge, we need to modify the TAEVENT bits 
+	// in GPTMCTL. Rising edge = 00, so we clear the TAEVENT bits
+  HWREG(WTIMER0_BASE+TIMER_O_CTL) &= ~TIMER_CTL_TAEVENT_M;
+
+	// Now Set up PortC Pin4 to do the capture (clock was enabled earlier)
+	// start by setting the alternate function for Port C bit 4 (WT0CCP0)
+	HWREG(GPIO_PORTC_BASE+GPIO_O_AFSEL) |= BIT4HI;
+
+	// Then, map bit 4's alternate function to WT0CCP0
+	// 7 is the mux value to select WT0CCP0, 16 to shift it over to the
+	// right nibble for bit 4 (4 bits/nibble * 4 bits)
+	HWREG(GPIO_PORTC_BASE+GPIO_O_PCTL) = 
+    (HWREG(GPIO_PORTC_BASE+GPIO_O_PCTL) & 0xfff0ffff) + (7<<16);
+
+	// Enable pin 4 on Port C as digital I/O
+	HWREG(GPIO_PORTC_BASE+GPIO_O_DEN) |= BIT4HI;
+	
+	// make pin 4 on Port C into an input
+	HWREG(GPIO_PORTC_BASE+GPIO_O_DIR) &= BIT4LO;
+
+	// back to the timer to enable a local capture interrupt
+  HWREG(WTIMER0_BASE+TIMER_O_IMR) |= TIMER_IMR_CAEIM;
+
+	// enable the Timer A in Wide Timer 0 interrupt in the NVIC
+	// it is interrupt number 94 so appears in EN2 at bit 30
+  HWREG(NVIC_EN2) |= BIT30HI;
+
+	// make sure interrupts are enabled globally
+  __enable_irq();
+
+	// now kick the timer off by enabling it and enabling the timer to
+	// stall while stopped by the debugger
+  HWREG(WTIMER0_BASE+TIMER_O_CTL) |= (TIMER_CTL_TAEN | TIMER_CTL_TASTALL);
+	
+	printf("IRSensor Initialized\n\r");
+	return true;
+}
+
+/****************************************************************************
+ Function
+   BeaconCaptureResponse
+
+ Parameters
+     none
+
+ Returns
+     none
+
+ Description
+		Adds the capture period to the histogram and records the edge time for
+		its band if enough recent periods agree. Constant time whatever the
+		number of bands, nothing is posted from here.
+****************************************************************************/
+void BeaconCaptureResponse( void )
+{
+	uint32_t ThisCapture;
+	uint32_t BeaconPeriod;
+	uint8_t bin = OVERFLOW_BIN;
+
+	// Clear the interrupt source
+	HWREG(WTIMER0_BASE+TIMER_O_ICR) = TIMER_ICR_CAECINT;
+
+	// Read the capture value and calculate the period
+	ThisCapture = HWREG(WTIMER0_BASE+TIMER_O_TAR);
+	BeaconPeriod = (ThisCapture - LastCapture);
+
+	// Update LastCapture to ThisCapture
+	LastCapture = ThisCapture;
+	LastPeriod = BeaconPeriod;
+
+	// Find the histogram bin and band for this period
+	if(BeaconPeriod < ((uint32_t)OVERFLOW_BIN << PERIOD_SHIFT)) {
+		bin = BeaconPeriod >> PERIOD_SHIFT;
+	}
+	uint8_t band = BinToBand[bin];
+
+	// Replace the oldest period in the histogram with this one
+	uint8_t oldest = History[HistoryIndex];
+	BinCounts[oldest]--;
+	BandCounts[BinToBand[oldest]]--;
+	History[HistoryIndex] = bin;
+	BinCounts[bin]++;
+	BandCounts[band]++;
+	HistoryIndex = (HistoryIndex + 1) % HISTORY_LENGTH;
+
+	if(band == NO_BAND || !Sweeping) {
+		return;
+	}
+
+	// Count the recent periods in or next to this bin, staying in the band
+	uint8_t consistent = BinCounts[bin];
+	if(bin > 0 && BinToBand[bin - 1] == band) {
+		consistent += BinCounts[bin - 1];
+	}
+	if(bin < OVERFLOW_BIN && BinToBand[bin + 1] == band) {
+		consistent += BinCounts[bin + 1];
+	}
+
+	if(consistent >= CONSISTENT_PERIODS) {
+		uint16_t now = ES_Timer_GetTime();
+		uint16_t theta = QueryMyKart().KartTheta;
+
+		// First edge of this pass over the beacon
+		if(!(BandsSeen & (1 << band))) {
+			FirstEdgeTime[band] = now;
+			FirstEdgeTheta[band] = theta;
+			PeakCounts[band] = 0;
+			BandsSeen |= (1 << band);
+		}
+		LastEdgeTime[band] = now;
+		LastEdgeTheta[band] = theta;
+		if(BandCounts[band] > PeakCounts[band]) {
+			PeakCounts[band] = BandCounts[band];
+		}
+	}
+}
+
+/****************************************************************************
+ Function
+   StartBeaconSweep
+
+ Parameters
+     none
+
+ Returns
+     none
+
+ Description
+		Starts looking for the beacon, call before rotating past it
+****************************************************************************/
+void StartBeaconSweep( void )
+{
+	EnterCritical();
+	ClearHistogram();
+	BandsSeen = 0;
+	Sweeping = true;
+	ExitCritical();
+}
+
+/****************************************************************************
+ Function
+   StopBeaconSweep
+
+ Parameters
+     none
+
+ Returns
+     none
+
+ Description
+		Stops looking for the beacon
+****************************************************************************/
+void StopBeaconSweep( void )
+{
+	Sweeping = false;
+}
+
+/****************************************************************************
+ Function
+   QueryBeaconBearing
+
+ Parameters
+     uint8_t band to get the bearing for
+
+ Returns
+     uint16_t kart theta halfway between the first and last beacon edges
+
+ Description
+		Bearing to the center of the beacon from the last sweep
+****************************************************************************/
+uint16_t QueryBeaconBearing( uint8_t Band )
+{
+	int16_t first;
+	int16_t last;
+
+	if(Band >= MAX_BEACON_BANDS) {
+		return 0;
+	}
+
+	EnterCritical();
+	first = FirstEdgeTheta[Band];
+	last = LastEdgeTheta[Band];
+	ExitCritical();
+
+	// Take the short way around between the two edges
+	int16_t spread = last - first;
+	if(spread > 180) {
+		spread -= 360;
+	}
+	if(spread < -180) {
+		spread += 360;
+	}
+
+	int16_t center = first + spread/2;
+	if(center < 0) {
+		center += 360;
+	}
+	return center % 360;
+}
+
+/****************************************************************************
+ Function
+   CheckBeaconSweep
+
+ Parameters
+     none
+
+ Returns
+     bool true if an event was posted
+
+ Description
+		Event checker, once the beam of a target band has passed posts
+		DetectedBeacon with the band and the time since the center of the
+		beacon packed into EventParam (see BEACON_EVENT_BAND/TIME). Bands
+		that never got a confident reading during the pass are dropped.
+****************************************************************************/
+bool CheckBeaconSweep( void )
+{
+	uint16_t first;
+	uint16_t last;
+	uint8_t peak;
+
+	if(!Sweeping || BandsSeen == 0) {
+		return false;
+	}
+
+	uint16_t now = ES_Timer_GetTime();
+	for(uint8_t band = 0; band < MAX_BEACON_BANDS; band++) {
+		if(!(BandsSeen & (1 << band))) {
+			continue;
+		}
+
+		EnterCritical();
+		first = FirstEdgeTime[band];
+		last = LastEdgeTime[band];
+		peak = PeakCounts[band];
+		ExitCritical();
+
+		if((uint16_t)(now - last) <= BEACON_LOST_TIME) {
+			continue;
+		}
+
+		// Beam has passed, start looking for the next pass of this band
+		EnterCritical();
+		BandsSeen &= ~(1 << band);
+		ExitCritical();
+
+		if(!Bands[band].Target || peak*100 < MIN_CONFIDENCE*HISTORY_LENGTH) {
+			continue;
+		}
+
+		// The center was halfway between the first and last edge
+		uint16_t sinceCenter = (uint16_t)(now - last) + (uint16_t)(last - first)/2;
+		if(sinceCenter > BEACON_TIME_MASK) {
+			sinceCenter = BEACON_TIME_MASK;
+		}
+		Sweeping = false;
+		DetectedBand = band;
+		ES_Event newEvent = {DetectedBeacon, (band << BEACON_BAND_SHIFT) | sinceCenter};
+		ES_EventBus_Publish(newEvent);
+		return true;
+	}
+	return false;
+}
+
+/****************************************************************************
+ Function
+   SetBeaconBand
+
+ Parameters
+     uint8_t band to set up
+     uint32_t shortest capture period in the band (40MHz ticks)
+     uint32_t longest capture period in the band (40MHz ticks)
+     bool true if we can shoot at this beacon, false for bands we only
+          want to recognize
+
+ Returns
+     bool false if the band or the periods are invalid
+
+ Description
+		Sets up a band and rebuilds the period lookup. The histogram is cleared
+		since its counts were made with the old bands.
+****************************************************************************/
+bool SetBeaconBand( uint8_t Band, uint32_t Low, uint32_t High, bool Target )
+{
+	if(Band >= MAX_BEACON_BANDS || Low >= High ||
+		 High >= ((uint32_t)OVERFLOW_BIN << PERIOD_SHIFT)) {
+		return false;
+	}
+
+	EnterCritical();
+	Bands[Band].Low = Low;
+	Bands[Band].High = High;
+	Bands[Band].Target = Target;
+	Bands[Band].Enabled = true;
+	BuildBandTable();
+	ClearHistogram();
+	BandsSeen = 0;
+	ExitCritical();
+	return true;
+}
+
+/****************************************************************************
+ Function
+   ClearBeaconBand
+
+ Parameters
+     uint8_t band to remove
+
+ Returns
+     none
+
+ Description
+		Stops tracking a band
+****************************************************************************/
+void ClearBeaconBand( uint8_t Band )
+{
+	if(Band >= MAX_BEACON_BANDS) {
+		return;
+	}
+
+	EnterCritical();
+	Bands[Band].Enabled = false;
+	BuildBandTable();
+	ClearHistogram();
+	BandsSeen = 0;
+	ExitCritical();
+}
+
+/****************************************************************************
+ Function
+   QueryBeaconConfidence
+
+ Parameters
+     uint8_t band
+
+ Returns
+     uint8_t percent of the recent capture periods that fell in the band
+
+ Description
+		How sure we are that this beacon is in view right now
+****************************************************************************/
+uint8_t QueryBeaconConfidence( uint8_t Band )
+{
+	if(Band >= MAX_BEACON_BANDS) {
+		return 0;
+	}
+	return BandCounts[Band]*100/HISTORY_LENGTH;
+}
+
+/****************************************************************************
+ Function
+   QueryDetectedBand
+
+ Parameters
+     none
+
+ Returns
+     uint8_t band of the last DetectedBeacon
+
+ Description
+		Lets the shooting state machine pick the bearing for the beacon it
+		was told about
+****************************************************************************/
+uint8_t QueryDetectedBand( void )
+{
+	return DetectedBand;
+}
+
+/****************************************************************************
+ Function
+   QueryBeaconPeriod
+
+ Parameters
+     none
+
+ Returns
+     uint32_t last capture period (40MHz ticks), in band or not
+****************************************************************************/
+uint32_t QueryBeaconPeriod( void )
+{
+	return LastPeriod;
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+
+// Empties the period history, everything starts in the overflow bin
+static void ClearHistogram( void )
+{
+	for(uint8_t i = 0; i < HISTORY_LENGTH; i++) {
+		History[i] = OVERFLOW_BIN;
+	}
+	for(uint16_t i = 0; i < PERIOD_BINS; i++) {
+		BinCounts[i] = 0;
+	}
+	for(uint8_t i = 0; i <= MAX_BEACON_BANDS; i++) {
+		BandCounts[i] = 0;
+	}
+	BinCounts[OVERFLOW_BIN] = HISTORY_LENGTH;
+	BandCounts[NO_BAND] = HISTORY_LENGTH;
+	HistoryIndex = 0;
+}
+
+// Fills in the band for each period bin, a bin belongs to a band if its
+// middle period is inside the band. Lower numbered bands win any overlap.
+static void BuildBandTable( void )
+{
+	for(uint16_t bin = 0; bin < PERIOD_BINS; bin++) {
+		uint32_t middle = ((uint32_t)bin << PERIOD_SHIFT) + (1 << (PERIOD_SHIFT - 1));
+		BinToBand[bin] = NO_BAND;
+		if(bin == OVERFLOW_BIN) {
+			continue;
+		}
+		for(uint8_t band = 0; band < MAX_BEACON_BANDS; band++) {
+			if(Bands[band].Enabled && middle > Bands[band].Low && middle < Bands[band].High) {
+				BinToBand[bin] = band;
+				break;
+			}
+		}
+	}
+}
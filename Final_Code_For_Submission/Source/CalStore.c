@@ -0,0 +1,504 @@
+/****************************************************************************
+ Module
+	CalStore.c
+
+ Revision			Revised by:
+	0.1.1				Alex
+	0.1.2				Alex
+	0.1.3				Alex
+
+ Description
+	Calibration constants that used to be compiled in, kept in the on-chip
+	EEPROM so they can be re-tuned from the console between heats. Every
+	record has a type and a default, and all of them are cached in RAM when
+	the store starts, so reading one is an array lookup.
+
+	The EEPROM holds a header, one two word record per calibration value and
+	a CRC of the lot:
+
+		word 0			CAL_MAGIC in the high half, layout version in the low
+		word 1			number of records
+		2 words each	record ID and type, then the value
+		last word		CRC-32 of everything before it
+
+	Records are matched by ID, so an image with records missing just gets
+	the defaults for them and records this build doesn't know are dropped.
+	A bad header or CRC, or an older layout, is replaced with a fresh image
+	as soon as the store starts. Setting a value writes its record and the
+	CRC straight away.
+
+	Builds for the PC (ES_HOST_PORT) keep the image in CAL_FILE_NAME instead.
+
+ Edits:
+	0.1.1 - Initial version with the drive, beacon, servo and kart select
+	        constants
+	0.1.2 - Drive speeds, and raw access by ID for the binary console
+	        instead of setting by name
+	0.1.3 - Rotation time and speed defaults come from PWM.h
+****************************************************************************/
+
+/*----------------------------- Include Files -----------------------------*/
+#include "Headers.h"
+#ifndef ES_HOST_PORT
+#include "driverlib/sysctl.h"
+#include "driverlib/eeprom.h"
+#endif
+
+/*----------------------------- Module Defines ----------------------------*/
+#define CAL_MAGIC 0xCA1Bu
+// Bump when the meaning of a stored record changes, and teach
+// MigrateRecord how to bring the old one up to date
+#define CAL_VERSION 1
+
+#define CAL_FILE_NAME "calibration.bin"
+
+// 2 KB of EEPROM on the TM4C123GH6PM
+#define EEPROM_WORDS 512
+
+// Word addresses in the image
+#define HEADER_WORDS 2
+#define RECORD_WORDS 2
+#define RECORD_ADDRESS(Index) ((HEADER_WORDS + (Index)*RECORD_WORDS)*4)
+#define CRC_ADDRESS RECORD_ADDRESS(NUM_CAL_RECORDS)
+
+typedef enum { CalU16, CalFloat } CalType_t;
+
+typedef union {
+			uint32_t			Raw;
+			float					Float;
+} CAL_VALUE_t;
+
+// What a record is, and the range a new value has to be in
+typedef struct {
+			const char		*Name;
+			CalType_t			Type;
+			float					Default;
+			float					Min;
+			float					Max;
+} CAL_INFO_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+static bool LoadImage( void );
+static bool MigrateRecord( uint16_t Version, uint8_t Id, uint32_t *Value );
+static void LoadDefaults( void );
+static bool WriteImage( void );
+static bool WriteRecord( CalId_t Id );
+static uint32_t ImageCRC( void );
+static uint32_t CRC32( uint32_t crc, uint32_t word );
+static bool StoreSet( CalId_t Id, CAL_VALUE_t Value );
+static bool ReadWords( uint32_t *Data, uint32_t Address, uint32_t Bytes );
+static bool WriteWords( uint32_t *Data, uint32_t Address, uint32_t Bytes );
+
+/*---------------------------- Module Variables ---------------------------*/
+// Indexed by CalId_t
+static const CAL_INFO_t CalInfo[NUM_CAL_RECORDS] = {
+	[CAL_P_GAIN] =						{"pgain", CalFloat, 1.5f, 0.0f, 10.0f},
+	[CAL_I_GAIN] =						{"igain", CalFloat, 0.1f, 0.0f, 10.0f},
+	[CAL_ROTATION_TIME] =			{"rotation", CalU16, ROTATION_TIME_DEFAULT, 500, 5000},
+	[CAL_PIXELS_PER_3SEC] =		{"pixels3s", CalU16, PIXELS_PER_3SEC_DEFAULT, 10, 500},
+	[CAL_BEACON_LOW] =				{"beaconlow", CalU16, 30000, 1, 65535},
+	[CAL_BEACON_HIGH] =				{"beaconhigh", CalU16, 33000, 1, 65535},
+	[CAL_SHOOTER_SET] =				{"shooterset", CalU16, 1400, 500, 2500},
+	[CAL_SHOOTER_FLICK] =			{"shooterflick", CalU16, 850, 500, 2500},
+	[CAL_SHOOTER_RESET] =			{"shooterreset", CalU16, 1900, 500, 2500},
+	[CAL_HOPPER_SET] =				{"hopperset", CalU16, 1000, 500, 2000},
+	[CAL_HOPPER_RELEASE] =		{"hopperrelease", CalU16, 1500, 500, 2000},
+	[CAL_KART_SELECT_LOW] =		{"kartlow", CalU16, 300, 0, 4095},
+	[CAL_KART_SELECT_HIGH] =	{"karthigh", CalU16, 1100, 0, 4095},
+	[CAL_HALF_SPEED_PORT] =			{"halfport", CalU16, 71, 0, 100},
+	[CAL_HALF_SPEED_STARBOARD] =	{"halfstbd", CalU16, 75, 0, 100},
+	[CAL_QUARTER_SPEED_PORT] =		{"quarterport", CalU16, 50, 0, 100},
+	[CAL_QUARTER_SPEED_STARBOARD] =	{"quarterstbd", CalU16, 53, 0, 100}
+};
+
+static CAL_VALUE_t Cache[NUM_CAL_RECORDS];
+static bool Ready = false;
+
+#ifdef ES_HOST_PORT
+static FILE *CalFile;
+#endif
+
+/*------------------------------ Module Code ------------------------------*/
+
+/****************************************************************************
+ Function
+	InitCalStore
+
+ Parameters
+	none
+
+ Returns
+	bool false if the stored calibration couldn't be used, the defaults are
+	in effect and have been written back
+
+ Description
+	Starts the EEPROM and fills the cache from it
+****************************************************************************/
+bool InitCalStore( void )
+{
+#ifdef ES_HOST_PORT
+	CalFile = fopen(CAL_FILE_NAME, "r+b");
+	if(CalFile == NULL) {
+		CalFile = fopen(CAL_FILE_NAME, "w+b");
+	}
+	Ready = (CalFile != NULL);
+#else
+	SysCtlPeripheralEnable(SYSCTL_PERIPH_EEPROM0);
+	while(!SysCtlPeripheralReady(SYSCTL_PERIPH_EEPROM0))
+		;
+	Ready = (EEPROMInit() == EEPROM_INIT_OK);
+#endif
+
+	if(!Ready) {
+		printf("Calibration store unavailable, using defaults \r\n");
+		LoadDefaults();
+		return false;
+	}
+	if(!LoadImage()) {
+		printf("Calibration reset to defaults \r\n");
+		LoadDefaults();
+		WriteImage();
+		return false;
+	}
+	return true;
+}
+
+/****************************************************************************
+ Function
+	GetCalU16
+
+ Parameters
+	CalId_t record to read, must be a whole number one
+
+ Returns
+	uint16_t the value
+****************************************************************************/
+uint16_t GetCalU16( CalId_t Id )
+{
+	return (uint16_t)Cache[Id].Raw;
+}
+
+/****************************************************************************
+ Function
+	GetCalFloat
+
+ Parameters
+	CalId_t record to read, must be a float one
+
+ Returns
+	float the value
+****************************************************************************/
+float GetCalFloat( CalId_t Id )
+{
+	return Cache[Id].Float;
+}
+
+/****************************************************************************
+ Function
+	SetCalU16
+
+ Parameters
+	CalId_t record to set
+	uint16_t new value
+
+ Returns
+	bool false if the record isn't a whole number one, the value is out of
+	range or it couldn't be saved
+
+ Description
+	Updates the cache and saves the record
+****************************************************************************/
+bool SetCalU16( CalId_t Id, uint16_t Value )
+{
+	if(Id >= NUM_CAL_RECORDS || CalInfo[Id].Type != CalU16 ||
+	   Value < CalInfo[Id].Min || Value > CalInfo[Id].Max) {
+		return false;
+	}
+	CAL_VALUE_t newValue = {Value};
+	return StoreSet(Id, newValue);
+}
+
+/****************************************************************************
+ Function
+	SetCalFloat
+
+ Parameters
+	CalId_t record to set
+	float new value
+
+ Returns
+	bool false if the record isn't a float one, the value is out of range
+	or it couldn't be saved
+
+ Description
+	Updates the cache and saves the record
+****************************************************************************/
+bool SetCalFloat( CalId_t Id, float Value )
+{
+	if(Id >= NUM_CAL_RECORDS || CalInfo[Id].Type != CalFloat ||
+	   !(Value >= CalInfo[Id].Min && Value <= CalInfo[Id].Max)) {
+		return false;
+	}
+	CAL_VALUE_t newValue;
+	newValue.Float = Value;
+	return StoreSet(Id, newValue);
+}
+
+/****************************************************************************
+ Function
+	SetCalRaw
+
+ Parameters
+	CalId_t record to set
+	uint32_t new value, the bits of a float for a float record
+
+ Returns
+	bool false if there is no such record, the value is out of range or it
+	couldn't be saved
+
+ Description
+	For the console, which doesn't know the record types at compile time
+****************************************************************************/
+bool SetCalRaw( CalId_t Id, uint32_t Value )
+{
+	if(Id >= NUM_CAL_RECORDS) {
+		return false;
+	}
+	if(CalInfo[Id].Type == CalFloat) {
+		CAL_VALUE_t newValue = {Value};
+		return SetCalFloat(Id, newValue.Float);
+	}
+	return (Value <= 0xFFFF && SetCalU16(Id, (uint16_t)Value));
+}
+
+/****************************************************************************
+ Function
+	GetCalRaw
+
+ Parameters
+	CalId_t record to read
+
+ Returns
+	uint32_t the value, the bits of a float for a float record
+****************************************************************************/
+uint32_t GetCalRaw( CalId_t Id )
+{
+	return (Id < NUM_CAL_RECORDS) ? Cache[Id].Raw : 0;
+}
+
+/****************************************************************************
+ Function
+	ResetCalStore
+
+ Parameters
+	none
+
+ Returns
+	none
+
+ Description
+	Puts every record back to its default and saves them
+****************************************************************************/
+void ResetCalStore( void )
+{
+	LoadDefaults();
+	if(Ready) {
+		WriteImage();
+	}
+}
+
+/****************************************************************************
+ Function
+	QueryCalInfo
+
+ Parameters
+	CalId_t record
+	const char ** set to the record's name
+	bool * set true for a float record
+
+ Returns
+	bool false if there is no such record
+****************************************************************************/
+bool QueryCalInfo( CalId_t Id, const char **pName, bool *pIsFloat )
+{
+	if(Id >= NUM_CAL_RECORDS) {
+		return false;
+	}
+	*pName = CalInfo[Id].Name;
+	*pIsFloat = (CalInfo[Id].Type == CalFloat);
+	return true;
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+
+// Fills the cache from the stored image, false if it has to be rewritten
+static bool LoadImage( void )
+{
+	uint32_t header[HEADER_WORDS];
+	uint32_t record[RECORD_WORDS];
+	uint32_t crc = 0xFFFFFFFF;
+	uint32_t storedCRC;
+
+	if(!ReadWords(header, 0, sizeof(header)) || (header[0] >> 16) != CAL_MAGIC) {
+		return false;
+	}
+	uint16_t version = header[0] & 0xFFFF;
+	uint32_t count = header[1];
+	if(count > (EEPROM_WORDS - HEADER_WORDS - 1)/RECORD_WORDS) {
+		return false;
+	}
+	crc = CRC32(CRC32(crc, header[0]), header[1]);
+
+	// Check the whole image before taking anything from it
+	for(uint32_t i = 0; i < count; i++) {
+		if(!ReadWords(record, RECORD_ADDRESS(i), sizeof(record))) {
+			return false;
+		}
+		crc = CRC32(CRC32(crc, record[0]), record[1]);
+	}
+	if(!ReadWords(&storedCRC, RECORD_ADDRESS(count), sizeof(storedCRC)) || storedCRC != ~crc) {
+		printf("Calibration CRC bad \r\n");
+		return false;
+	}
+
+	LoadDefaults();
+	for(uint32_t i = 0; i < count; i++) {
+		ReadWords(record, RECORD_ADDRESS(i), sizeof(record));
+		uint8_t id = record[0] & 0xFF;
+		uint8_t type = (record[0] >> 8) & 0xFF;
+		if(id < NUM_CAL_RECORDS && type == CalInfo[id].Type &&
+		   MigrateRecord(version, id, &record[1])) {
+			Cache[id].Raw = record[1];
+		}
+	}
+
+	// Anything other than the current layout with every record in its
+	// place is written back in the current one
+	bool current = (version == CAL_VERSION && count == NUM_CAL_RECORDS);
+	for(uint8_t i = 0; current && i < NUM_CAL_RECORDS; i++) {
+		ReadWords(record, RECORD_ADDRESS(i), sizeof(record));
+		current = ((record[0] & 0xFF) == i);
+	}
+	if(!current) {
+		printf("Calibration updated from version %d \r\n", version);
+		WriteImage();
+	}
+	return true;
+}
+
+// Brings a record from an older layout up to date, false to use the default
+// instead. IDs are never re-used, so a newer layout's records are still good.
+static bool MigrateRecord( uint16_t Version, uint8_t Id, uint32_t *Value )
+{
+	if(Version >= CAL_VERSION) {
+		return true;
+	}
+	// Add a case for each old version here, falling through to the newest.
+	// Version 1 is the first, so anything older isn't ours.
+	return false;
+}
+
+// Puts the defaults in the cache
+static void LoadDefaults( void )
+{
+	for(uint8_t i = 0; i < NUM_CAL_RECORDS; i++) {
+		if(CalInfo[i].Type == CalFloat) {
+			Cache[i].Float = CalInfo[i].Default;
+		}
+		else {
+			Cache[i].Raw = (uint16_t)CalInfo[i].Default;
+		}
+	}
+}
+
+// Writes the whole cache as a current image
+static bool WriteImage( void )
+{
+	uint32_t header[HEADER_WORDS] = {((uint32_t)CAL_MAGIC << 16) | CAL_VERSION, NUM_CAL_RECORDS};
+	if(!WriteWords(header, 0, sizeof(header))) {
+		return false;
+	}
+	for(uint8_t i = 0; i < NUM_CAL_RECORDS; i++) {
+		if(!WriteRecord((CalId_t)i)) {
+			return false;
+		}
+	}
+	uint32_t crc = ImageCRC();
+	return WriteWords(&crc, CRC_ADDRESS, sizeof(crc));
+}
+
+// Writes one record of a current image, the CRC has to be written after
+static bool WriteRecord( CalId_t Id )
+{
+	uint32_t record[RECORD_WORDS] = {((uint32_t)CalInfo[Id].Type << 8) | Id, Cache[Id].Raw};
+	return WriteWords(record, RECORD_ADDRESS(Id), sizeof(record));
+}
+
+// CRC of a current image made from the cache
+static uint32_t ImageCRC( void )
+{
+	uint32_t crc = 0xFFFFFFFF;
+	crc = CRC32(crc, ((uint32_t)CAL_MAGIC << 16) | CAL_VERSION);
+	crc = CRC32(crc, NUM_CAL_RECORDS);
+	for(uint8_t i = 0; i < NUM_CAL_RECORDS; i++) {
+		crc = CRC32(crc, ((uint32_t)CalInfo[i].Type << 8) | i);
+		crc = CRC32(crc, Cache[i].Raw);
+	}
+	return ~crc;
+}
+
+// Adds a word to a CRC-32, least significant byte first
+static uint32_t CRC32( uint32_t crc, uint32_t word )
+{
+	for(uint8_t bit = 0; bit < 32; bit++) {
+		bool feedback = (crc ^ (word >> bit)) & 1;
+		crc >>= 1;
+		if(feedback) {
+			crc ^= 0xEDB88320u;
+		}
+	}
+	return crc;
+}
+
+// Caches a checked value and saves it with the new CRC
+static bool StoreSet( CalId_t Id, CAL_VALUE_t Value )
+{
+	Cache[Id] = Value;
+	if(!Ready) {
+		return false;
+	}
+	uint32_t crc = ImageCRC();
+	return WriteRecord(Id) && WriteWords(&crc, CRC_ADDRESS, sizeof(crc));
+}
+
+// Reads whole words from the image, Address and Bytes are multiples of 4
+static bool ReadWords( uint32_t *Data, uint32_t Address, uint32_t Bytes )
+{
+#ifdef ES_HOST_PORT
+	return (fseek(CalFile, Address, SEEK_SET) == 0 &&
+	        fread(Data, 1, Bytes, CalFile) == Bytes);
+#else
+	if(Address + Bytes > EEPROM_WORDS*4) {
+		return false;
+	}
+	EEPROMRead(Data, Address, Bytes);
+	return true;
+#endif
+}
+
+// Writes whole words to the image, Address and Bytes are multiples of 4
+static bool WriteWords( uint32_t *Data, uint32_t Address, uint32_t Bytes )
+{
+#ifdef ES_HOST_PORT
+	return (fseek(CalFile, Address, SEEK_SET) == 0 &&
+	        fwrite(Data, 1, Bytes, CalFile) == Bytes &&
+	        fflush(CalFile) == 0);
+#else
+	if(Address + Bytes > EEPROM_WORDS*4) {
+		return false;
+	}
+	return (EEPROMProgram(Data, Address, Bytes) == 0);
+#endif
+}
@@ -0,0 +1,360 @@
+/****************************************************************************
+ Module
+	Console.c
+
+ Revision			Revised by:
+	0.1.1				Alex
+	0.1.2				Alex
+
+ Description
+	Binary console on the debug UART, replaces the keystroke test events.
+	The host (Tools/console.py) sends framed commands to read and set the
+	calibration parameters, post any event with a parameter and pick the
+	telemetry channels. See Console.h for the frame layout.
+
+	Check4Console is an event checker, so it has to be quick. Each call
+	reads at most CONSOLE_RX_BUDGET bytes and handles at most one command.
+	Frames are queued whole on the transmit buffer in termio.c and never
+	wait for the UART. A partial frame is thrown away if the rest doesn't
+	arrive within CONSOLE_FRAME_TIMEOUT, as is a frame with a bad CRC, and
+	the host tries again.
+
+	printf text shares the UART. It goes out between frames, never inside
+	one, and the host shows anything that isn't a frame as log text.
+
+ Edits:
+	0.1.1 - Initial version, replaces Check4Keystroke
+	0.1.2 - Streaming moved to Telemetry.c, the commands here pick the
+	        channels
+****************************************************************************/
+
+/*----------------------------- Include Files -----------------------------*/
+#include "Headers.h"
+#include "ES_EventPool.h"
+#include "termio.h"
+#include "Console.h"
+#include "Telemetry.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define CONSOLE_VERSION 1
+#define CONSOLE_RX_BUDGET 16			// Bytes read per check
+#define CONSOLE_FRAME_TIMEOUT 50		// ms allowed between bytes of a frame
+
+typedef enum { WaitingForSync, WaitingForCommand, WaitingForLength,
+							 ReadingPayload, WaitingForCRCLow, WaitingForCRCHigh } RxState_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+static bool ReceiveByte( uint8_t Byte );
+static bool HandleCommand( void );
+static bool PostConsoleEvent( void );
+static void SetTelemetry( uint8_t *Reply );
+static uint16_t CRC16( uint16_t crc, uint8_t Byte );
+static void PutU16( uint8_t *Buffer, uint16_t Value );
+static void PutU32( uint8_t *Buffer, uint32_t Value );
+static uint16_t GetU16( const uint8_t *Buffer );
+static uint32_t GetU32( const uint8_t *Buffer );
+
+/*---------------------------- Module Variables ---------------------------*/
+// Frame being received
+static RxState_t RxState = WaitingForSync;
+static uint8_t RxCommand;
+static uint8_t RxLength;
+static uint8_t RxCount;
+static uint8_t RxPayload[CONSOLE_MAX_PAYLOAD];
+static uint16_t RxCRC;
+static uint8_t RxCRCLow;
+static uint16_t LastByteTime;
+
+/*------------------------------ Module Code ------------------------------*/
+
+/****************************************************************************
+ Function
+	Check4Console
+
+ Parameters
+	none
+
+ Returns
+	bool true if a command from the host posted an event
+
+ Description
+	Keeps the transmit buffer moving and takes in what the host has sent
+****************************************************************************/
+bool Check4Console( void )
+{
+	bool posted = false;
+	uint16_t now = ES_Timer_GetTime();
+
+	TERMIO_Service();
+
+	if(RxState != WaitingForSync && (uint16_t)(now - LastByteTime) > CONSOLE_FRAME_TIMEOUT) {
+		RxState = WaitingForSync;
+	}
+	for(uint8_t i = 0; i < CONSOLE_RX_BUDGET && IsNewKeyReady(); i++) {
+		LastByteTime = now;
+		if(ReceiveByte(GetNewKey())) {
+			posted = HandleCommand();
+			break;
+		}
+	}
+	return posted;
+}
+
+/****************************************************************************
+ Function
+	SendConsoleFrame
+
+ Parameters
+	uint8_t command
+	const uint8_t * payload
+	uint8_t payload length, up to CONSOLE_MAX_PAYLOAD
+
+ Returns
+	bool false if the transmit buffer couldn't take the whole frame, none
+	of it is sent
+
+ Description
+	Frames the payload and queues it, never waits for the UART
+****************************************************************************/
+bool SendConsoleFrame( uint8_t Command, const uint8_t *Payload, uint8_t Length )
+{
+	uint8_t frame[CONSOLE_MAX_PAYLOAD + CONSOLE_FRAME_OVERHEAD];
+	uint16_t crc = 0xFFFF;
+
+	if(Length > CONSOLE_MAX_PAYLOAD) {
+		return false;
+	}
+	frame[0] = CONSOLE_SYNC;
+	frame[1] = Command;
+	frame[2] = Length;
+	for(uint8_t i = 0; i < Length; i++) {
+		frame[3 + i] = Payload[i];
+	}
+	for(uint8_t i = 1; i < Length + 3; i++) {
+		crc = CRC16(crc, frame[i]);
+	}
+	PutU16(&frame[Length + 3], crc);
+	return TERMIO_Write(frame, Length + CONSOLE_FRAME_OVERHEAD);
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+
+// Steps the frame parser, true once a whole frame with a good CRC is in
+static bool ReceiveByte( uint8_t Byte )
+{
+	switch(RxState) {
+		case WaitingForSync:
+			if(Byte == CONSOLE_SYNC) {
+				RxCRC = 0xFFFF;
+				RxState = WaitingForCommand;
+			}
+			break;
+
+		case WaitingForCommand:
+			RxCommand = Byte;
+			RxCRC = CRC16(RxCRC, Byte);
+			RxState = WaitingForLength;
+			break;
+
+		case WaitingForLength:
+			RxLength = Byte;
+			RxCount = 0;
+			RxCRC = CRC16(RxCRC, Byte);
+			if(RxLength > CONSOLE_MAX_PAYLOAD) {
+				RxState = WaitingForSync;
+			}
+			else {
+				RxState = (RxLength == 0) ? WaitingForCRCLow : ReadingPayload;
+			}
+			break;
+
+		case ReadingPayload:
+			RxPayload[RxCount++] = Byte;
+			RxCRC = CRC16(RxCRC, Byte);
+			if(RxCount == RxLength) {
+				RxState = WaitingForCRCLow;
+			}
+			break;
+
+		case WaitingForCRCLow:
+			RxCRCLow = Byte;
+			RxState = WaitingForCRCHigh;
+			break;
+
+		case WaitingForCRCHigh:
+			RxState = WaitingForSync;
+			return (RxCRC == (((uint16_t)Byte << 8) | RxCRCLow));
+	}
+	return false;
+}
+
+// Carries out the received command and replies, true if it posted an event
+static bool HandleCommand( void )
+{
+	uint8_t reply[CONSOLE_MAX_PAYLOAD];
+	uint8_t length = 1;
+	bool posted = false;
+	CalId_t id = (CalId_t)RxPayload[0];
+	const char *name;
+	bool isFloat;
+
+	reply[0] = CONSOLE_OK;
+	switch(RxCommand) {
+		case CONSOLE_PING:
+			reply[1] = CONSOLE_VERSION;
+			reply[2] = NUM_CAL_RECORDS;
+			reply[3] = NUM_ES_EVENTS;
+			reply[4] = NUM_TELEMETRY_CHANNELS;
+			length = 5;
+			break;
+
+		case CONSOLE_PARAM_INFO:
+			if(RxLength != 1) {
+				reply[0] = CONSOLE_BAD_LENGTH;
+			}
+			else if(!QueryCalInfo(id, &name, &isFloat)) {
+				reply[0] = CONSOLE_BAD_ID;
+			}
+			else {
+				reply[1] = id;
+				reply[2] = isFloat;
+				PutU32(&reply[3], GetCalRaw(id));
+				for(length = 7; *name != '\0' && length < CONSOLE_MAX_PAYLOAD; length++) {
+					reply[length] = *name++;
+				}
+			}
+			break;
+
+		case CONSOLE_PARAM_GET:
+		case CONSOLE_PARAM_SET:
+			if(RxLength != ((RxCommand == CONSOLE_PARAM_SET) ? 5 : 1)) {
+				reply[0] = CONSOLE_BAD_LENGTH;
+			}
+			else if(id >= NUM_CAL_RECORDS) {
+				reply[0] = CONSOLE_BAD_ID;
+			}
+			else {
+				if(RxCommand == CONSOLE_PARAM_SET && !SetCalRaw(id, GetU32(&RxPayload[1]))) {
+					reply[0] = CONSOLE_REJECTED;
+				}
+				reply[1] = id;
+				PutU32(&reply[2], GetCalRaw(id));
+				length = 6;
+			}
+			break;
+
+		case CONSOLE_PARAM_RESET:
+			ResetCalStore();
+			break;
+
+		case CONSOLE_POST_EVENT:
+			if(RxLength != 4) {
+				reply[0] = CONSOLE_BAD_LENGTH;
+			}
+			else {
+				posted = PostConsoleEvent();
+				if(!posted) {
+					reply[0] = CONSOLE_REJECTED;
+				}
+			}
+			break;
+
+		case CONSOLE_TELEMETRY:
+			SetTelemetry(reply);
+			break;
+
+		case CONSOLE_TELEMETRY_INFO:
+			if(RxLength != 1) {
+				reply[0] = CONSOLE_BAD_LENGTH;
+			}
+			else if(!QueryTelemetryChannel(RxPayload[0], &name, &reply[2])) {
+				reply[0] = CONSOLE_BAD_ID;
+			}
+			else {
+				reply[1] = RxPayload[0];
+				for(length = 3; *name != '\0' && length < CONSOLE_MAX_PAYLOAD; length++) {
+					reply[length] = *name++;
+				}
+			}
+			break;
+
+		case CONSOLE_TELEMETRY_STOP:
+			StopTelemetry();
+			break;
+
+		default:
+			reply[0] = CONSOLE_BAD_COMMAND;
+			break;
+	}
+	SendConsoleFrame(RxCommand | CONSOLE_REPLY, reply, length);
+	return posted;
+}
+
+// Sets the channel and decimation pairs in the received command, all of
+// them or none
+static void SetTelemetry( uint8_t *Reply )
+{
+	if(RxLength == 0 || RxLength % 2 != 0) {
+		Reply[0] = CONSOLE_BAD_LENGTH;
+		return;
+	}
+	for(uint8_t i = 0; i < RxLength; i += 2) {
+		if(RxPayload[i] >= NUM_TELEMETRY_CHANNELS) {
+			Reply[0] = CONSOLE_BAD_ID;
+			return;
+		}
+	}
+	for(uint8_t i = 0; i < RxLength; i += 2) {
+		SetTelemetryChannel(RxPayload[i], RxPayload[i + 1]);
+	}
+}
+
+// Posts the event in the received command, false if it isn't one we can
+// make up. Pooled events carry a handle, not a value.
+static bool PostConsoleEvent( void )
+{
+	ES_Event newEvent;
+	newEvent.EventType = (ES_EventTyp_t)GetU16(&RxPayload[0]);
+	newEvent.EventParam = GetU16(&RxPayload[2]);
+
+	if(newEvent.EventType <= ES_EXIT || newEvent.EventType >= NUM_ES_EVENTS ||
+	   ES_EventPool_IsPooled(newEvent.EventType)) {
+		return false;
+	}
+	return PostMaster(newEvent);
+}
+
+// Adds a byte to a CRC-16/CCITT
+static uint16_t CRC16( uint16_t crc, uint8_t Byte )
+{
+	crc ^= (uint16_t)Byte << 8;
+	for(uint8_t bit = 0; bit < 8; bit++) {
+		crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+	}
+	return crc;
+}
+
+// Little endian packing for the frames
+static void PutU16( uint8_t *Buffer, uint16_t Value )
+{
+	Buffer[0] = Value & 0xFF;
+	Buffer[1] = Value >> 8;
+}
+
+static void PutU32( uint8_t *Buffer, uint32_t Value )
+{
+	PutU16(Buffer, Value & 0xFFFF);
+	PutU16(&Buffer[2], Value >> 16);
+}
+
+static uint16_t GetU16( const uint8_t *Buffer )
+{
+	return Buffer[0] | ((uint16_t)Buffer[1] << 8);
+}
+
+static uint32_t GetU32( const uint8_t *Buffer )
+{
+	return GetU16(Buffer) | ((uint32_t)GetU16(&Buffer[2]) << 16);
+}
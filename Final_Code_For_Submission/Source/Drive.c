@@ -7,6 +7,9 @@
 	0.1.2       Alex
 	0.1.3				Alex
 	0.1.4				Denny
+	0.1.5				Alex
+	0.1.6				Alex
+	0.1.7				Alex
 
  Description
 	Drive module initializes PWM and motor pins and provides public functions useful
@@ -17,6 +20,11 @@
 	0.1.2 - changed to implament for adjustments before arrival at waypoint 
 	0.1.3 - added ability to manuver between driving, shooting, and obstacle states
 	0.1.4 - added banking turns for small angle adjustments while driving straight
+	0.1.5 - straight moves and full turns follow trapezoidal velocity profiles,
+	        setpoints are streamed to the motors on every CONTROL_TIMER tick
+	0.1.6 - added TurnToHeading to spin in place to an absolute heading
+	0.1.7 - keeps the point being driven to for telemetry, which replaces
+	        the printouts of the intermediate path calculations
 ****************************************************************************/
 // If we are debugging and setting our own Game/KART states
 #define TEST
@@ -29,14 +37,37 @@
 #define PosResolution 10
 #define AngleResolution 10
 
+// Cruise speeds measured at half speed duty, accelerations reach them in 1/4 sec
+#define DRIVE_VELOCITY ((float)PIXELS_PER_3SEC/3)
+#define DRIVE_ACCELERATION (DRIVE_VELOCITY*4)
+#define ROTATE_VELOCITY (360.0f*ONE_SEC/ROTATION_TIME)
+#define ROTATE_ACCELERATION (ROTATE_VELOCITY*4)
+
+// Extra degrees for sections where turns were too shallow (used to be 40 ticks)
+#define SHALLOW_TURN_CORRECTION (40*360.0f/ROTATION_TIME)
+
+typedef enum { NoMove, LinearMove, RotateMove } MoveType_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+static void StartMove( MoveType_t Move );
+static void StepMove( void );
+static void ApplySetpoint( void );
+static uint8_t SpeedToDuty( float Speed, uint8_t HalfSpeedDuty );
+
 /*---------------------------- Module Variables ---------------------------*/
 static float dist;
 static int driveTime;
 static POINT_t currentPoint;
+static POINT_t targetPoint;
 static bool counterClockwiseRotate = false;
 static uint16_t thetaTime;
 static uint16_t turningTheta;
 
+static PROFILE_t DriveProfile;
+static PROFILE_t RotateProfile;
+static MoveType_t ActiveMove = NoMove;
+static uint16_t MoveTime;
+
 /*------------------------------ Module Code ------------------------------*/
 
 /****************************************************************************
@@ -94,6 +125,14 @@ ES_Event RunDrive ( ES_Event ThisEvent )
 		// Eat all timers
 		ES_Timer_StopTimer(DRIVE_TIMER);
 		ES_Timer_StopTimer(ROTATE_TIMER);
+		ES_Timer_StopTimer(CONTROL_TIMER);
+		ActiveMove = NoMove;
+	}
+	// Control tick means it is time for the next profile setpoint
+	if(ThisEvent.EventType == ES_TIMEOUT && ThisEvent.EventParam == CONTROL_TIMER){
+		if(ActiveMove != NoMove) {
+			StepMove();
+		}
 	}
 	// Drive timer time out means that the bot is at its final location 
 	if(ThisEvent.EventType == ES_TIMEOUT && ThisEvent.EventParam == DRIVE_TIMER){
@@ -113,23 +152,18 @@ ES_Event RunDrive ( ES_Event ThisEvent )
 
 // Calculate drive time and rotate time required to move to a given point from current position
 void Calculate ( uint16_t X, uint16_t Y ) {
-	printf("Desired Coordinates: %d %d \n\r", X, Y);
+	targetPoint.X = X;
+	targetPoint.Y = Y;
 	
 	// Query DRS for current postion, angle
 	KART_t myKart = QueryMyKart( );
 	currentPoint.X = myKart.KartX;
 	currentPoint.Y = myKart.KartY;
 	
-	printf("Current Kart Data X: %d Y: %d Theta: %d \n\r", myKart.KartX, myKart.KartY, myKart.KartTheta);
-	
 	// Find distance to travel
 	float deltaX = X - myKart.KartX;
 	float deltaY = Y - myKart.KartY; 
 	dist = sqrt(pow(deltaX,2) + pow(deltaY,2));
-	// Calculate time needed to travel desired distance
-	driveTime = dist*3*ONE_SEC/PIXELS_PER_3SEC ;
-	
-	printf("deltaX: %f deltaY: %f penis1\n\r", deltaX, deltaY);
 	
 	// Take absolute value of deltaX and deltaY to ensure accurate angle calculations 
 	float absDeltaX = deltaX;
@@ -144,7 +178,6 @@ void Calculate ( uint16_t X, uint16_t Y ) {
 	
 	// Calculate angle
 	int desiredTheta = abs(atan((absDeltaY)/(absDeltaX)) * 180 / PI); 
-	printf("Arctan Output: %d \n\r", desiredTheta);
 	
 	// Calculate the desired theta desired based on the 
 	// left handed coordiante system and right handed theta*/
@@ -195,47 +228,44 @@ void Calculate ( uint16_t X, uint16_t Y ) {
 		deltaTheta = deltaTheta + 360;
 	}
 
-	printf("deltaTheta: %d \n\r", deltaTheta);
-	
-	// Calculate the time needed to rotate deltaTheta
+	// Find the direction to rotate
 	if(deltaTheta > 0) {
 		// Counter-clockwise rotation
 		counterClockwiseRotate = true;
-		// Set timer according to deltaTheta
-		thetaTime = ROTATION_TIME*deltaTheta/360;
 	}
 	else if(deltaTheta < 0) {
 		deltaTheta = abs(deltaTheta);
     // Clockwise direction
 		counterClockwiseRotate = false;
-		// Set timer according to deltaTheta
-		thetaTime = ROTATION_TIME*deltaTheta/360;
-	}
-	else if(deltaTheta == 0) {
-		// Set very small rotate timer
-		thetaTime = 0;
 	}
 	
 	// Save magnitude of theta to turn
 	turningTheta = deltaTheta;
 	
-	printf("Drive Time:%d Theta Time: %d \n\r", driveTime, thetaTime);
-	
-	// Limit all driving to half a second at most
-	if(driveTime > ONE_SEC/2) {
-		driveTime = ONE_SEC/2;
-	}
-	
 	// Manual corrections for places in which turns were too shallow
-	if (FindSection(currentPoint) == TopStraight) {
-		thetaTime += 40;
+	float rotateDist = turningTheta;
+	MapSection currentSection = FindSection(currentPoint);
+	if (currentSection == TopStraight || currentSection == RightStraight) {
+		rotateDist += SHALLOW_TURN_CORRECTION;
 	}
-		if (FindSection(currentPoint) == RightStraight) {
-		thetaTime += 40;
+	
+	// Plan the rotation, the profile tells us how long it will take
+	PlanProfile(&RotateProfile, rotateDist, ROTATE_VELOCITY, ROTATE_ACCELERATION);
+	thetaTime = RotateProfile.TotalTime;
+	
+	// Modulate drive distance to account for delay in DRS readings and limit
+	// all driving to half a second at most
+	float driveDist = dist*0.9;
+	float maxDriveDist = ProfileDistanceForTime(ONE_SEC/2, DRIVE_VELOCITY, DRIVE_ACCELERATION);
+	if(driveDist > maxDriveDist) {
+		driveDist = maxDriveDist;
 	}
 	
-	// Modulate drive time to account for delay in DRS readings
-	driveTime = driveTime*0.9;
+	// Plan the straight line move
+	PlanProfile(&DriveProfile, driveDist, DRIVE_VELOCITY, DRIVE_ACCELERATION);
+	driveTime = DriveProfile.TotalTime;
+	
+	printf("Drive Time:%d Theta Time: %d \n\r", driveTime, thetaTime);
 	
 	// Post that path generation is complete
 	ES_Event newEvent = {PathGenerated, 0};
@@ -253,17 +283,9 @@ void DriveForward( void ) {
 		ES_Event newEvent = {ES_TIMEOUT,DRIVE_TIMER};
 		PostMaster(newEvent);
 	}
-	// Otherwise drive forward for calculated time
+	// Otherwise follow the planned drive profile
 	else {
-		// Set Motors forward, drive for length of drive timer
-		HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~ BIT3HI;
-		HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~ BIT2HI;
-		// Set PWM to (HalfSpeed)
-		SetPWMDuty(HALF_SPEED_PORT,PORT_MOTOR);
-		SetPWMDuty(HALF_SPEED_STARBOARD,STARBOARD_MOTOR);
-	
-		// Start timer for drive time
-		ES_Timer_InitTimer(DRIVE_TIMER,driveTime);
+		StartMove(LinearMove);
 	}
 }
 
@@ -311,27 +333,69 @@ void TurnTheta( void ) {
 	// Full turn
 	else {
 		printf("Reverse Turn\r\n");
-		// Check direction of turn
-		if(counterClockwiseRotate) {
-			// Set to turn counter-clockwise, drive for length of drive timer
-			HWREG(GPIO_PORTB_BASE + ALL_BITS) |= BIT3HI;
-			HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~ BIT2HI;
-		}
-		else {
-			// Set to turn clockwise, drive for length of drive timer
-			HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~BIT3HI;
-			HWREG(GPIO_PORTB_BASE + ALL_BITS) |=  BIT2HI;
-		}
-		
-		// Set PWM to (HalfSpeed) for both motors
-		SetPWMDuty(HALF_SPEED_PORT,PORT_MOTOR);
-		SetPWMDuty(HALF_SPEED_STARBOARD,STARBOARD_MOTOR);
-		
-		// Start timer for drive time
-		ES_Timer_InitTimer(ROTATE_TIMER,thetaTime);
+		// Spin in place following the planned rotation profile
+		StartMove(RotateMove);
 	}
 }
 
+// Spins in place to face the given heading, posts AtNextAngle when done
+void TurnToHeading( uint16_t Theta ) {
+	KART_t myKart = QueryMyKart( );
+	int deltaTheta = Theta - myKart.KartTheta;
+	
+	// Garuntee that the bot never rotates more than 180 degrees
+	if(deltaTheta > 180) {
+		deltaTheta = deltaTheta - 360;
+	}
+	if(deltaTheta < (-1)*180) {
+		deltaTheta = deltaTheta + 360;
+	}
+	
+	counterClockwiseRotate = (deltaTheta > 0);
+	turningTheta = abs(deltaTheta);
+	printf("Turn To Heading %d, deltaTheta: %d \r\n", Theta, deltaTheta);
+	
+	// Already facing the right way
+	if( turningTheta == 0 ) {
+		ES_Event newEvent = {AtNextAngle, 0};
+		PostMaster(newEvent);
+		return;
+	}
+	
+	// Always spin in place, a bank turn would move us off the point
+	PlanProfile(&RotateProfile, turningTheta, ROTATE_VELOCITY, ROTATE_ACCELERATION);
+	thetaTime = RotateProfile.TotalTime;
+	StartMove(RotateMove);
+}
+
+// Sets the wheel speeds as a fraction of half speed, negative values reverse the wheel
+void SetWheelSpeeds( float PortSpeed, float StarboardSpeed ) {
+	// Port direction is on B3
+	if(PortSpeed < 0) {
+		HWREG(GPIO_PORTB_BASE + ALL_BITS) |= BIT3HI;
+		PortSpeed = -PortSpeed;
+	}
+	else {
+		HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~BIT3HI;
+	}
+	// Starboard direction is on B2
+	if(StarboardSpeed < 0) {
+		HWREG(GPIO_PORTB_BASE + ALL_BITS) |= BIT2HI;
+		StarboardSpeed = -StarboardSpeed;
+	}
+	else {
+		HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~BIT2HI;
+	}
+	
+	SetPWMDuty(SpeedToDuty(PortSpeed, HALF_SPEED_PORT),PORT_MOTOR);
+	SetPWMDuty(SpeedToDuty(StarboardSpeed, HALF_SPEED_STARBOARD),STARBOARD_MOTOR);
+}
+
+// Point the last Calculate planned a move to
+POINT_t QueryDriveTarget( void ) {
+	return targetPoint;
+}
+
 // Checks given value against robot position, return true if within resolution
 bool CheckVal(uint16_t val, int select) {
 	// Select: 0 = X, 1 = Y, 2 = Theta
@@ -364,3 +428,73 @@ bool CheckVal(uint16_t val, int select) {
 	return returnVal;
 }
 
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+
+// Starts streaming setpoints for a planned move
+static void StartMove( MoveType_t Move ) {
+	ActiveMove = Move;
+	MoveTime = 0;
+	ApplySetpoint();
+	ES_Timer_InitTimer(CONTROL_TIMER,CONTROL_TICK);
+}
+
+// Advances the active move by one control tick, posts when the move is done
+static void StepMove( void ) {
+	const PROFILE_t *profile = &DriveProfile;
+	if(ActiveMove == RotateMove) {
+		profile = &RotateProfile;
+	}
+	
+	MoveTime += CONTROL_TICK;
+	
+	// Profile is finished, stop and let the state machines know
+	if(MoveTime >= profile->TotalTime) {
+		ES_Event newEvent = {AtNextPoint, 0};
+		if(ActiveMove == RotateMove) {
+			newEvent.EventType = AtNextAngle;
+		}
+		ActiveMove = NoMove;
+		SetWheelSpeeds(0,0);
+		PostMaster(newEvent);
+	}
+	// Otherwise send the next setpoint
+	else {
+		ApplySetpoint();
+		ES_Timer_InitTimer(CONTROL_TIMER,CONTROL_TICK);
+	}
+}
+
+// Sends the profile velocity for the coming tick to the motors
+static void ApplySetpoint( void ) {
+	// Sample the middle of the tick so distance covered matches the plan
+	uint16_t sampleTime = MoveTime + CONTROL_TICK/2;
+	
+	if(ActiveMove == LinearMove) {
+		float speed = QueryProfileVelocity(&DriveProfile, sampleTime)/DRIVE_VELOCITY;
+		SetWheelSpeeds(speed, speed);
+	}
+	else if(ActiveMove == RotateMove) {
+		float speed = QueryProfileVelocity(&RotateProfile, sampleTime)/ROTATE_VELOCITY;
+		// Counter-clockwise reverses the port wheel
+		if(counterClockwiseRotate) {
+			SetWheelSpeeds(-speed, speed);
+		}
+		else {
+			SetWheelSpeeds(speed, -speed);
+		}
+	}
+}
+
+// Maps a speed (fraction of half speed) to a duty, keeping moving wheels above stall
+static uint8_t SpeedToDuty( float Speed, uint8_t HalfSpeedDuty ) {
+	if(Speed <= 0) {
+		return 0;
+	}
+	float duty = MIN_DRIVE_DUTY + (HalfSpeedDuty - MIN_DRIVE_DUTY)*Speed;
+	if(duty > 100) {
+		duty = 100;
+	}
+	return (uint8_t)duty;
+}
@@ -6,6 +6,9 @@
 	0.1.1				Alex
 	0.1.2				Alex
 	0.2.1				Alex
+	0.2.2				Alex
+	0.3.1				Alex
+	0.3.2				Alex
 
  Description
 	Driving state machine that controls the driving
@@ -14,6 +17,11 @@
 	0.1.1 - Set up as template 
 	0.1.2 - Separated moving state into a turning state and driving state
 	0.2.1 - Added all possible waypoints
+	0.2.2 - Added path following state to drive through waypoints without stopping
+	0.3.1 - Runs on the table driven HSM engine, the choice between following
+	        the path and stop-turn-drive is a guard
+	0.3.2 - Position comes from the KartUpdated payload instead of a DRS
+	        query on every event
 ****************************************************************************/
 /*----------------------------- Include Files -----------------------------*/
 #include "Headers.h"
@@ -21,17 +29,13 @@
 /*----------------------------- Module Defines ----------------------------*/
 
 /*---------------------------- Module Functions ---------------------------*/
-static ES_Event DuringAtPositionState( ES_Event Event );
-static ES_Event DuringGeneratePathState( ES_Event Event );
-static ES_Event DuringTurningState( ES_Event Event );
-static ES_Event DuringDrivingForwardState( ES_Event Event );
-
+// Entry, exit, during and guard prototypes are generated with the tables below
+static void UpdateCurrentPoint( const ES_Event *Event );
 static POINT_t FindNextPoint( POINT_t current );
+static bool ShotPending( void );
+static bool ObstaclePending( void );
 
 /*---------------------------- Module Variables ---------------------------*/
-// everybody needs a state variable, you may need others as well
-static DrivingState CurrentState;
-
 POINT_t currentPoint;
 POINT_t nextPoint;
 static bool notShot = true;
@@ -46,138 +50,105 @@ uint16_t cornerPointMatrix_Y[4] = {BR_Y, TR_Y, TL_Y, BL_Y};
 POINT_t ObstacleEntry = {OE_X,OE_Y};
 POINT_t ShootingPoint = {SP_X,SP_Y};
 
+/*--------------------------- hsm_gen: tables ----------------------------*/
+static void EntryAtPositionState( const ES_Event *Event );
+static void ExitAtPositionState( const ES_Event *Event );
+static void EntryGeneratePathState( const ES_Event *Event );
+static void ExitGeneratePathState( const ES_Event *Event );
+static void EntryTurningState( const ES_Event *Event );
+static void ExitTurningState( const ES_Event *Event );
+static void EntryDrivingForwardState( const ES_Event *Event );
+static void ExitDrivingForwardState( const ES_Event *Event );
+static void EntryFollowingPathState( const ES_Event *Event );
+static void ExitFollowingPathState( const ES_Event *Event );
+static void DuringFollowingPathState( ES_Event *Event );
+static bool CanFollowPath( const ES_Event *Event );
+
+// Transition tables, one per state
+static const HSM_TRANSITION_t AtPositionTransitions[] = {
+	// Keep driving along the path if we are lined up with it, otherwise stop
+	// and turn toward the next point
+	{NextPointCalculated, FollowingPathState, CanFollowPath, NULL, false, "Next Point Calculated"},
+	{NextPointCalculated, GeneratePathState, NULL, NULL, false, "Next Point Calculated"}
+};
+
+static const HSM_TRANSITION_t GeneratePathTransitions[] = {
+	{PathGenerated, TurningState, NULL, NULL, false, "Path Generated"}
+};
+
+static const HSM_TRANSITION_t TurningTransitions[] = {
+	{AtNextAngle, DrivingForwardState, NULL, NULL, false, "At Next Angle"}
+};
+
+static const HSM_TRANSITION_t DrivingForwardTransitions[] = {
+	{AtNextPoint, AtPositionState, NULL, NULL, false, "At Next Point"}
+};
+
+static const HSM_TRANSITION_t FollowingPathTransitions[] = {
+	// Go back to stop-turn-drive
+	{AtNextPoint, AtPositionState, NULL, NULL, false, "Stopped Following Path"}
+};
+
+// Indexed by DrivingState
+static const HSM_STATE_t DrivingStates[] = {
+	[AtPositionState] =      {"AtPosition", EntryAtPositionState, ExitAtPositionState,
+	                          NULL, HSM_TRANSITIONS(AtPositionTransitions)},
+	[GeneratePathState] =    {"GeneratePath", EntryGeneratePathState, ExitGeneratePathState,
+	                          NULL, HSM_TRANSITIONS(GeneratePathTransitions)},
+	[TurningState] =         {"Turning", EntryTurningState, ExitTurningState,
+	                          NULL, HSM_TRANSITIONS(TurningTransitions)},
+	[DrivingForwardState] =  {"DrivingForward", EntryDrivingForwardState, ExitDrivingForwardState,
+	                          NULL, HSM_TRANSITIONS(DrivingForwardTransitions)},
+	[FollowingPathState] =   {"FollowingPath", EntryFollowingPathState, ExitFollowingPathState,
+	                          DuringFollowingPathState, HSM_TRANSITIONS(FollowingPathTransitions)}
+};
+
+static uint8_t DrivingLookup[HSM_LOOKUP_SIZE(sizeof(DrivingStates)/sizeof(DrivingStates[0]))];
+static HSM_t DrivingHSM = HSM_MACHINE(DrivingStates, DrivingLookup);
+/*------------------------- hsm_gen: end tables --------------------------*/
+
 /*------------------------------ Module Code ------------------------------*/
 
+/*-------------------------- hsm_gen: functions ---------------------------*/
+
 /****************************************************************************
  Function
-   StartDriving
+     StartDriving
 
  Parameters
-   Event_t CurrentEvent
+     ES_Event CurrentEvent, ES_ENTRY or ES_ENTRY_HISTORY
 
  Returns
-   None
+     None
 
  Description
-   Starts in at position state
+     Starts in AtPositionState, or the last state on ES_ENTRY_HISTORY
 ****************************************************************************/
 void StartDriving ( ES_Event CurrentEvent )
 {
-	CurrentState = AtPositionState;
-
-	 // Call the entry function (if any) for the ENTRY_STATE
-	 RunDriving(CurrentEvent);
+	UpdateCurrentPoint(&CurrentEvent);
+	HSM_Start(&DrivingHSM, AtPositionState, &CurrentEvent);
 }
 
 /****************************************************************************
  Function
-   RunDriving
+    RunDriving
 
  Parameters
-   unsigned char: the event to process
+   ES_Event : the event to process
 
  Returns
-   unsigned char: an event to return
+   ES_Event, the event passed in
 
  Description
-   implements driving state machine using DRS data
+   Runs the Driving state machine
 ****************************************************************************/
 ES_Event RunDriving( ES_Event CurrentEvent )
 {
-   bool MakeTransition = false;/* are we making a state transition? */
-   DrivingState NextState = CurrentState;
-   ES_Event ReturnEvent = CurrentEvent; // assume we are not consuming event
-	 
-	 // Calculate current point
-		myKart = QueryMyKart( );
-		currentPoint.X = myKart.KartX;
-		currentPoint.Y = myKart.KartY;
-
-	switch ( CurrentState )
-	{
-		case AtPositionState :
-			// Execute during function
-			CurrentEvent = DuringAtPositionState(CurrentEvent);
-			// Process events
-			if ( CurrentEvent.EventType != ES_NO_EVENT )        //If an event is active
-			{
-				switch (CurrentEvent.EventType)
-				{
-					case NextPointCalculated: //If event is event one
-						printf("Next Point Calculated \r\n");
-						NextState = GeneratePathState;//Decide what the next state will be
-						MakeTransition = true; //mark that we are taking a transition
-						break;							 
-				}
-			}
-			break;
-		case GeneratePathState :
-			// Execute during function
-			CurrentEvent = DuringGeneratePathState(CurrentEvent);
-			// Process events
-			if ( CurrentEvent.EventType != ES_NO_EVENT )        //If an event is active
-			{
-				switch (CurrentEvent.EventType)
-				{
-					case PathGenerated:
-						printf("Path Generated \r\n");
-						// Move within the driving SM
-						NextState = TurningState;
-						MakeTransition = true;
-						break;
-				}
-			}
-			break;
-		case TurningState :
-			// Execute during function
-			CurrentEvent = DuringTurningState(CurrentEvent);
-			// Process events
-			if ( CurrentEvent.EventType != ES_NO_EVENT )        //If an event is active
-			{
-				switch (CurrentEvent.EventType)
-				{
-					case AtNextAngle:
-						printf("At Next Angle \r\n");
-						// Move within the driving SM
-						NextState = DrivingForwardState;
-						MakeTransition = true;
-						break;
-				}
-			}
-			break;
-		case DrivingForwardState :
-			// Execute during function
-			CurrentEvent = DuringDrivingForwardState(CurrentEvent);
-			// Process events
-			if ( CurrentEvent.EventType != ES_NO_EVENT )        //If an event is active
-			{
-				switch (CurrentEvent.EventType)
-				{
-					case AtNextPoint:
-						printf("At Next Point \r\n");
-
-						// Move within the driving SM
-						NextState = AtPositionState;
-						MakeTransition = true;
-						break;
-				}
-			}
-			break;
-  }
-	//   If we are making a state transition
-	if (MakeTransition == true)
-	{
-		 //   Execute exit function for current state
-		 CurrentEvent.EventType = ES_EXIT;
-		 RunDriving(CurrentEvent);
-
-		 CurrentState = NextState; //Modify state variable
-
-		 //   Execute entry function for new state
-		 CurrentEvent.EventType = ES_ENTRY;
-		 RunDriving(CurrentEvent);
-	 }
-	 return(ReturnEvent);
+	ES_Event ReturnEvent = CurrentEvent; // assume we are not consuming event
+	UpdateCurrentPoint(&CurrentEvent);
+	HSM_Run(&DrivingHSM, &CurrentEvent);
+	return(ReturnEvent);
 }
 
 /****************************************************************************
@@ -188,103 +159,133 @@ ES_Event RunDriving( ES_Event CurrentEvent )
      None
 
  Returns
-     unsigned char The current state of the Template state machine
-
- Description
-     returns the current state of the driving state machine
+     DrivingState the current state
 ****************************************************************************/
 DrivingState QueryDriving ( void )
 {
-	return(CurrentState);
+	return((DrivingState)HSM_Query(&DrivingHSM));
 }
 
+/*------------------------ hsm_gen: end functions -------------------------*/
+
 /***************************************************************************
  private functions
  ***************************************************************************/
 
-// During funciton for AtPositionState
-static ES_Event DuringAtPositionState( ES_Event Event )
+// Entry funciton for AtPositionState
+static void EntryAtPositionState( const ES_Event *Event )
 {
-	// process ES_ENTRY & ES_EXIT events
-	if ( Event.EventType == ES_ENTRY  ) {
-		printf("Entered At Position State \r\n");	
-		printf("%d %d %d \n\r", myKart.KartX, myKart.KartY, myKart.KartTheta);
-		
-		// Find next point based on current point and game state
-		printf("Find Next Point\r\n");
-		nextPoint = FindNextPoint(currentPoint);
-		// Post calculation event
-		ES_Event newEvent = {NextPointCalculated, 0};
-		PostMaster(newEvent);
-	}
-	else if ( Event.EventType == ES_EXIT) {
-		printf("Exited At Position State \r\n");
-		// No exit functionality 
-	}
-	else {
-		// No during functionallity	
-	}
-	return( Event );  // Don't remap event
+	printf("Entered At Position State \r\n");	
+	printf("%d %d %d \n\r", myKart.KartX, myKart.KartY, myKart.KartTheta);
+	
+	// Find next point based on current point and game state
+	printf("Find Next Point\r\n");
+	nextPoint = FindNextPoint(currentPoint);
+	// Post calculation event
+	ES_Event newEvent = {NextPointCalculated, 0};
+	PostMaster(newEvent);
 }
 
-// During funciton for GeneratePathState
-static ES_Event DuringGeneratePathState( ES_Event Event )
+// Exit funciton for AtPositionState
+static void ExitAtPositionState( const ES_Event *Event )
 {
-	// process ES_ENTRY & ES_EXIT events
-	if ( Event.EventType == ES_ENTRY  ) {
-		printf("Entered Generate Path State \r\n");
-		// Call calulate funciton with current point
-		Calculate( nextPoint.X, nextPoint.Y );
-	}
-	else if ( Event.EventType == ES_EXIT) {
-		printf("Exited Generate Path State \r\n");
-		// No exit functionality 
-	}
-	else {
-		// No during functionality
-	}
-	return( Event );  // Don't remap event
+	printf("Exited At Position State \r\n");
 }
 
-// During funciton for TurningState
-static ES_Event DuringTurningState( ES_Event Event)
+// Entry funciton for GeneratePathState
+static void EntryGeneratePathState( const ES_Event *Event )
 {
-	// process ES_ENTRY & ES_EXIT events
-	if ( Event.EventType == ES_ENTRY  ) {
-		printf("Entered Turning State \r\n");
-			 
-		// Turn to next point	
-		printf("Turn To Next Point \r\n");
-		TurnTheta( );
-	}
-	else if ( Event.EventType == ES_EXIT) {
-		printf("Exited Turning State \r\n");
-		// No exit functionality 
-	}
-	else {
-		// No during functionality
+	printf("Entered Generate Path State \r\n");
+	// Call calulate funciton with current point
+	Calculate( nextPoint.X, nextPoint.Y );
+}
+
+// Exit funciton for GeneratePathState
+static void ExitGeneratePathState( const ES_Event *Event )
+{
+	printf("Exited Generate Path State \r\n");
+}
+
+// Entry funciton for TurningState
+static void EntryTurningState( const ES_Event *Event )
+{
+	printf("Entered Turning State \r\n");
+	// Turn to next point	
+	printf("Turn To Next Point \r\n");
+	TurnTheta( );
+}
+
+// Exit funciton for TurningState
+static void ExitTurningState( const ES_Event *Event )
+{
+	printf("Exited Turning State \r\n");
+}
+
+// Entry funciton for DrivingForwardState
+static void EntryDrivingForwardState( const ES_Event *Event )
+{
+	printf("Entered Driving Forward State \r\n");
+	printf("Drive Forward \r\n");
+	// Drive to next point
+	DriveForward( );
+}
+
+// Exit funciton for DrivingForwardState
+static void ExitDrivingForwardState( const ES_Event *Event )
+{
+	printf("Exited Moving State \r\n");
+}
+
+// Entry funciton for FollowingPathState
+static void EntryFollowingPathState( const ES_Event *Event )
+{
+	printf("Entered Following Path State \r\n");
+	// Start steering along the path
+	StartPathFollower( );
+}
+
+// Exit funciton for FollowingPathState
+static void ExitFollowingPathState( const ES_Event *Event )
+{
+	printf("Exited Following Path State \r\n");
+	// Stop the follower
+	StopPathFollower( );
+}
+
+// During funciton for FollowingPathState
+static void DuringFollowingPathState( ES_Event *Event )
+{
+	if ( Event->EventType == ES_TIMEOUT && Event->EventParam == CONTROL_TIMER ) {
+		// Send new wheel speeds every control tick
+		UpdatePathFollower( );
 	}
-	return( Event );  // Don't remap event
 }
 
-// During funciton for DrivingForwardState
-static ES_Event DuringDrivingForwardState( ES_Event Event)
+// Guard for following the path through the next point
+static bool CanFollowPath( const ES_Event *Event )
+{
+	return PathFollowable(ShotPending(), ObstaclePending());
+}
+
+// Calculate current point from each DRS update, asking the DRS when we
+// start since there may not have been one since we were last running
+static void UpdateCurrentPoint( const ES_Event *Event )
 {
-	// process ES_ENTRY & ES_EXIT events
-	if ( Event.EventType == ES_ENTRY  ) {
-		printf("Entered Driving Forward State \r\n");
-		printf("Drive Forward \r\n");
-		// Drive to next point
-		DriveForward( );
+	if ( Event->EventType == KartUpdated ) {
+		const KART_t *kart = ES_EventPool_Get(Event->EventParam);
+		if ( kart == NULL ) {
+			return;
+		}
+		myKart = *kart;
 	}
-	else if ( Event.EventType == ES_EXIT) {
-		printf("Exited Moving State \r\n");
-		// No exit functionality 
+	else if ( Event->EventType == ES_ENTRY || Event->EventType == ES_ENTRY_HISTORY ) {
+		myKart = QueryMyKart( );
 	}
 	else {
-		// No during functionality
+		return;
 	}
-	return( Event );  // Don't remap event
+	currentPoint.X = myKart.KartX;
+	currentPoint.Y = myKart.KartY;
 }
 
 // Function to find the next waypoint
@@ -298,7 +299,7 @@ static POINT_t FindNextPoint( POINT_t current ) {
 	{
 		// First check obstacle and shooting decision zones
 		case ShootingDecisionZone:
-		if(!myKart.ShotComplete && notShot) {
+		if(ShotPending()) {
 			printf("Move to Shooting SM\r\n");
 
 			ES_Event newEvent = {ToShooting, 0};
@@ -315,7 +316,7 @@ static POINT_t FindNextPoint( POINT_t current ) {
 				return returnPoint;
 			}
 		 case ObstacleDecisionZone:
-			if(!myKart.ShotComplete && notObs) {
+			if(ObstaclePending()) {
 				printf("Move to Obstacle SM\r\n");
 				
 				ES_Event newEvent = {ToObstacle, 0};
@@ -364,4 +365,13 @@ static POINT_t FindNextPoint( POINT_t current ) {
 	}
 	return returnPoint;
 }
-	
+
+// Check if we still need to go to the shooting point this lap
+static bool ShotPending( void ) {
+	return (!myKart.ShotComplete && notShot);
+}
+
+// Check if we still need to go to the obstacle this lap
+static bool ObstaclePending( void ) {
+	return (!myKart.ObstacleComplete && notObs);
+}
@@ -6,12 +6,26 @@
      This is a module implementing  the management of event deferal and recall
       queues
  Notes
-     
+     ES_DeferEvent and ES_RecallEvents work on a plain ES_Queue and post
+     everything back at once.
+
+     The priority deferral queues (ES_InitDeferral) keep each event with a
+     priority and an optional lifetime. Events are kept highest priority
+     first and in the order they were deferred within a priority, and an
+     expired event is dropped instead of recalled. ES_RecallDeferred only
+     marks the queue, the events are posted from ES_Run once every service
+     queue is empty, at most DEFER_RECALL_BUDGET (ES_Configure.h) per pass,
+     so a recall can't overrun the queue it posts to or hold up events that
+     come in while it is going on.
+
 
  History
  When           Who     What/Why
  -------------- ---     --------
- 
+ 10/19/26 13:20 Alex     added priority deferral queues with expiry and a
+                         recall budget per pass of ES_Run
+ 10/19/26 09:40 Alex     ES_DeferEvent is a function so deferred events hold
+                         their pooled payload until recalled
  10/11/14 14:58 jec     converted RecallEvent to RecallEvents to pull all
                         deferred events off the deferral queue
  11/02/13 16:38 jec      Began Coding
@@ -23,6 +37,7 @@
 #include "ES_General.h"
 #include "ES_Events.h"
 #include "ES_DeferRecall.h"
+#include "ES_Timers.h"
 
 /*--------------------------- External Variables --------------------------*/
 
@@ -31,10 +46,39 @@
 /*------------------------------ Module Types -----------------------------*/
 
 /*---------------------------- Module Functions ---------------------------*/
+static void DropEntry( ES_DeferralQueue_t *pQueue, uint8_t Index );
+static void DropExpired( ES_DeferralQueue_t *pQueue );
 
 /*---------------------------- Module Variables ---------------------------*/
+// every queue set up with ES_InitDeferral, so ES_Run can recall from them
+static ES_DeferralQueue_t *DeferralList;
 
 /*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     ES_DeferEvent
+ Parameters
+     ES_Event * pBlock, pointer to the block of memory that implements the
+       Defer/Recall queue
+     ES_Event Event2Add, event to defer
+ Returns
+     bool true if the event fit in the queue
+ Description
+     adds the event to the deferral queue LIFO. The deferral queue holds a
+     reference to a pooled payload, so it outlives the dispatch that
+     deferred it.
+ Notes
+     None.
+****************************************************************************/
+bool ES_DeferEvent( ES_Event * pBlock, ES_Event Event2Add ){
+  ES_EventPool_HoldEvent( Event2Add );
+  if ( ES_EnQueueLIFO( pBlock, Event2Add ) ){
+    return true;
+  }
+  ES_EventPool_ReleaseEvent( Event2Add );
+  return false;
+}
+
 /****************************************************************************
  Function
      ES_RecallEvents
@@ -62,6 +106,8 @@ bool ES_RecallEvents( uint8_t WhichService, ES_Event * pBlock ){
 		ES_DeQueue( pBlock, &RecalledEvent );
 		if (RecalledEvent.EventType != ES_NO_EVENT){
 			ES_PostToServiceLIFO( WhichService, RecalledEvent);
+			// the service queue holds the payload now
+			ES_EventPool_ReleaseEvent( RecalledEvent );
 			WereEventsPulled = true;
 		}
   }while(RecalledEvent.EventType != ES_NO_EVENT);
@@ -69,6 +115,215 @@ bool ES_RecallEvents( uint8_t WhichService, ES_Event * pBlock ){
   
 }
   
+/****************************************************************************
+ Function
+     ES_DeferRecall_Init
+ Parameters
+     None
+ Returns
+     None
+ Description
+     forgets every deferral queue
+ Notes
+     called by ES_Initialize before the service init functions
+****************************************************************************/
+void ES_DeferRecall_Init( void ){
+  DeferralList = NULL;
+}
+
+/****************************************************************************
+ Function
+     ES_InitDeferral
+ Parameters
+     ES_DeferralQueue_t * pQueue, the queue to set up
+     ES_DeferredEvent_t * pEntries, array to keep the events in
+     uint8_t Size, number of entries in the array
+     pPostFunc PostFunc, post function recalled events go to
+ Returns
+     None
+ Description
+     sets up an empty deferral queue and lets ES_Run know about it. Calling
+     it again on the same queue empties it.
+****************************************************************************/
+void ES_InitDeferral( ES_DeferralQueue_t *pQueue, ES_DeferredEvent_t *pEntries,
+                      uint8_t Size, pPostFunc PostFunc ){
+  ES_DeferralQueue_t *pThisQueue;
+
+  for ( pThisQueue = DeferralList; pThisQueue != NULL; pThisQueue = pThisQueue->pNext ){
+    if ( pThisQueue == pQueue ){
+      break;
+    }
+  }
+  if ( pThisQueue == NULL ){
+    pQueue->NumEntries = 0;
+    pQueue->pNext = DeferralList;
+    DeferralList = pQueue;
+  }else{
+    ES_FlushDeferred( pQueue );
+  }
+  pQueue->pEntries = pEntries;
+  pQueue->Size = Size;
+  pQueue->PostFunc = PostFunc;
+  pQueue->Recalling = false;
+}
+
+/****************************************************************************
+ Function
+     ES_DeferEventWith
+ Parameters
+     ES_DeferralQueue_t * pQueue, queue to defer to
+     ES_Event Event2Add, event to defer
+     uint8_t Priority, higher is recalled first
+     uint16_t Lifetime, ES timer ticks until it is stale, or
+              ES_DEFER_FOREVER
+ Returns
+     bool true if the event was kept
+ Description
+     adds the event behind everything of the same or higher priority. If
+     the queue is full the newest event of the lowest priority makes room,
+     as long as it is lower priority than the new one. The queue holds a
+     reference to a pooled payload until the event is recalled or dropped.
+****************************************************************************/
+bool ES_DeferEventWith( ES_DeferralQueue_t *pQueue, ES_Event Event2Add,
+                        uint8_t Priority, uint16_t Lifetime ){
+  uint8_t Index;
+  uint8_t i;
+
+  if ( pQueue->NumEntries == pQueue->Size ){
+    DropExpired( pQueue );
+  }
+  if ( pQueue->NumEntries == pQueue->Size ){
+    if ( (pQueue->Size == 0) ||
+         (pQueue->pEntries[pQueue->Size - 1].Priority >= Priority) ){
+      return false;
+    }
+    DropEntry( pQueue, pQueue->Size - 1 );
+  }
+
+  for ( Index = pQueue->NumEntries; Index > 0; Index-- ){
+    if ( pQueue->pEntries[Index - 1].Priority >= Priority ){
+      break;
+    }
+  }
+  for ( i = pQueue->NumEntries; i > Index; i-- ){
+    pQueue->pEntries[i] = pQueue->pEntries[i - 1];
+  }
+  ES_EventPool_HoldEvent( Event2Add );
+  pQueue->pEntries[Index].Event = Event2Add;
+  pQueue->pEntries[Index].Priority = Priority;
+  pQueue->pEntries[Index].CanExpire = ( Lifetime != ES_DEFER_FOREVER );
+  pQueue->pEntries[Index].Expires = ES_Timer_GetTime() + Lifetime;
+  pQueue->NumEntries++;
+  return true;
+}
+
+/****************************************************************************
+ Function
+     ES_RecallDeferred
+ Parameters
+     ES_DeferralQueue_t * pQueue, queue to recall
+ Returns
+     None
+ Description
+     starts posting the queue's events back, in order, from ES_Run. Events
+     deferred while the recall is going on are recalled with the rest.
+****************************************************************************/
+void ES_RecallDeferred( ES_DeferralQueue_t *pQueue ){
+  pQueue->Recalling = ( pQueue->NumEntries != 0 );
+}
+
+/****************************************************************************
+ Function
+     ES_FlushDeferred
+ Parameters
+     ES_DeferralQueue_t * pQueue, queue to empty
+ Returns
+     None
+ Description
+     drops every event in the queue and stops any recall
+****************************************************************************/
+void ES_FlushDeferred( ES_DeferralQueue_t *pQueue ){
+  while ( pQueue->NumEntries > 0 ){
+    DropEntry( pQueue, pQueue->NumEntries - 1 );
+  }
+  pQueue->Recalling = false;
+}
+
+/****************************************************************************
+ Function
+     ES_QueryDeferred
+ Parameters
+     ES_DeferralQueue_t * pQueue
+ Returns
+     uint8_t number of events waiting in the queue
+****************************************************************************/
+uint8_t ES_QueryDeferred( ES_DeferralQueue_t *pQueue ){
+  return pQueue->NumEntries;
+}
+
+/****************************************************************************
+ Function
+     ES_DeferRecall_Run
+ Parameters
+     None
+ Returns
+     None
+ Description
+     posts up to DEFER_RECALL_BUDGET events from the queues being recalled
+ Notes
+     called by ES_Run when all of the service queues are empty. A post
+     that fails leaves the event at the head of its queue for next time.
+****************************************************************************/
+void ES_DeferRecall_Run( void ){
+  ES_DeferralQueue_t *pQueue;
+  uint8_t Budget = DEFER_RECALL_BUDGET;
+
+  for ( pQueue = DeferralList; (pQueue != NULL) && (Budget > 0); pQueue = pQueue->pNext ){
+    if ( !pQueue->Recalling ){
+      continue;
+    }
+    DropExpired( pQueue );
+    while ( (pQueue->NumEntries > 0) && (Budget > 0) ){
+      if ( pQueue->PostFunc( pQueue->pEntries[0].Event ) != true ){
+        break;
+      }
+      Budget--;
+      // the service queue holds the payload now
+      DropEntry( pQueue, 0 );
+    }
+    if ( pQueue->NumEntries == 0 ){
+      pQueue->Recalling = false;
+    }
+  }
+}
+
+//*********************************
+// private functions
+//*********************************
+// Takes an entry out of a deferral queue and drops its payload
+static void DropEntry( ES_DeferralQueue_t *pQueue, uint8_t Index ){
+  ES_EventPool_ReleaseEvent( pQueue->pEntries[Index].Event );
+  pQueue->NumEntries--;
+  for ( ; Index < pQueue->NumEntries; Index++ ){
+    pQueue->pEntries[Index] = pQueue->pEntries[Index + 1];
+  }
+}
+
+// Drops every entry whose lifetime has run out
+static void DropExpired( ES_DeferralQueue_t *pQueue ){
+  uint16_t Now = ES_Timer_GetTime();
+  uint8_t i = 0;
+
+  while ( i < pQueue->NumEntries ){
+    if ( pQueue->pEntries[i].CanExpire &&
+         ((int16_t)(Now - pQueue->pEntries[i].Expires) >= 0) ){
+      DropEntry( pQueue, i );
+    }else{
+      i++;
+    }
+  }
+}
+
 /*------------------------------- Footnotes -------------------------------*/
 
 
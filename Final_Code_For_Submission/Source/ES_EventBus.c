@@ -0,0 +1,235 @@
+/****************************************************************************
+ Module
+     ES_EventBus.c
+ Description
+     Publish/subscribe event bus. Services subscribe to the event types
+     they want, usually from their init function, and a sensor or checker
+     publishes an event without knowing who runs it. Each event type has a
+     bitmap of subscribed services, so working out where an event goes is
+     one table read no matter how many services there are.
+ Notes
+     A subscription can be filtered on EventParam. The service then only
+     gets the event when (EventParam & ParamMask) == ParamValue, e.g. one
+     beacon band out of DetectedBeacon. Filtered subscriptions are kept in
+     a table of EVENT_BUS_FILTERS entries (ES_Configure.h) that is only
+     searched for event types that have a filter on them.
+
+     Publish posts with ES_PostToService, so each subscriber's queue holds
+     its own reference to a pooled payload. The publisher releases its
+     reference after publishing, as it would after a post.
+
+     Subscriptions are meant to be set up before ES_Run. Changing them
+     later is safe as long as it is not done from an interrupt.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/19/26 11:15 Alex     started coding, replaces the distribution lists
+                         of ES_PostList.c
+*****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "ES_LookupTables.h"
+#include "ES_EventBus.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+typedef struct {
+    ES_EventTyp_t EventType;
+    uint8_t Service;
+    uint16_t ParamMask;
+    uint16_t ParamValue;
+}ES_BusFilter_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+static bool ValidSubscription( uint8_t WhichService, ES_EventTyp_t EventType );
+
+/*---------------------------- Module Variables ---------------------------*/
+// one bit per service, set if it gets every event of the type
+static uint16_t Subscribers[NUM_ES_EVENTS];
+// one bit per service, set if it has a filtered subscription to the type
+static uint16_t Filtered[NUM_ES_EVENTS];
+
+static ES_BusFilter_t Filters[EVENT_BUS_FILTERS];
+static uint8_t NumFilters;
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+   ES_EventBus_Init
+ Parameters
+   None
+ Returns
+   None
+ Description
+   Clears every subscription
+ Notes
+   called by ES_Initialize before the service init functions
+****************************************************************************/
+void ES_EventBus_Init( void )
+{
+  uint16_t i;
+  for ( i = 0; i < NUM_ES_EVENTS; i++ ){
+    Subscribers[i] = 0;
+    Filtered[i] = 0;
+  }
+  NumFilters = 0;
+}
+
+/****************************************************************************
+ Function
+   ES_EventBus_Subscribe
+ Parameters
+   uint8_t WhichService : priority of the service, as passed to its init
+   ES_EventTyp_t EventType : type it wants to be posted
+ Returns
+   bool : false if the service or event type is out of range
+ Description
+   The service gets every published event of this type. This replaces
+   any filtered subscription it had to the type.
+****************************************************************************/
+bool ES_EventBus_Subscribe( uint8_t WhichService, ES_EventTyp_t EventType )
+{
+  if ( !ValidSubscription( WhichService, EventType ) ){
+    return false;
+  }
+  ES_EventBus_Unsubscribe( WhichService, EventType );
+  Subscribers[EventType] |= BitNum2SetMask[WhichService];
+  return true;
+}
+
+/****************************************************************************
+ Function
+   ES_EventBus_SubscribeFiltered
+ Parameters
+   uint8_t WhichService : priority of the service, as passed to its init
+   ES_EventTyp_t EventType : type it wants to be posted
+   uint16_t ParamMask : bits of EventParam to check
+   uint16_t ParamValue : what they have to be
+ Returns
+   bool : false if out of range or the filter table is full
+ Description
+   The service gets published events of this type whose EventParam
+   matches. Several filters on the same type are or'ed together.
+****************************************************************************/
+bool ES_EventBus_SubscribeFiltered( uint8_t WhichService, ES_EventTyp_t EventType,
+                                    uint16_t ParamMask, uint16_t ParamValue )
+{
+  if ( !ValidSubscription( WhichService, EventType ) ||
+       (NumFilters >= EVENT_BUS_FILTERS) ){
+    return false;
+  }
+  // a filter on top of an unfiltered subscription would change nothing
+  if ( (Subscribers[EventType] & BitNum2SetMask[WhichService]) != 0 ){
+    return true;
+  }
+  Filters[NumFilters].EventType = EventType;
+  Filters[NumFilters].Service = WhichService;
+  Filters[NumFilters].ParamMask = ParamMask;
+  Filters[NumFilters].ParamValue = ParamValue & ParamMask;
+  NumFilters++;
+  Filtered[EventType] |= BitNum2SetMask[WhichService];
+  return true;
+}
+
+/****************************************************************************
+ Function
+   ES_EventBus_Unsubscribe
+ Parameters
+   uint8_t WhichService : priority of the service
+   ES_EventTyp_t EventType : type it no longer wants
+ Returns
+   None
+ Description
+   Removes the service's subscription and any filters it had on the type
+****************************************************************************/
+void ES_EventBus_Unsubscribe( uint8_t WhichService, ES_EventTyp_t EventType )
+{
+  uint8_t i;
+  if ( !ValidSubscription( WhichService, EventType ) ){
+    return;
+  }
+  Subscribers[EventType] &= BitNum2ClrMask[WhichService];
+  if ( (Filtered[EventType] & BitNum2SetMask[WhichService]) == 0 ){
+    return;
+  }
+  Filtered[EventType] &= BitNum2ClrMask[WhichService];
+  // close up the table over the service's filters on this type
+  i = 0;
+  while ( i < NumFilters ){
+    if ( (Filters[i].EventType == EventType) &&
+         (Filters[i].Service == WhichService) ){
+      NumFilters--;
+      Filters[i] = Filters[NumFilters];
+    }else{
+      i++;
+    }
+  }
+}
+
+/****************************************************************************
+ Function
+   ES_EventBus_QuerySubscribers
+ Parameters
+   ES_Event ThisEvent : event that would be published
+ Returns
+   uint16_t : one bit per service that would be posted the event
+****************************************************************************/
+uint16_t ES_EventBus_QuerySubscribers( ES_Event ThisEvent )
+{
+  uint16_t Services;
+  uint8_t i;
+
+  if ( ThisEvent.EventType >= NUM_ES_EVENTS ){
+    return 0;
+  }
+  Services = Subscribers[ThisEvent.EventType];
+  if ( Filtered[ThisEvent.EventType] != 0 ){
+    for ( i = 0; i < NumFilters; i++ ){
+      if ( (Filters[i].EventType == ThisEvent.EventType) &&
+           ((ThisEvent.EventParam & Filters[i].ParamMask) == Filters[i].ParamValue) ){
+        Services |= BitNum2SetMask[Filters[i].Service];
+      }
+    }
+  }
+  return Services;
+}
+
+/****************************************************************************
+ Function
+   ES_EventBus_Publish
+ Parameters
+   ES_Event ThisEvent : event to post to its subscribers
+ Returns
+   bool : false if any of the posts failed
+ Description
+   Posts the event to every subscribed service, highest priority first
+ Notes
+   An event with no subscribers is dropped and is not a failure
+****************************************************************************/
+bool ES_EventBus_Publish( ES_Event ThisEvent )
+{
+  uint16_t Services = ES_EventBus_QuerySubscribers( ThisEvent );
+  bool ReturnVal = true;
+  uint8_t WhichService;
+
+  while ( Services != 0 ){
+    WhichService = ES_GetMSBitSet( Services );
+    Services &= BitNum2ClrMask[WhichService];
+    if ( ES_PostToService( WhichService, ThisEvent ) != true ){
+      ReturnVal = false;
+    }
+  }
+  return ReturnVal;
+}
+
+//*********************************
+// private functions
+//*********************************
+// True if the service exists and the type is a real event
+static bool ValidSubscription( uint8_t WhichService, ES_EventTyp_t EventType )
+{
+  return ( (WhichService < NUM_SERVICES) && (EventType < NUM_ES_EVENTS) );
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -0,0 +1,262 @@
+/****************************************************************************
+ Module
+     ES_EventPool.c
+ Description
+     Fixed block pool for event payloads too big for EventParam. The
+     payload is allocated from the pool and the event carries a handle to
+     it in EventParam. Every queue an event is posted to holds a reference
+     to the payload and ES_Run drops it once the event has been dispatched,
+     so the block is freed after the last consumer, whether the event went
+     to one service or a whole distribution list.
+ Notes
+     Event types listed in POOLED_EVENTS (ES_Configure.h) always carry a
+     handle. A posting function allocates the block (holding one reference),
+     fills it in, posts the event and then releases its own reference:
+
+        KART_t *pKart;
+        uint16_t Handle = ES_EventPool_Alloc( sizeof(KART_t), (void **)&pKart );
+        if ( Handle != ES_NO_PAYLOAD ){
+          *pKart = MyKart;
+          ThisEvent.EventType = KartUpdated;
+          ThisEvent.EventParam = Handle;
+          PostMaster( ThisEvent );
+          ES_EventPool_Release( Handle );
+        }
+
+     A payload is only good while its event is being run. Copy it, or call
+     ES_EventPool_HoldEvent and release it later, to keep it longer.
+
+     The handle holds the block index in the low byte and a generation
+     count in the high byte, so a handle to a block that has been freed and
+     re-used is rejected by ES_EventPool_Get.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/19/26 09:40 Alex     started coding
+*****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Port.h"
+#include "ES_Types.h"
+#include "ES_General.h"
+#include "ES_EventPool.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define WORDS_PER_BLOCK ((EVENT_POOL_BLOCK_SIZE + 3)/4)
+#define POOLED_WORDS ((NUM_ES_EVENTS + 31)/32)
+
+#define HANDLE_INDEX(h) (((h) & 0xFF) - 1)
+#define HANDLE_GENERATION(h) ((uint8_t)((h) >> 8))
+#define MAKE_HANDLE(i, g) ((uint16_t)(((uint16_t)(g) << 8) | ((i) + 1)))
+
+/*---------------------------- Module Functions ---------------------------*/
+static int16_t CheckHandle( uint16_t Handle );
+
+/*---------------------------- Module Variables ---------------------------*/
+// uint32_t so every payload is word aligned
+static uint32_t Blocks[EVENT_POOL_BLOCKS][WORDS_PER_BLOCK];
+static uint8_t RefCount[EVENT_POOL_BLOCKS];
+static uint8_t Generation[EVENT_POOL_BLOCKS];
+static uint8_t NumFree;
+
+// one bit per event type that carries a handle
+static ES_EventTyp_t const PooledList[] = { POOLED_EVENTS };
+static uint32_t PooledBits[POOLED_WORDS];
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+   ES_EventPool_Init
+ Parameters
+   None
+ Returns
+   None
+ Description
+   Frees every block and builds the table of pooled event types
+ Notes
+   called by ES_Initialize
+****************************************************************************/
+void ES_EventPool_Init( void )
+{
+  uint8_t i;
+  for ( i = 0; i < EVENT_POOL_BLOCKS; i++ ){
+    RefCount[i] = 0;
+  }
+  NumFree = EVENT_POOL_BLOCKS;
+  for ( i = 0; i < POOLED_WORDS; i++ ){
+    PooledBits[i] = 0;
+  }
+  for ( i = 0; i < ARRAY_SIZE(PooledList); i++ ){
+    PooledBits[PooledList[i] / 32] |= (1UL << (PooledList[i] % 32));
+  }
+}
+
+/****************************************************************************
+ Function
+   ES_EventPool_Alloc
+ Parameters
+   uint8_t Size : bytes of payload needed
+   void ** pPayload : set to the block, NULL if none was free
+ Returns
+   uint16_t handle to put in EventParam, ES_NO_PAYLOAD on failure
+ Description
+   Takes a free block, the caller holds the one reference to it
+ Notes
+   safe to call from an interrupt
+****************************************************************************/
+uint16_t ES_EventPool_Alloc( uint8_t Size, void **pPayload )
+{
+  uint16_t Handle = ES_NO_PAYLOAD;
+  uint8_t i;
+
+  *pPayload = NULL;
+  if ( Size > EVENT_POOL_BLOCK_SIZE ){
+    return ES_NO_PAYLOAD;
+  }
+  EnterCritical();
+  for ( i = 0; i < EVENT_POOL_BLOCKS; i++ ){
+    if ( RefCount[i] == 0 ){
+      RefCount[i] = 1;
+      Generation[i]++;
+      NumFree--;
+      Handle = MAKE_HANDLE(i, Generation[i]);
+      *pPayload = Blocks[i];
+      break;
+    }
+  }
+  ExitCritical();
+  return Handle;
+}
+
+/****************************************************************************
+ Function
+   ES_EventPool_Get
+ Parameters
+   uint16_t Handle : from EventParam
+ Returns
+   void * the payload, NULL if the handle is stale or bad
+****************************************************************************/
+void *ES_EventPool_Get( uint16_t Handle )
+{
+  int16_t Index = CheckHandle( Handle );
+  if ( Index < 0 ){
+    return NULL;
+  }
+  return Blocks[Index];
+}
+
+/****************************************************************************
+ Function
+   ES_EventPool_Release
+ Parameters
+   uint16_t Handle : block to drop a reference to
+ Returns
+   None
+ Description
+   Frees the block when the last reference goes
+ Notes
+   safe to call from an interrupt
+****************************************************************************/
+void ES_EventPool_Release( uint16_t Handle )
+{
+  EnterCritical();
+  int16_t Index = CheckHandle( Handle );
+  if ( Index >= 0 ){
+    RefCount[Index]--;
+    if ( RefCount[Index] == 0 ){
+      NumFree++;
+    }
+  }
+  ExitCritical();
+}
+
+/****************************************************************************
+ Function
+   ES_EventPool_IsPooled
+ Parameters
+   ES_EventTyp_t EventType
+ Returns
+   bool true if events of this type carry a payload handle
+****************************************************************************/
+bool ES_EventPool_IsPooled( ES_EventTyp_t EventType )
+{
+  if ( EventType >= NUM_ES_EVENTS ){
+    return false;
+  }
+  return ( (PooledBits[EventType / 32] & (1UL << (EventType % 32))) != 0 );
+}
+
+/****************************************************************************
+ Function
+   ES_EventPool_HoldEvent
+ Parameters
+   ES_Event ThisEvent
+ Returns
+   None
+ Description
+   Adds a reference to the event's payload if it has one
+ Notes
+   called by the framework for every queue the event goes into
+****************************************************************************/
+void ES_EventPool_HoldEvent( ES_Event ThisEvent )
+{
+  if ( !ES_EventPool_IsPooled( ThisEvent.EventType ) ){
+    return;
+  }
+  EnterCritical();
+  int16_t Index = CheckHandle( ThisEvent.EventParam );
+  if ( (Index >= 0) && (RefCount[Index] < 0xFF) ){
+    RefCount[Index]++;
+  }
+  ExitCritical();
+}
+
+/****************************************************************************
+ Function
+   ES_EventPool_ReleaseEvent
+ Parameters
+   ES_Event ThisEvent
+ Returns
+   None
+ Description
+   Drops a reference to the event's payload if it has one
+ Notes
+   called by ES_Run after the event has been dispatched
+****************************************************************************/
+void ES_EventPool_ReleaseEvent( ES_Event ThisEvent )
+{
+  if ( ES_EventPool_IsPooled( ThisEvent.EventType ) ){
+    ES_EventPool_Release( ThisEvent.EventParam );
+  }
+}
+
+/****************************************************************************
+ Function
+   ES_EventPool_QueryFree
+ Parameters
+   None
+ Returns
+   uint8_t number of free blocks
+****************************************************************************/
+uint8_t ES_EventPool_QueryFree( void )
+{
+  return NumFree;
+}
+
+//*********************************
+// private functions
+//*********************************
+// Block index for a live handle, -1 if it is stale or bad
+static int16_t CheckHandle( uint16_t Handle )
+{
+  int16_t Index = HANDLE_INDEX(Handle);
+  if ( (Index < 0) || (Index >= EVENT_POOL_BLOCKS) ||
+       (RefCount[Index] == 0) ||
+       (Generation[Index] != HANDLE_GENERATION(Handle)) ){
+    return -1;
+  }
+  return Index;
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -8,6 +8,16 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/19/26 19:20 Alex     keeps the deepest each queue has been for telemetry
+ 10/19/26 15:40 Alex     ES_Run times each dispatch for the deadline monitor
+                         and feeds the watchdog through it
+ 10/19/26 14:30 Alex     coalesced event types replace a queued event of the
+                         same type instead of taking a new entry
+ 10/19/26 13:20 Alex     ES_Run recalls from the priority deferral queues
+                         when the service queues are empty
+ 10/19/26 11:15 Alex     clear the event bus subscriptions in ES_Initialize
+ 10/19/26 09:40 Alex     queues hold a reference to pooled event payloads,
+                         released after the event is dispatched
  11/02/13 17:05 jec      added PostToServiceLIFO function
  10/21/13 17:50 jec      added entries to expand number of possible services to 
                          16
@@ -27,6 +37,7 @@
 #include "ES_Framework.h"
 #include "ES_Queue.h"
 #include "ES_LookupTables.h"
+#include "ES_DeferRecall.h"
 #include <stdio.h>
 
 // Include the header files for the Service modules.
@@ -56,6 +67,9 @@ typedef struct {
 
 /*---------------------------- Module Functions ---------------------------*/
 //static bool CheckSystemEvents( void );
+static bool EnQueueEvent( uint8_t WhichService, ES_Event TheEvent );
+static int8_t CoalesceIndex( ES_EventTyp_t EventType );
+static void UpdatePeakDepth( uint8_t WhichService );
 
 /*---------------------------- Module Variables ---------------------------*/
 /****************************************************************************/
@@ -223,6 +237,15 @@ static ES_QueueDesc_t const EventQueues[NUM_SERVICES] = {
 
 uint16_t Ready;
 
+/****************************************************************************/
+// Event types where a new post replaces one still waiting in the queue,
+// and how many posts have been merged that way for each
+static ES_EventTyp_t const CoalescedList[] = { COALESCED_EVENTS };
+static uint16_t MergeCount[ARRAY_SIZE(CoalescedList)];
+
+// Deepest each queue has been since ES_QueryQueuePeak last looked
+static uint8_t PeakDepth[NUM_SERVICES];
+
 /*------------------------------ Module Code ------------------------------*/
 /****************************************************************************
  Function
@@ -242,6 +265,16 @@ uint16_t Ready;
 ES_Return_t ES_Initialize( TimerRate_t NewRate ){
   uint8_t i;
   ES_Timer_Init( NewRate); // start up the timer subsystem
+  ES_EventPool_Init(); // free all event payloads
+  ES_EventBus_Init(); // clear subscriptions before the services make theirs
+  ES_DeferRecall_Init(); // the services set up their deferral queues
+  ES_Watchdog_Init(); // and can give the deadline monitor their state
+  for ( i=0; i< ARRAY_SIZE(MergeCount); i++) {
+    MergeCount[i] = 0;
+  }
+  for ( i=0; i< ARRAY_SIZE(PeakDepth); i++) {
+    PeakDepth[i] = 0;
+  }
   // loop through the list testing for NULL pointers and
   for ( i=0; i< ARRAY_SIZE(ServDescList); i++) {
     if ( (ServDescList[i].InitFunc == (pInitFunc)0) ||
@@ -279,6 +312,7 @@ ES_Return_t ES_Run( void ){
   uint8_t HighestPrior;
   static ES_Event ThisEvent;
   
+  ES_Watchdog_Start(); // the inits are done, start timing the loop
   while(1){ // stay here unless we detect an error condition
 
     // loop through the list executing the run functions for services
@@ -289,13 +323,21 @@ ES_Return_t ES_Run( void ){
       if ( ES_DeQueue( EventQueues[HighestPrior].pMem, &ThisEvent ) == 0 ){
         Ready &= BitNum2ClrMask[HighestPrior]; // mark queue as now empty
       }
-      if( ServDescList[HighestPrior].RunFunc(ThisEvent).EventType != 
-                                                              ES_NO_EVENT) {
+      uint16_t Started = ES_Watchdog_BeginDispatch();
+      ES_Event RunResult = ServDescList[HighestPrior].RunFunc(ThisEvent);
+      ES_Watchdog_EndDispatch( HighestPrior, ThisEvent, Started );
+      // this queue's hold on any payload ends with the dispatch
+      ES_EventPool_ReleaseEvent( ThisEvent );
+      if( RunResult.EventType != ES_NO_EVENT) {
               return FailedRun;
       }
     }
 
-    // all the queues are empty, so look for new user detected events
+    // all the queues are empty, so the loop is keeping up
+    ES_Watchdog_Idle();
+    // hand back some deferred events
+    ES_DeferRecall_Run();
+    // and look for new user detected events
     ES_CheckUserEvents();
   }
 }
@@ -319,10 +361,8 @@ bool ES_PostAll( ES_Event ThisEvent){
   uint8_t i;
   // loop through the list executing the post functions
   for ( i=0; i< ARRAY_SIZE(EventQueues); i++) {
-    if ( ES_EnQueueFIFO( EventQueues[i].pMem, ThisEvent ) != true ){
+    if ( EnQueueEvent( i, ThisEvent ) != true ){
       break; // this is a failed post
-    }else{
-      Ready |= BitNum2SetMask[i]; // show queue as non-empty
     }
   }
   if ( i == ARRAY_SIZE(EventQueues) ){ // if no failures
@@ -341,20 +381,17 @@ bool ES_PostAll( ES_Event ThisEvent){
  Returns
    boolean : False if the post function failed during execution
  Description
-   posts to one of the services' queues
+   posts to one of the services' queues. An event of a type in
+   COALESCED_EVENTS replaces one of the same type still in the queue.
  Notes
    used by the timer library to associate a timer with a state machine
  Author
    J. Edward Carryer, 01/16/12,
 ****************************************************************************/
 bool ES_PostToService( uint8_t WhichService, ES_Event TheEvent){
-  if ((WhichService < ARRAY_SIZE(EventQueues)) &&
-      (ES_EnQueueFIFO( EventQueues[WhichService].pMem, TheEvent) == 
-                                                                true )){
-    Ready |= BitNum2SetMask[WhichService]; // show queue as non-empty
-    return true;
-  } else
+  if (WhichService >= ARRAY_SIZE(EventQueues))
     return false;
+  return EnQueueEvent( WhichService, TheEvent );
 }
 
 /****************************************************************************
@@ -373,18 +410,99 @@ bool ES_PostToService( uint8_t WhichService, ES_Event TheEvent){
    J. Edward Carryer, 11/02/13
 ****************************************************************************/
 bool ES_PostToServiceLIFO( uint8_t WhichService, ES_Event TheEvent){
-  if ((WhichService < ARRAY_SIZE(EventQueues)) &&
-      (ES_EnQueueLIFO( EventQueues[WhichService].pMem, TheEvent) == 
-                                                                true )){
+  if (WhichService >= ARRAY_SIZE(EventQueues))
+    return false;
+  ES_EventPool_HoldEvent( TheEvent ); // the queue holds the payload
+  if (ES_EnQueueLIFO( EventQueues[WhichService].pMem, TheEvent) == true ){
     Ready |= BitNum2SetMask[WhichService]; // show queue as non-empty
+    UpdatePeakDepth( WhichService );
     return true;
-  } else
+  } else {
+    ES_EventPool_ReleaseEvent( TheEvent );
     return false;
+  }
+}
+
+/****************************************************************************
+ Function
+   ES_QueryMergeCount
+ Parameters
+   ES_EventTyp_t : the event type to check
+ Returns
+   uint16_t : posts of this type that were merged into a queued event since
+              ES_Initialize, 0 if the type is not coalesced
+****************************************************************************/
+uint16_t ES_QueryMergeCount( ES_EventTyp_t EventType ){
+  int8_t Index = CoalesceIndex( EventType );
+  if ( Index < 0 ){
+    return 0;
+  }
+  return MergeCount[Index];
+}
+
+/****************************************************************************
+ Function
+   ES_QueryQueuePeak
+ Parameters
+   uint8_t : the service whose queue to check
+ Returns
+   uint8_t : the most events that have been waiting in the queue since the
+             last call, which starts the count again from what is waiting now
+****************************************************************************/
+uint8_t ES_QueryQueuePeak( uint8_t WhichService ){
+  uint8_t Peak;
+  if (WhichService >= ARRAY_SIZE(EventQueues))
+    return 0;
+  Peak = PeakDepth[WhichService];
+  PeakDepth[WhichService] = ES_QueueCount( EventQueues[WhichService].pMem );
+  return Peak;
 }
 
 //*********************************
 // private functions
 //*********************************
+// Puts an event in a service's queue, the queue holds any pooled payload.
+// A coalesced type overwrites the queued event of the same type if there is
+// one, and that event's payload is dropped instead.
+static bool EnQueueEvent( uint8_t WhichService, ES_Event TheEvent ){
+  ES_Event Replaced;
+  int8_t Index = CoalesceIndex( TheEvent.EventType );
+
+  ES_EventPool_HoldEvent( TheEvent ); // the queue holds the payload
+  if ( (Index >= 0) &&
+       ES_EnQueueReplace( EventQueues[WhichService].pMem, TheEvent, &Replaced ) ){
+    ES_EventPool_ReleaseEvent( Replaced );
+    MergeCount[Index]++;
+    return true;
+  }
+  if ( ES_EnQueueFIFO( EventQueues[WhichService].pMem, TheEvent ) == true ){
+    Ready |= BitNum2SetMask[WhichService]; // show queue as non-empty
+    UpdatePeakDepth( WhichService );
+    return true;
+  }
+  ES_EventPool_ReleaseEvent( TheEvent );
+  return false;
+}
+
+// Keeps the deepest the queue has been, after an event is added
+static void UpdatePeakDepth( uint8_t WhichService ){
+  uint8_t Depth = ES_QueueCount( EventQueues[WhichService].pMem );
+  if ( Depth > PeakDepth[WhichService] ){
+    PeakDepth[WhichService] = Depth;
+  }
+}
+
+// Position of the type in CoalescedList, -1 if it isn't coalesced
+static int8_t CoalesceIndex( ES_EventTyp_t EventType ){
+  uint8_t i;
+  for ( i=0; i< ARRAY_SIZE(CoalescedList); i++) {
+    if ( CoalescedList[i] == EventType ){
+      return i;
+    }
+  }
+  return -1;
+}
+
 #if 0
 /****************************************************************************
  Function
@@ -15,6 +15,7 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/19/26 15:40 Alex    added the hardware watchdog for the deadline monitor
  08/13/13 12:42 jec     moved the hardware specific aspects of the timer here
  08/06/13 13:17 jec     Began moving the stuff from the V2 framework files
  03/05/14 13:20	joa		Began port for TM4C123G
@@ -30,6 +31,7 @@
 #include "driverlib/pin_map.h"	// Define PART_TM4C123GH6PM in project
 #include "driverlib/systick.h"
 #include "driverlib/gpio.h"
+#include "driverlib/watchdog.h"
 #include "utils/uartstdio.h"
 #include "ES_Port.h"
 #include "ES_Types.h"
@@ -194,6 +196,51 @@ void ConsoleInit(void)
 
 }
 
+/****************************************************************************
+ Function
+     _HW_Watchdog_Init
+ Parameters
+     uint16_t TimeoutMS, how long without a feed before the board resets
+ Returns
+     none.
+ Description
+     Starts watchdog 0 with reset enabled
+ Notes
+     The watchdog interrupts at the first timeout and resets at the second,
+     so it is loaded with half the time. It stops while the debugger has
+     the processor halted.
+ ****************************************************************************/
+void _HW_Watchdog_Init(uint16_t TimeoutMS)
+{
+	SysCtlPeripheralEnable(SYSCTL_PERIPH_WDOG0);
+	while(!SysCtlPeripheralReady(SYSCTL_PERIPH_WDOG0))
+		;
+	WatchdogUnlock(WATCHDOG0_BASE);
+	WatchdogReloadSet(WATCHDOG0_BASE, (CLK_FREQ/1000)*(TimeoutMS/2));
+	WatchdogStallEnable(WATCHDOG0_BASE);
+	WatchdogResetEnable(WATCHDOG0_BASE);
+	WatchdogEnable(WATCHDOG0_BASE);
+	WatchdogLock(WATCHDOG0_BASE);
+}
+
+/****************************************************************************
+ Function
+     _HW_Watchdog_Feed
+ Parameters
+     none
+ Returns
+     none.
+ Description
+     Restarts the watchdog count from its reload value
+ ****************************************************************************/
+void _HW_Watchdog_Feed(void)
+{
+	WatchdogUnlock(WATCHDOG0_BASE);
+	WatchdogIntClear(WATCHDOG0_BASE);
+	WatchdogReloadSet(WATCHDOG0_BASE, WatchdogReloadGet(WATCHDOG0_BASE));
+	WatchdogLock(WATCHDOG0_BASE);
+}
+
 
 
 #if defined(ccs)
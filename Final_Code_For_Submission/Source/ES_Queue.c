@@ -9,6 +9,8 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/19/26 19:20 Alex     added ES_QueueCount for the queue depth telemetry
+ 10/19/26 14:30 Alex     added ES_EnQueueReplace for coalesced events
  01/15/12 09:34 jec      converted to use the new C99 types from types.h
  08/09/11 18:16 jec      started coding
 *****************************************************************************/
@@ -142,6 +144,48 @@ bool ES_EnQueueLIFO( ES_Event * pBlock, ES_Event Event2Add )
       return(false);
 }
 
+/****************************************************************************
+ Function
+   ES_EnQueueReplace
+ Parameters
+   ES_Event * pBlock : pointer to the block of memory in use as the Queue
+   ES_Event Event2Add : event to put in the place of one of the same type
+   ES_Event * pReplaced : used to return the event that was overwritten
+ Returns
+   bool : true if an event of the same type was replaced, false if there
+          was none in the Queue and nothing was changed
+ Description
+   overwrites the newest queued event of the same type as Event2Add, so
+   it keeps that event's place in the Queue and takes no new entry
+ Notes
+   the search and the overwrite are one critical region so the event
+   can't be pulled off the Queue in between
+****************************************************************************/
+bool ES_EnQueueReplace( ES_Event * pBlock, ES_Event Event2Add, ES_Event * pReplaced )
+{
+   pQueue_t pThisQueue;
+   uint8_t Entry;
+   uint8_t Index;
+   bool Replaced = false;
+
+   pThisQueue = (pQueue_t)pBlock;
+   EnterCritical();   // save interrupt state, turn ints off
+   // work back from the newest entry
+   for ( Entry = pThisQueue->NumEntries; Entry > 0; Entry-- )
+   {
+      Index = 1 + ((pThisQueue->CurrentIndex + Entry - 1) % pThisQueue->QueueSize);
+      if ( pBlock[Index].EventType == Event2Add.EventType )
+      {
+         *pReplaced = pBlock[Index];
+         pBlock[Index] = Event2Add;
+         Replaced = true;
+         break;
+      }
+   }
+   ExitCritical();  // restore saved interrupt state
+   return Replaced;
+}
+
 
 /****************************************************************************
  Function
@@ -207,6 +251,19 @@ bool ES_IsQueueEmpty( ES_Event * pBlock )
    return(pThisQueue->NumEntries == 0);
 }
 
+/****************************************************************************
+ Function
+   ES_QueueCount
+ Parameters
+   ES_Event * pBlock : pointer to the block of memory in use as the Queue
+ Returns
+   uint8_t : number of entries in the queue
+****************************************************************************/
+uint8_t ES_QueueCount( ES_Event * pBlock )
+{
+   return(((pQueue_t)pBlock)->NumEntries);
+}
+
 #if 0
 /****************************************************************************
  Function
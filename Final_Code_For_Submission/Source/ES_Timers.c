@@ -46,7 +46,7 @@
 #include "ES_ServiceHeaders.h"
 #include "ES_General.h"
 #include "ES_Events.h"
-#include "ES_PostList.h"
+#include "ES_EventBus.h"
 #include "ES_LookupTables.h"
 #include "ES_Timers.h"
 #include "ES_Port.h"
@@ -89,6 +89,8 @@ static Timer_t TMR_TimerArray[sizeof(Tflag_t)*BITS_PER_BYTE]=
                                               0x0 };
 
 static Tflag_t TMR_ActiveFlags;
+// timers that were running when their group was frozen
+static Tflag_t TMR_FrozenFlags;
 
 static pPostFunc const Timer2PostFunc[sizeof(Tflag_t)*BITS_PER_BYTE] = 
                                             { TIMER0_RESP_FUNC,
@@ -183,6 +185,7 @@ ES_TimerReturn_t ES_Timer_StartTimer(uint8_t Num)
        /* tried to set a timer with no time on it */
        (TMR_TimerArray[Num] == 0) )
       return ES_Timer_ERR;  
+   TMR_FrozenFlags &= BitNum2ClrMask[Num]; /* no longer waiting on a thaw */
    TMR_ActiveFlags |= BitNum2SetMask[Num]; /* set timer as active */
    return ES_Timer_OK;
 }
@@ -206,6 +209,7 @@ ES_TimerReturn_t ES_Timer_StopTimer(uint8_t Num)
 {
    if( Num >= ARRAY_SIZE(TMR_TimerArray) )
       return ES_Timer_ERR;  /* tried to set a timer that doesn't exist */
+   TMR_FrozenFlags &= BitNum2ClrMask[Num]; /* don't restart it on a thaw */
    TMR_ActiveFlags &= BitNum2ClrMask[Num]; /* set timer as inactive */
    return ES_Timer_OK;
 }
@@ -236,11 +240,89 @@ ES_TimerReturn_t ES_Timer_InitTimer(uint8_t Num, uint16_t NewTime)
        (NewTime == 0) )
       return ES_Timer_ERR;  
    TMR_TimerArray[Num] = NewTime;
+   TMR_FrozenFlags &= BitNum2ClrMask[Num]; /* no longer waiting on a thaw */
    TMR_ActiveFlags |= BitNum2SetMask[Num]; /* set timer as active */
    return ES_Timer_OK;
 }
 
 
+/****************************************************************************
+ Function
+     ES_Timer_FreezeGroup
+
+ Parameters
+     uint16_t Group, mask with a bit set for each timer to freeze
+
+ Returns
+     None.
+
+ Description
+     Stops every running timer in the group and remembers which ones were
+     running. The remaining ticks stay in TMR_TimerArray so ES_Timer_ThawGroup
+     picks up exactly where they left off.
+
+ Notes
+     Done in one critical section so a timer can't time out part way
+     through. Starting, stopping or re-initializing a frozen timer takes it
+     out of the frozen set.
+****************************************************************************/
+void ES_Timer_FreezeGroup(uint16_t Group)
+{
+   EnterCritical();
+   TMR_FrozenFlags |= (TMR_ActiveFlags & Group);
+   TMR_ActiveFlags &= ~Group;
+   ExitCritical();
+}
+
+/****************************************************************************
+ Function
+     ES_Timer_ThawGroup
+
+ Parameters
+     uint16_t Group, mask with a bit set for each timer to thaw
+
+ Returns
+     None.
+
+ Description
+     Restarts the timers in the group that were running when it was frozen
+     and forgets the frozen state for the whole group.
+
+ Notes
+     None.
+****************************************************************************/
+void ES_Timer_ThawGroup(uint16_t Group)
+{
+   EnterCritical();
+   TMR_ActiveFlags |= (TMR_FrozenFlags & Group);
+   TMR_FrozenFlags &= ~Group;
+   ExitCritical();
+}
+
+/****************************************************************************
+ Function
+     ES_Timer_FlushGroup
+
+ Parameters
+     uint16_t Group, mask with a bit set for each timer to flush
+
+ Returns
+     None.
+
+ Description
+     Forgets the frozen timers in the group without restarting them, for
+     when whatever froze them is not coming back.
+
+ Notes
+     Timers in the group that are running are left alone.
+****************************************************************************/
+void ES_Timer_FlushGroup(uint16_t Group)
+{
+   EnterCritical();
+   TMR_FrozenFlags &= ~Group;
+   ExitCritical();
+}
+
 /****************************************************************************
  Function
      ES_Timer_GetTime
@@ -0,0 +1,273 @@
+/****************************************************************************
+ Module
+     ES_Watchdog.c
+ Description
+     Run to completion deadline monitor. ES_Run times every call to a
+     service's run function, and one that takes longer than
+     DISPATCH_BUDGET_MS (ES_Configure.h) is an overrun. The service, the
+     event and the state its machines were in when it returned are kept
+     for the last and the worst overrun and printed, so a long chain of
+     printfs or a busy wait shows up with what caused it.
+
+     The monitor also feeds the watchdog. It is fed after a dispatch and
+     when ES_Run goes idle, but only while the loop is healthy, that is
+     fewer than DEADLINE_STRIKES overruns in a row. A loop that hangs, or
+     keeps overrunning, stops feeding it and the board is reset
+     WATCHDOG_TIMEOUT_MS later.
+ Notes
+     Times come from the framework tick so they are good to 1 ms.
+
+     Builds for the PC define ES_HOST_PORT. There is no hardware watchdog
+     there, so a virtual one is checked each pass of ES_Run instead. When it
+     runs out it prints the same report as an overrun, with the last overrun
+     recorded, and starts again rather than resetting anything.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/19/26 15:40 Alex     started coding
+*****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "ES_Watchdog.h"
+#include <stdio.h>
+
+/*----------------------------- Module Defines ----------------------------*/
+// don't touch the watchdog more often than this
+#define WATCHDOG_FEED_MS (WATCHDOG_TIMEOUT_MS/4)
+
+/*---------------------------- Module Functions ---------------------------*/
+static void Feed( void );
+static void Report( const char *What, const ES_Overrun_t *pOverrun );
+
+/*---------------------------- Module Variables ---------------------------*/
+static ES_StateQuery_t *StateQueries[NUM_SERVICES];
+
+static ES_Overrun_t LastOverrun;
+static ES_Overrun_t WorstOverrun;
+static uint16_t NumOverruns;
+static uint8_t Strikes;
+
+static bool Running;
+static uint16_t LastFeed;
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+   ES_Watchdog_Init
+ Parameters
+   None
+ Returns
+   None
+ Description
+   Clears the overrun records and the state queries
+ Notes
+   called by ES_Initialize before the service init functions. The watchdog
+   itself isn't started until ES_Run, so slow inits can't trip it.
+****************************************************************************/
+void ES_Watchdog_Init( void )
+{
+  uint8_t i;
+  for ( i = 0; i < NUM_SERVICES; i++ ){
+    StateQueries[i] = NULL;
+  }
+  NumOverruns = 0;
+  Strikes = 0;
+  Running = false;
+}
+
+/****************************************************************************
+ Function
+   ES_Watchdog_SetStateQuery
+ Parameters
+   uint8_t WhichService : priority of the service
+   ES_StateQuery_t * QueryFunc : returns the state of its machines
+ Returns
+   None
+ Description
+   Lets an overrun record say what state the service was in
+****************************************************************************/
+void ES_Watchdog_SetStateQuery( uint8_t WhichService, ES_StateQuery_t *QueryFunc )
+{
+  if ( WhichService < NUM_SERVICES ){
+    StateQueries[WhichService] = QueryFunc;
+  }
+}
+
+/****************************************************************************
+ Function
+   ES_Watchdog_Start
+ Parameters
+   None
+ Returns
+   None
+ Description
+   Starts the watchdog counting down
+ Notes
+   called by ES_Run before it starts dispatching
+****************************************************************************/
+void ES_Watchdog_Start( void )
+{
+#ifndef ES_HOST_PORT
+  _HW_Watchdog_Init( WATCHDOG_TIMEOUT_MS );
+#endif
+  LastFeed = _HW_GetTickCount();
+  Running = true;
+}
+
+/****************************************************************************
+ Function
+   ES_Watchdog_BeginDispatch
+ Parameters
+   None
+ Returns
+   uint16_t : the time now, to pass to ES_Watchdog_EndDispatch
+****************************************************************************/
+uint16_t ES_Watchdog_BeginDispatch( void )
+{
+  return _HW_GetTickCount();
+}
+
+/****************************************************************************
+ Function
+   ES_Watchdog_EndDispatch
+ Parameters
+   uint8_t WhichService : priority of the service that was run
+   ES_Event ThisEvent : the event it was run with
+   uint16_t Started : from ES_Watchdog_BeginDispatch
+ Returns
+   None
+ Description
+   Records and reports the dispatch if it went over budget, then feeds the
+   watchdog if the loop is still healthy
+****************************************************************************/
+void ES_Watchdog_EndDispatch( uint8_t WhichService, ES_Event ThisEvent, uint16_t Started )
+{
+  uint16_t Now = _HW_GetTickCount();
+  uint16_t Duration = Now - Started;
+
+  if ( Duration <= DISPATCH_BUDGET_MS ){
+    Strikes = 0;
+  }else{
+    LastOverrun.Event = ThisEvent;
+    LastOverrun.Duration = Duration;
+    LastOverrun.When = Now;
+    LastOverrun.Service = WhichService;
+    LastOverrun.State = 0;
+    if ( (WhichService < NUM_SERVICES) && (StateQueries[WhichService] != NULL) ){
+      LastOverrun.State = StateQueries[WhichService]();
+    }
+    if ( (NumOverruns == 0) || (Duration > WorstOverrun.Duration) ){
+      WorstOverrun = LastOverrun;
+    }
+    if ( NumOverruns < 0xFFFF ){
+      NumOverruns++;
+    }
+    if ( Strikes < 0xFF ){
+      Strikes++;
+    }
+    Report( "overrun", &LastOverrun );
+  }
+  Feed();
+}
+
+/****************************************************************************
+ Function
+   ES_Watchdog_Idle
+ Parameters
+   None
+ Returns
+   None
+ Description
+   Feeds the watchdog if the loop is healthy
+ Notes
+   called by ES_Run each time the service queues are empty
+****************************************************************************/
+void ES_Watchdog_Idle( void )
+{
+  Feed();
+}
+
+/****************************************************************************
+ Function
+   ES_Watchdog_QueryOverruns
+ Parameters
+   None
+ Returns
+   uint16_t : dispatches that went over budget since ES_Initialize
+****************************************************************************/
+uint16_t ES_Watchdog_QueryOverruns( void )
+{
+  return NumOverruns;
+}
+
+/****************************************************************************
+ Function
+   ES_Watchdog_GetWorstOverrun
+ Parameters
+   ES_Overrun_t * pOverrun : filled in with the longest overrun
+ Returns
+   bool : false if there hasn't been one
+****************************************************************************/
+bool ES_Watchdog_GetWorstOverrun( ES_Overrun_t *pOverrun )
+{
+  if ( NumOverruns == 0 ){
+    return false;
+  }
+  *pOverrun = WorstOverrun;
+  return true;
+}
+
+/****************************************************************************
+ Function
+   ES_Watchdog_GetLastOverrun
+ Parameters
+   ES_Overrun_t * pOverrun : filled in with the latest overrun
+ Returns
+   bool : false if there hasn't been one
+****************************************************************************/
+bool ES_Watchdog_GetLastOverrun( ES_Overrun_t *pOverrun )
+{
+  if ( NumOverruns == 0 ){
+    return false;
+  }
+  *pOverrun = LastOverrun;
+  return true;
+}
+
+//*********************************
+// private functions
+//*********************************
+// Feeds the watchdog while the loop is healthy
+static void Feed( void )
+{
+  uint16_t Now = _HW_GetTickCount();
+
+  if ( !Running || (Strikes >= DEADLINE_STRIKES) ){
+#ifdef ES_HOST_PORT
+    if ( Running && ((uint16_t)(Now - LastFeed) >= WATCHDOG_TIMEOUT_MS) ){
+      Report( "watchdog", &LastOverrun );
+      LastFeed = Now;
+    }
+#endif
+    return;
+  }
+  if ( (uint16_t)(Now - LastFeed) < WATCHDOG_FEED_MS ){
+    return;
+  }
+#ifndef ES_HOST_PORT
+  _HW_Watchdog_Feed();
+#endif
+  LastFeed = Now;
+}
+
+// Prints an overrun record
+static void Report( const char *What, const ES_Overrun_t *pOverrun )
+{
+  printf( "ES %s: service %d took %d ms on event %d (%d) in state 0x%04x\r\n",
+          What, pOverrun->Service, pOverrun->Duration, pOverrun->Event.EventType,
+          pOverrun->Event.EventParam, pOverrun->State );
+}
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
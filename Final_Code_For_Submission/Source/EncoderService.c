@@ -5,6 +5,7 @@
 	Revision			Revised by: 
 	0.1.1					Alex						2/5/15
 	0.1.2					Alex						2/22/15
+	0.2.2					Alex
 
  Description
    Encoder service to set up input capture needed for both encoders and a 20 ms timer
@@ -14,6 +15,7 @@
 	Edits:
 	0.1.1 - Created for lab7
 	0.2.1 - Updated to control both motors on one 20 ms timer
+	0.2.2 - Control law gains come from the calibration store
 ****************************************************************************/
 /*----------------------------- Include Files -----------------------------*/
 /* include header files for this state machine as well as any machines at the
@@ -24,6 +26,7 @@
 #include <cmath>
 #include "PWM.h"
 #include "EncoderService.h"
+#include "CalStore.h"
 
 #include "ES_Port.h"
 #include "termio.h"
@@ -89,8 +92,6 @@ static float errorB = 0;
 static int requestedDutyA = 0;
 static int requestedDutyB = 0;
 
-static float pGain = 1.5;
-static float iGain = 0.1;
 
 
 
@@ -306,6 +307,8 @@ void ControlLaw( void ) {
 	// Implement control law for both encoders
 	errorA = refSpeedA - RPMA;
 	sumErrorA += errorA;
+	float pGain = GetCalFloat(CAL_P_GAIN);
+	float iGain = GetCalFloat(CAL_I_GAIN);
 	requestedDutyA = pGain*errorA + iGain*sumErrorA;
 	
 	errorB = refSpeedB - RPMB;
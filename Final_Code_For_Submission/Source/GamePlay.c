@@ -6,6 +6,12 @@
 	0.1.1				Alex
 	0.1.2       Alex
 	0.1.3				Alex
+	0.1.4				Alex
+	0.2.1				Alex
+	0.2.2				Alex
+	0.2.3				Alex
+	0.2.4				Alex
+	0.2.5				Alex
 
  Description
 	Gameplay state machine that controls the driving, shooting, and obstacle
@@ -15,6 +21,21 @@
 	0.1.1 - Set up as template 
 	0.1.2 - Changed to have running game state machine and pause state to remove "hack"
 	0.1.3 - Modified pause state to implement last input to motors upon re-entry
+	0.1.4 - Pause freezes and thaws the timers as a group
+	0.2.1 - Runs on the table driven HSM engine, resuming after a caution
+	        is a history transition
+	0.2.2 - Timeouts and shot events that arrive during a caution are kept
+	        and handed back to the running game when it resumes
+	0.2.3 - Pausing no longer exits the machines below, only the end of the
+	        game does. A caution while following the path used to stop the
+	        follower for good.
+	0.2.4 - Only the running game's timers are paused. The servo sequencer
+	        and kart select run in Master ahead of us, so their timeouts
+	        were handled once and then again when recalled.
+	0.2.5 - The timers and motors are only restored when the caution is
+	        over. A game that ends while paused flushes the frozen timers
+	        and Drive sees the GameOver, so nothing carries into the next
+	        race.
 ****************************************************************************/
 /*----------------------------- Include Files -----------------------------*/
 /* include header files for this state machine as well as any machines at the
@@ -23,46 +44,97 @@
 #include "Headers.h"
 
 /*----------------------------- Module Defines ----------------------------*/
+// Timers paused by the caution flag. The ones Master runs ahead of us (DRS,
+// battery, servo sequencer and kart select) keep running, their timeouts
+// have already been handled by the time we see them.
+#define MASTER_TIMERS ((1 << DRS_TIMER) | (1 << BATTERY_TIMER) | \
+											 (1 << SERVO_TIMER) | (1 << KART_SELECT_TIMER))
+#define PAUSE_TIMER_GROUP ((uint16_t)~MASTER_TIMERS)
+
+// Recall order for the events kept while paused, timeouts go back first
+#define PAUSED_TIMEOUT_PRIORITY 2
+#define PAUSED_EVENT_PRIORITY 1
 
 /*---------------------------- Module Functions ---------------------------*/
-/* prototypes for private functions for this machine, things like during
-   functions, entry & exit functions.They should be functions relevant to the
-   behavior of this state machine
-*/
-static ES_Event DuringRunningGameStateGP(ES_Event Event);
-static ES_Event DuringPauseState(ES_Event Event);
-static ES_Event DuringWaitForStartState(ES_Event Event);
+// Entry, exit and during prototypes are generated with the tables below
 
 /*---------------------------- Module Variables ---------------------------*/
-// everybody needs a state variable, you may need others as well
-static GamePlayState CurrentState;
 static uint8_t lastPWM_Starboard;
 static uint8_t lastPWM_Port;
 static int dirStar;
 static int dirPort;
 
+// Events the running game was waiting on when it was paused, at most a
+// full Master queue of them can have been posted before the caution
+static ES_DeferredEvent_t PausedEntries[SERV_0_QUEUE_SIZE];
+static ES_DeferralQueue_t PausedEvents;
+
+/*--------------------------- hsm_gen: tables ----------------------------*/
+static void EntryRunningGameStateGP( const ES_Event *Event );
+static void ExitRunningGameStateGP( const ES_Event *Event );
+static void DuringRunningGameStateGP( ES_Event *Event );
+static void EntryPauseState( const ES_Event *Event );
+static void ExitPauseState( const ES_Event *Event );
+static void DuringPauseState( ES_Event *Event );
+static void EntryWaitForStartState( const ES_Event *Event );
+static void ExitWaitForStartState( const ES_Event *Event );
+static void DuringWaitForStartState( ES_Event *Event );
+static void EndRunningGame( const ES_Event *Event );
+static void ResumeRunningGame( const ES_Event *Event );
+
+// Transition tables, one per state
+static const HSM_TRANSITION_t RunningGameTransitions[] = {
+	// Pausing leaves the machines below as they are, the timers are frozen
+	{CautionFlagDropped, PauseState, NULL, NULL, false, "Caution Flag Dropped"},
+	{GameOver, WaitForStartState, NULL, EndRunningGame, false, "Game Over"},
+	{EmergencyStop, PauseState, NULL, NULL, false, "Emergency Stop"}
+};
+
+static const HSM_TRANSITION_t PauseTransitions[] = {
+	// Pick the running game up where the caution stopped it, with its
+	// timers, motors and the events it was waiting for when it was paused
+	{FlagDropped, RunningGameStateGP, NULL, ResumeRunningGame, true, "Caution Over"},
+	{GameOver, WaitForStartState, NULL, EndRunningGame, false, "Game Over"}
+};
+
+static const HSM_TRANSITION_t WaitForStartTransitions[] = {
+	{FlagDropped, RunningGameStateGP, NULL, NULL, false, "Flag Dropped"}
+};
+
+// Indexed by GamePlayState
+static const HSM_STATE_t GamePlayStates[] = {
+	[RunningGameStateGP] =  {"RunningGame", EntryRunningGameStateGP, ExitRunningGameStateGP,
+	                         DuringRunningGameStateGP, HSM_TRANSITIONS(RunningGameTransitions)},
+	[PauseState] =          {"Pause", EntryPauseState, ExitPauseState,
+	                         DuringPauseState, HSM_TRANSITIONS(PauseTransitions)},
+	[WaitForStartState] =   {"WaitForStart", EntryWaitForStartState, ExitWaitForStartState,
+	                         DuringWaitForStartState, HSM_TRANSITIONS(WaitForStartTransitions)}
+};
+
+static uint8_t GamePlayLookup[HSM_LOOKUP_SIZE(sizeof(GamePlayStates)/sizeof(GamePlayStates[0]))];
+static HSM_t GamePlayHSM = HSM_MACHINE(GamePlayStates, GamePlayLookup);
+/*------------------------- hsm_gen: end tables --------------------------*/
+
 /*------------------------------ Module Code ------------------------------*/
 
+/*-------------------------- hsm_gen: functions ---------------------------*/
+
 /****************************************************************************
  Function
      StartGamePlay
 
  Parameters
-     Event_t CurrentEvent
+     ES_Event CurrentEvent, ES_ENTRY or ES_ENTRY_HISTORY
 
  Returns
      None
 
  Description
-     Sets initial state to WaitForStartState
+     Starts in WaitForStartState, or the last state on ES_ENTRY_HISTORY
 ****************************************************************************/
 void StartGamePlay ( ES_Event CurrentEvent )
 {
-	// Local variable to get debugger to display the value of CurrentEvent
-	volatile ES_Event LocalEvent = CurrentEvent;
-	CurrentState = WaitForStartState;
-	// Call the entry function for the ENTRY_STATE
-	RunGamePlay(CurrentEvent);
+	HSM_Start(&GamePlayHSM, WaitForStartState, &CurrentEvent);
 }
 
 /****************************************************************************
@@ -70,109 +142,19 @@ void StartGamePlay ( ES_Event CurrentEvent )
     RunGamePlay
 
  Parameters
-   unsigned char: the event to process
+   ES_Event : the event to process
 
  Returns
-   unsigned char: an event to return
+   ES_Event, the event passed in
 
  Description
-   run function for game play state machine
+   Runs the GamePlay state machine
 ****************************************************************************/
 ES_Event RunGamePlay( ES_Event CurrentEvent )
 {
-	bool MakeTransition = false;/* are we making a state transition? */
-	GamePlayState NextState = CurrentState;
-	ES_Event EntryEventKind = { ES_ENTRY, 0 };// default to normal entry to new state
 	ES_Event ReturnEvent = CurrentEvent; // assume we are not consuming event
-
-	switch ( CurrentState )
-	{
-		case RunningGameStateGP :
-			// Execute During function for driving state
-			CurrentEvent = DuringRunningGameStateGP(CurrentEvent);
-			// Process any events
-			if ( CurrentEvent.EventType != ES_NO_EVENT )
-			{
-				 switch (CurrentEvent.EventType)
-				 {
-					 case CautionFlagDropped :
-						 printf("Caution Flag Dropped \r\n");
-						 // Move to pause state
-						 NextState = PauseState;
-						 MakeTransition = true;
-						 break;
-					 case GameOver :
-						 printf("Game Over \r\n");
-						 // Restart to wait for start state
-						 NextState = WaitForStartState;
-						 MakeTransition = true;
-						 break;
-					 case EmergencyStop :
-						 printf("Emergency Stop \r\n");
-						 // Move to pause state
-						 NextState = PauseState;
-						 MakeTransition = true;
-						 break;
-				 }
-			}
-			break;
-		case PauseState :
-			// Execute During function for pause state
-			CurrentEvent = DuringPauseState(CurrentEvent);
-			// Process any events
-			if ( CurrentEvent.EventType != ES_NO_EVENT )
-			{
-				switch (CurrentEvent.EventType)
-				{
-					case FlagDropped :
-						printf("Caution Over \r\n");
-						// Change entry event to with history
-						EntryEventKind.EventType = ES_ENTRY_HISTORY;
-						// Move to running game state
-						NextState = RunningGameStateGP;
-						MakeTransition = true;
-						break;
-					case GameOver :
-					  printf("Game Over \r\n");
-						// Restart to wait for start state
-						NextState = WaitForStartState;
-						MakeTransition = true;
-						break;
-				}
-			}
-			break;		 
-		case WaitForStartState :
-			// Execute During function for pause state
-			CurrentEvent = DuringWaitForStartState(CurrentEvent);
-			// Process any events
-			if ( CurrentEvent.EventType != ES_NO_EVENT )
-			{
-				switch (CurrentEvent.EventType)
-				{
-					case FlagDropped :
-						printf("Flag Dropped \r\n");
-						// Move to running game state
-						NextState = RunningGameStateGP;
-						MakeTransition = true;
-						break;
-				}
-			}
-		break;
-	}
-	//   If we are making a state transition
-	if (MakeTransition == true)
-	{
-		 //   Execute exit function for current state
-		 CurrentEvent.EventType = ES_EXIT;
-		 RunGamePlay(CurrentEvent);
-
-		 CurrentState = NextState; //Modify state variable
-
-		 //   Execute entry function for new state
-		 CurrentEvent.EventType = ES_ENTRY;
-		 RunGamePlay(EntryEventKind);
-	 }
-	 return(ReturnEvent);
+	HSM_Run(&GamePlayHSM, &CurrentEvent);
+	return(ReturnEvent);
 }
 
 /****************************************************************************
@@ -183,142 +165,165 @@ ES_Event RunGamePlay( ES_Event CurrentEvent )
      None
 
  Returns
-     The current state of the state machine
-
- Description
-     Returns the current state of the state machine
+     GamePlayState the current state
 ****************************************************************************/
 GamePlayState QueryGamePlay ( void )
 {
-	return(CurrentState);
+	return((GamePlayState)HSM_Query(&GamePlayHSM));
 }
 
+/*------------------------ hsm_gen: end functions -------------------------*/
+
 /***************************************************************************
  private functions
  ***************************************************************************/
 
+// Entry Function for RunningGameStateGP
+static void EntryRunningGameStateGP(const ES_Event *Event)
+{
+	printf("Entered Running Game State \r\n");
+	// Coming back from a caution the lower machines carry on where they were
+	if (Event->EventType == ES_ENTRY) {
+		// Start Running Game state machine and Drive service in parallel
+		StartRunningGame(*Event);
+		StartDrive(*Event);
+	}
+}
+
+// Exit Function for RunningGameStateGP
+static void ExitRunningGameStateGP(const ES_Event *Event)
+{
+	printf("Exited Running Game State \r\n");
+	// The lower levels are only exited when the game ends, see
+	// EndRunningGame. A pause freezes their timers and picks them up again
+	// where they were, so their exits must not stop anything.
+}
+
 // During Function for RunningGameStateGP
-static ES_Event DuringRunningGameStateGP(ES_Event Event)
+static void DuringRunningGameStateGP(ES_Event *Event)
+{
+	ES_Event ThisEvent = *Event;
+	// Run Running Game state machine, Drive service, and Ball Shooter service in parallel
+	*Event = RunRunningGame(ThisEvent);
+	RunDrive(ThisEvent);
+	RunBallShooter(ThisEvent);
+}
+
+// Entry Function for PauseState
+static void EntryPauseState(const ES_Event *Event)
 {
-	// Local variable to get debugger to display the value of CurrentEvent
-	volatile ES_Event NewEvent = Event;
+	printf("Entered Pause State \r\n");
+	
+	// Save motor states
+	lastPWM_Starboard = GetLastPWM(0);
+	lastPWM_Port = GetLastPWM(1);
+	dirPort = HWREG(GPIO_PORTB_BASE + ALL_BITS) & BIT3HI;
+	dirStar = HWREG(GPIO_PORTB_BASE + ALL_BITS) & BIT2HI;
+	
+	printf("Kill Motors \r\n");
+	// Kill motors
+	HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~(BIT2HI | BIT3HI);
+	SetPWMDuty(0,STARBOARD_MOTOR);
+	SetPWMDuty(0,PORT_MOTOR);
+	
+	// Pause the running game's timers, remaining time is kept
+	ES_Timer_FreezeGroup(PAUSE_TIMER_GROUP);
+}
 
-	// Process ES_ENTRY & ES_EXIT events
-	if (Event.EventType == ES_ENTRY ) {
-		printf("Entered Running Game State \r\n");
-		// Start Running Game state machine and Drive service in parallel
-		StartRunningGame(Event);
-		StartDrive(Event);
+// Exit Function for PauseState
+static void ExitPauseState(const ES_Event *Event)
+{
+	printf("Exited Pause State \r\n");
+	// Whether the timers and motors come back depends on why we are
+	// leaving, see ResumeRunningGame and EndRunningGame
+}
+
+// Picks the running game up where the caution stopped it, with the events
+// it was waiting on
+static void ResumeRunningGame(const ES_Event *Event)
+{
+	// Restart timers that were active before
+	ES_Timer_ThawGroup(PAUSE_TIMER_GROUP);
+	// Reset motors to previous state
+	if(!dirPort) {
+		HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~(BIT3HI);
+	}
+	else {
+		HWREG(GPIO_PORTB_BASE + ALL_BITS) |= (BIT3HI);
 	}
-	else if (Event.EventType == ES_EXIT) {
-		printf("Exited Running Game State \r\n");
-		// On exit, give the lower levels a chance to clean up first
-		NewEvent = RunRunningGame(Event);
-		RunDrive(Event);
+	
+	if(!dirStar) {
+		HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~(BIT2HI);
 	}
 	else {
-		// Do the 'during' function for this state
-		// Run Running Game state machine, Drive service, and Ball Shooter service in parallel
-		NewEvent = RunRunningGame(Event);
-		RunDrive(Event);
-		RunBallShooter(Event);
+		HWREG(GPIO_PORTB_BASE + ALL_BITS) |= (BIT2HI);
 	}
-	return(NewEvent);
+	
+	SetPWMDuty(lastPWM_Starboard,STARBOARD_MOTOR);
+	SetPWMDuty(lastPWM_Port,PORT_MOTOR);
+	
+	printf("\r\n");
+	printf("%d \r\n", QueryRunningGame());
+	ES_RecallDeferred(&PausedEvents);
 }
 
 // During Function for PauseState
-static ES_Event DuringPauseState(ES_Event Event)
+static void DuringPauseState(ES_Event *Event)
 {
-	static bool TimerStates[numTimers];
-	
-	// Local variable to get debugger to display the value of CurrentEvent
-	volatile ES_Event NewEvent = Event;
-
-	// Process ES_ENTRY & ES_EXIT events
-	if (Event.EventType == ES_ENTRY) {
-		printf("Entered Pause State \r\n");
-		
-		// Save motor states
-		lastPWM_Starboard = GetLastPWM(0);
-		lastPWM_Port = GetLastPWM(1);
-		dirPort = HWREG(GPIO_PORTB_BASE + ALL_BITS) & BIT3HI;
-		dirStar = HWREG(GPIO_PORTB_BASE + ALL_BITS) & BIT2HI;
-		
-		printf("Kill Motors \r\n");
-		// Kill motors
-		HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~(BIT2HI | BIT3HI);
-		SetPWMDuty(0,STARBOARD_MOTOR);
-		SetPWMDuty(0,PORT_MOTOR);
-		
-		// Loop through all timers
-		for(int i = 0;i < numTimers;i++) {
-			// Track active timers 
-			if(ES_Timer_isActive(i)){
-				TimerStates[i] = true;
-			}
-			// Pause all timers
-			if(i!=DRS_TIMER){
-				ES_Timer_StopTimer(i);
-			}
-		}
+	// Timeouts and shot events queued before the caution are what the running
+	// game is waiting on, keep them for when it picks up again
+	bool keep = false;
+	uint8_t priority = PAUSED_EVENT_PRIORITY;
+	if(Event->EventType == ES_TIMEOUT && ((1 << Event->EventParam) & PAUSE_TIMER_GROUP)) {
+		keep = true;
+		priority = PAUSED_TIMEOUT_PRIORITY;
 	}
-	else if (Event.EventType == ES_EXIT) {
-		printf("Exited Pause State \r\n");
-		// Restart timers that were active before
-		for(int i = 0;i < numTimers;i++) {
-			printf("%d ", TimerStates[i]);
-			if(TimerStates[i]) {
-				ES_Timer_StartTimer(i);
-			}
-		}
-		// Reset motors to previous state
-		if(!dirPort) {
-			HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~(BIT3HI);
-		}
-		else {
-			HWREG(GPIO_PORTB_BASE + ALL_BITS) |= (BIT3HI);
-		}
-		
-		if(!dirStar) {
-			HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~(BIT2HI);
-		}
-		else {
-			HWREG(GPIO_PORTB_BASE + ALL_BITS) |= (BIT2HI);
-		}
-		
-		SetPWMDuty(lastPWM_Starboard,STARBOARD_MOTOR);
-		SetPWMDuty(lastPWM_Port,PORT_MOTOR);
-		
-		printf("\r\n");
-		printf("%d \r\n", QueryRunningGame());
+	else if(Event->EventType == ServoSequenceDone || Event->EventType == BallsFired) {
+		keep = true;
 	}
-	else {
-		// No during functionality
+
+	if(keep) {
+		if(!ES_DeferEventWith(&PausedEvents, *Event, priority, ES_DEFER_FOREVER)) {
+			printf("Pause: no room to keep event %d \r\n", Event->EventType);
+		}
+		Event->EventType = ES_NO_EVENT;
 	}
-	return(NewEvent);
+}
+
+// Gives the lower levels a chance to clean up once the game is over,
+// whether it was running or paused. Drive stops its moves and timers on
+// the GameOver itself.
+static void EndRunningGame(const ES_Event *Event)
+{
+	ES_Event ExitEvent = {ES_EXIT, 0};
+	// Timers frozen by a caution are not picked up again
+	ES_Timer_FlushGroup(PAUSE_TIMER_GROUP);
+	RunRunningGame(ExitEvent);
+	RunDrive(*Event);
+}
+
+// Entry Function for WaitForStartState
+static void EntryWaitForStartState(const ES_Event *Event)
+{
+	printf("Entered Wait For Start State \r\n");
+	// Nothing from a finished game is carried into the next one
+	ES_InitDeferral(&PausedEvents, PausedEntries, ARRAY_SIZE(PausedEntries), PostMaster);
+	printf("Kill Motors \r\n");
+	// Kill motors
+	HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~(BIT2HI | BIT3HI);
+	SetPWMDuty(0,STARBOARD_MOTOR);
+	SetPWMDuty(0,PORT_MOTOR);
+}
+
+// Exit Function for WaitForStartState
+static void ExitWaitForStartState(const ES_Event *Event)
+{
+	printf("Exited Wait For Start State \r\n");
 }
 
 // During Function for WaitForStartState
-static ES_Event DuringWaitForStartState(ES_Event Event)
+static void DuringWaitForStartState(ES_Event *Event)
 {
-	// Local variable to get debugger to display the value of CurrentEvent
-	volatile ES_Event NewEvent = Event;
-
-	// Process ES_ENTRY & ES_EXIT events
-	if (Event.EventType == ES_ENTRY) {
-		printf("Entered Wait For Start State \r\n");
-		printf("Kill Motors \r\n");
-		// Kill motors
-		HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~(BIT2HI | BIT3HI);
-		SetPWMDuty(0,STARBOARD_MOTOR);
-		SetPWMDuty(0,PORT_MOTOR);
-	}
-	else if (Event.EventType == ES_EXIT) {
-		printf("Exited Wait For Start State \r\n");
-		// No exit functionality
-	}
-	else {
-		RunBallShooter(Event);
-	}
-	return(NewEvent);
+	RunBallShooter(*Event);
 }
+
@@ -0,0 +1,226 @@
+/****************************************************************************
+ Module
+	HSM.c
+
+ Revision			Revised by:
+	0.1.1				Alex
+
+ Description
+	Table driven engine for the hierarchical state machines. A machine is a
+	const array of states, each with entry, exit and during hooks and a
+	const table of transitions. The first time a machine is started a lookup
+	of the first transition row for every state and event is built, so
+	finding the transition for an event doesn't search the table.
+
+	Events are passed down by pointer. A state's during hook runs the
+	machines below it and can consume the event by setting it to
+	ES_NO_EVENT, otherwise the transition table is checked. Taking a
+	transition runs the exit hook, the action and then the entry hook of the
+	target, without going back through the run function.
+
+	Starting a machine with ES_ENTRY_HISTORY goes back to the state it was
+	in when it was last exited, and a transition marked History enters its
+	target with ES_ENTRY_HISTORY so the target can resume the machines below
+	it.
+
+ Edits:
+	0.1.1 - Initial version, replaces the switch and MakeTransition pattern
+****************************************************************************/
+
+/*----------------------------- Include Files -----------------------------*/
+#include "Headers.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+
+/*---------------------------- Module Functions ---------------------------*/
+static bool BuildLookup( HSM_t *Machine );
+static void Enter( HSM_t *Machine, ES_EventTyp_t EntryType );
+static void TakeTransition( HSM_t *Machine, const HSM_TRANSITION_t *Row, const ES_Event *Event );
+
+/*---------------------------- Module Variables ---------------------------*/
+
+/*------------------------------ Module Code ------------------------------*/
+
+/****************************************************************************
+ Function
+	HSM_Start
+
+ Parameters
+	HSM_t * machine to start
+	uint8_t state to start in
+	const ES_Event * ES_ENTRY, or ES_ENTRY_HISTORY to resume the last state
+
+ Returns
+	bool false if the machine's tables are bad, it is not started
+
+ Description
+	Builds the lookup the first time, then runs the entry hook of the state
+	the machine starts in
+****************************************************************************/
+bool HSM_Start( HSM_t *Machine, uint8_t InitialState, const ES_Event *EntryEvent )
+{
+	if(!Machine->Built && !BuildLookup(Machine)) {
+		return false;
+	}
+	if(InitialState >= Machine->NumStates) {
+		printf("HSM: bad initial state %d \r\n", InitialState);
+		return false;
+	}
+
+	bool resume = (EntryEvent->EventType == ES_ENTRY_HISTORY && Machine->Started);
+	if(!resume) {
+		Machine->CurrentState = InitialState;
+	}
+	Machine->Started = true;
+	Enter(Machine, resume ? ES_ENTRY_HISTORY : ES_ENTRY);
+	return true;
+}
+
+/****************************************************************************
+ Function
+	HSM_Run
+
+ Parameters
+	HSM_t * machine to run
+	ES_Event * the event, the during hook may change it
+
+ Returns
+	bool true if a transition was taken
+
+ Description
+	ES_EXIT runs the exit hook of the current state. Anything else goes to
+	the during hook and then, if it wasn't consumed, to the transition
+	table.
+****************************************************************************/
+bool HSM_Run( HSM_t *Machine, ES_Event *Event )
+{
+	if(!Machine->Started) {
+		return false;
+	}
+	const HSM_STATE_t *state = &Machine->States[Machine->CurrentState];
+
+	// Our parent is leaving, tidy up the current state
+	if(Event->EventType == ES_EXIT) {
+		if(state->Exit != NULL) {
+			state->Exit(Event);
+		}
+		return false;
+	}
+
+	if(state->During != NULL) {
+		state->During(Event);
+	}
+	if(Event->EventType == ES_NO_EVENT || Event->EventType >= NUM_ES_EVENTS) {
+		return false;
+	}
+
+	uint8_t row = Machine->Lookup[Machine->CurrentState*NUM_ES_EVENTS + Event->EventType];
+	while(row < state->NumTransitions && state->Transitions[row].Event == Event->EventType) {
+		const HSM_TRANSITION_t *transition = &state->Transitions[row];
+		if(transition->Guard == NULL || transition->Guard(Event)) {
+			TakeTransition(Machine, transition, Event);
+			return true;
+		}
+		row++;
+	}
+	return false;
+}
+
+/****************************************************************************
+ Function
+	HSM_Query
+
+ Parameters
+	const HSM_t * machine
+
+ Returns
+	uint8_t index of the current state
+****************************************************************************/
+uint8_t HSM_Query( const HSM_t *Machine )
+{
+	return Machine->CurrentState;
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+
+// Fills in the lookup and checks the tables, false if they can't be used
+static bool BuildLookup( HSM_t *Machine )
+{
+	if(Machine->NumStates == 0 || Machine->NumStates >= HSM_INTERNAL) {
+		printf("HSM: bad number of states \r\n");
+		return false;
+	}
+
+	for(uint8_t s = 0; s < Machine->NumStates; s++) {
+		const HSM_STATE_t *state = &Machine->States[s];
+		uint8_t *lookup = &Machine->Lookup[s*NUM_ES_EVENTS];
+
+		for(uint16_t e = 0; e < NUM_ES_EVENTS; e++) {
+			lookup[e] = HSM_NO_TRANSITION;
+		}
+		if(state->NumTransitions >= HSM_NO_TRANSITION) {
+			printf("HSM: too many transitions in %s \r\n", state->Name);
+			return false;
+		}
+
+		for(uint8_t t = 0; t < state->NumTransitions; t++) {
+			const HSM_TRANSITION_t *transition = &state->Transitions[t];
+			if(transition->Event >= NUM_ES_EVENTS || transition->Event <= ES_EXIT) {
+				printf("HSM: bad event %d in %s \r\n", transition->Event, state->Name);
+				return false;
+			}
+			if(transition->Target >= Machine->NumStates && transition->Target != HSM_INTERNAL) {
+				printf("HSM: bad target in %s \r\n", state->Name);
+				return false;
+			}
+			if(lookup[transition->Event] == HSM_NO_TRANSITION) {
+				lookup[transition->Event] = t;
+			}
+			// Rows for an event have to be together or the later ones are never seen
+			else if(state->Transitions[t - 1].Event != transition->Event) {
+				printf("HSM: rows for event %d split in %s \r\n", transition->Event, state->Name);
+				return false;
+			}
+		}
+	}
+	Machine->Built = true;
+	return true;
+}
+
+// Runs the entry hook of the current state
+static void Enter( HSM_t *Machine, ES_EventTyp_t EntryType )
+{
+	const HSM_STATE_t *state = &Machine->States[Machine->CurrentState];
+	ES_Event entryEvent = {EntryType, 0};
+	if(state->Entry != NULL) {
+		state->Entry(&entryEvent);
+	}
+}
+
+// Exit, action, entry for a transition out of the current state
+static void TakeTransition( HSM_t *Machine, const HSM_TRANSITION_t *Row, const ES_Event *Event )
+{
+	if(Row->Trace != NULL) {
+		printf("%s \r\n", Row->Trace);
+	}
+
+	if(Row->Target == HSM_INTERNAL) {
+		if(Row->Action != NULL) {
+			Row->Action(Event);
+		}
+		return;
+	}
+
+	const HSM_STATE_t *state = &Machine->States[Machine->CurrentState];
+	ES_Event exitEvent = {ES_EXIT, 0};
+	if(state->Exit != NULL) {
+		state->Exit(&exitEvent);
+	}
+	if(Row->Action != NULL) {
+		Row->Action(Event);
+	}
+	Machine->CurrentState = Row->Target;
+	Enter(Machine, Row->History ? ES_ENTRY_HISTORY : ES_ENTRY);
+}
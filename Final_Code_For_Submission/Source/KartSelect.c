@@ -0,0 +1,347 @@
+/****************************************************************************
+ Module
+	KartSelect.c
+
+ Revision			Revised by:
+	0.1.1				Alex
+	0.1.2				Alex
+	0.1.3				Alex
+
+ Description
+	Startup self-test that decides which KART we are. A wrong KART number
+	loses the whole race, so the selector voltage alone isn't trusted.
+
+	Every KART_SELECT_PERIOD the last KART_SELECT_SAMPLES conversions of
+	the selector are averaged. A window that is noisy, or whose average is
+	within KART_SELECT_MARGIN of a threshold, counts for nothing. Once
+	KART_SELECT_AGREE windows in a row say the same KART it is taken.
+
+	While the DRS says every KART is waiting for the start the kart then
+	wiggles on the spot and
+	watches the headings the DRS reports for all three KARTs. The one that
+	turns, when the others don't, is us. If that disagrees with the
+	selector the DRS wins, and if the DRS shows nothing the selector stands.
+	If the selector never settles the DRS decides alone, and failing that
+	the nearest band is used.
+
+	The test never moves the kart once the flag has dropped. The wiggle
+	waits up to KART_SELECT_TIMEOUT for the DRS to first report the game
+	state, and is skipped if it never does.
+
+ Edits:
+	0.1.1 - Initial version, replaces ReadKartSelect in the DRS
+	0.1.2 - The wiggle is gated on the DRS game state of every KART rather
+	than on GamePlay, which doesn't see the flag before we know our KART
+	0.1.3 - Windows are 15 samples, all the ADC history holds. A short
+	window counts as noisy instead of stopping the timeout
+****************************************************************************/
+
+/*----------------------------- Include Files -----------------------------*/
+#include "Headers.h"
+#include "KartSelect.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define KART_SELECT_PERIOD 20
+// ReadADCHistory gives at most ADC_RING_LENGTH - 1 samples
+#define KART_SELECT_SAMPLES 15
+
+// ADC counts, a window inside the margin of a threshold or with a wider
+// spread than this is thrown away
+#define KART_SELECT_MARGIN 80
+#define KART_SELECT_MAX_SPREAD 120
+
+// Windows in a row that must agree, and how many we wait for them (1 s)
+#define KART_SELECT_AGREE 5
+#define KART_SELECT_TIMEOUT 50
+
+// Wiggle out and back at this fraction of half speed, then wait for the
+// DRS to catch up (periods)
+#define WIGGLE_SPEED 0.5f
+#define WIGGLE_TICKS 12
+#define SETTLE_TICKS 10
+
+// Degrees our heading has to change by, the others must change by less
+// than half as much
+#define MIN_RESPONSE 8
+
+typedef enum { SelectSampling, SelectWaitingForDRS, SelectWiggleOut,
+							 SelectWiggleBack, SelectSettling, SelectDone } KartSelectState_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+static void SampleSelector( void );
+static void StartWiggle( void );
+static void WatchWiggle( void );
+static void FinishSelect( void );
+static uint8_t ClassifySelector( uint16_t Reading, uint16_t Margin );
+static uint16_t HeadingChange( uint16_t From, uint16_t To );
+
+/*---------------------------- Module Variables ---------------------------*/
+static KartSelectState_t CurrentState = SelectDone;
+static uint8_t Ticks;
+
+static uint8_t Candidate;						// From the selector, 0 until it settles
+static uint8_t Agreed;
+static uint8_t LastWindow;
+static uint16_t LastMean;
+
+static uint16_t StartTheta[NUM_KARTS];
+static uint16_t MaxResponse[NUM_KARTS];
+
+/*------------------------------ Module Code ------------------------------*/
+
+/****************************************************************************
+ Function
+     StartKartSelect
+
+ Parameters
+     ES_Event CurrentEvent
+
+ Returns
+     nothing
+
+ Description
+     Starts the self-test, the ADC must already be sampling
+****************************************************************************/
+void StartKartSelect ( ES_Event CurrentEvent )
+{
+	CurrentState = SelectSampling;
+	Ticks = 0;
+	Candidate = 0;
+	Agreed = 0;
+	LastWindow = 0;
+	LastMean = 0;
+	ES_Timer_InitTimer(KART_SELECT_TIMER, KART_SELECT_PERIOD);
+}
+
+/****************************************************************************
+ Function
+    RunKartSelect
+
+ Parameters
+   ES_Event : the event to process
+
+ Returns
+   ES_Event, ES_NO_EVENT
+
+ Description
+   Steps the self-test each timeout. The flag dropping cuts it short.
+****************************************************************************/
+ES_Event RunKartSelect ( ES_Event ThisEvent )
+{
+	ES_Event ReturnEvent = {ES_NO_EVENT};
+
+	if(CurrentState == SelectDone) {
+		return ReturnEvent;
+	}
+	if(ThisEvent.EventType == FlagDropped) {
+		if(CurrentState == SelectWiggleOut || CurrentState == SelectWiggleBack) {
+			SetWheelSpeeds(0, 0);
+		}
+		FinishSelect();
+	}
+	else if(ThisEvent.EventType == ES_TIMEOUT && ThisEvent.EventParam == KART_SELECT_TIMER) {
+		Ticks++;
+		if(CurrentState == SelectSampling) {
+			SampleSelector();
+		}
+		else if(CurrentState == SelectWaitingForDRS) {
+			if(QueryGameStateRead()) {
+				StartWiggle();
+			}
+			else if(Ticks >= KART_SELECT_TIMEOUT) {
+				printf("Kart select never saw the DRS game state\r\n");
+				FinishSelect();
+			}
+		}
+		else {
+			WatchWiggle();
+		}
+		if(CurrentState != SelectDone) {
+			ES_Timer_InitTimer(KART_SELECT_TIMER, KART_SELECT_PERIOD);
+		}
+	}
+	return ReturnEvent;
+}
+
+/****************************************************************************
+ Function
+    QueryKartSelectDone
+
+ Parameters
+   none
+
+ Returns
+   bool true once the self-test has decided
+
+ Description
+   QueryMyKartNumber may already be set before this, from the selector
+****************************************************************************/
+bool QueryKartSelectDone( void )
+{
+	return (CurrentState == SelectDone);
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+
+// Judges the latest window of selector samples, moves on to the wiggle
+// once enough agree or the time is up
+static void SampleSelector( void )
+{
+	uint16_t samples[KART_SELECT_SAMPLES];
+	uint8_t count = ReadADCHistory(KART_SELECT_CHANNEL, samples, KART_SELECT_SAMPLES);
+
+	// A short window, before the ADC has filled its history, is as good
+	// as a noisy one
+	uint8_t window = 0;
+	if(count == KART_SELECT_SAMPLES) {
+		uint32_t sum = 0;
+		uint16_t low = 0xFFFF;
+		uint16_t high = 0;
+		for(uint8_t i = 0; i < count; i++) {
+			sum += samples[i];
+			low = (samples[i] < low) ? samples[i] : low;
+			high = (samples[i] > high) ? samples[i] : high;
+		}
+		LastMean = sum/count;
+		if(high - low <= KART_SELECT_MAX_SPREAD) {
+			window = ClassifySelector(LastMean, KART_SELECT_MARGIN);
+		}
+	}
+	Agreed = (window != 0 && window == LastWindow) ? Agreed + 1 : ((window != 0) ? 1 : 0);
+	LastWindow = window;
+
+	if(Agreed >= KART_SELECT_AGREE) {
+		Candidate = window;
+		printf("Kart select reads %d (%d counts)\r\n", Candidate, LastMean);
+		// Good enough to race on if the DRS check can't happen
+		SetMyKartNumber(Candidate);
+		StartWiggle();
+	}
+	else if(Ticks >= KART_SELECT_TIMEOUT) {
+		printf("Kart select ambiguous (%d counts)\r\n", LastMean);
+		StartWiggle();
+	}
+}
+
+// Notes every KART's heading and starts turning, only while the DRS says
+// every KART is waiting for the start
+static void StartWiggle( void )
+{
+	if(!QueryGameStateRead()) {
+		if(CurrentState != SelectWaitingForDRS) {
+			Ticks = 0;
+			CurrentState = SelectWaitingForDRS;
+		}
+		return;
+	}
+	for(uint8_t i = 0; i < NUM_KARTS; i++) {
+		if(QueryKart(i + 1).GameState != DRS_WaitingForStart) {
+			FinishSelect();
+			return;
+		}
+	}
+	for(uint8_t i = 0; i < NUM_KARTS; i++) {
+		StartTheta[i] = QueryKart(i + 1).KartTheta;
+		MaxResponse[i] = 0;
+	}
+	Ticks = 0;
+	CurrentState = SelectWiggleOut;
+	SetWheelSpeeds(-WIGGLE_SPEED, WIGGLE_SPEED);
+}
+
+// Tracks how far each KART has turned, turns back, then stops and waits
+// for the DRS to report where we ended up
+static void WatchWiggle( void )
+{
+	for(uint8_t i = 0; i < NUM_KARTS; i++) {
+		uint16_t change = HeadingChange(StartTheta[i], QueryKart(i + 1).KartTheta);
+		MaxResponse[i] = (change > MaxResponse[i]) ? change : MaxResponse[i];
+	}
+
+	if(CurrentState == SelectWiggleOut && Ticks >= WIGGLE_TICKS) {
+		Ticks = 0;
+		CurrentState = SelectWiggleBack;
+		SetWheelSpeeds(WIGGLE_SPEED, -WIGGLE_SPEED);
+	}
+	else if(CurrentState == SelectWiggleBack && Ticks >= WIGGLE_TICKS) {
+		Ticks = 0;
+		CurrentState = SelectSettling;
+		SetWheelSpeeds(0, 0);
+	}
+	else if(CurrentState == SelectSettling && Ticks >= SETTLE_TICKS) {
+		FinishSelect();
+	}
+}
+
+// Settles on a KART from what the DRS saw and what the selector read
+static void FinishSelect( void )
+{
+	uint8_t responder = 0;
+	uint16_t best = 0;
+	uint16_t next = 0;
+
+	if(CurrentState == SelectWiggleOut || CurrentState == SelectWiggleBack ||
+		 CurrentState == SelectSettling) {
+		for(uint8_t i = 0; i < NUM_KARTS; i++) {
+			if(MaxResponse[i] > best) {
+				next = best;
+				best = MaxResponse[i];
+				responder = i + 1;
+			}
+			else if(MaxResponse[i] > next) {
+				next = MaxResponse[i];
+			}
+		}
+		if(best < MIN_RESPONSE || next*2 >= best) {
+			responder = 0;
+		}
+	}
+	CurrentState = SelectDone;
+
+	if(responder != 0) {
+		if(Candidate != 0 && Candidate != responder) {
+			printf("Kart select said %d but the DRS saw %d turn\r\n", Candidate, responder);
+		}
+		else {
+			printf("DRS confirms kart %d\r\n", responder);
+		}
+		SetMyKartNumber(responder);
+	}
+	else if(Candidate == 0) {
+		printf("DRS saw no kart turn, using the nearest band\r\n");
+		// No window yet if the flag dropped straight away
+		uint16_t reading = (LastMean != 0) ? LastMean : QueryADCLatest(KART_SELECT_CHANNEL);
+		SetMyKartNumber(ClassifySelector(reading, 0));
+	}
+	else {
+		printf("DRS didn't confirm kart %d\r\n", Candidate);
+	}
+}
+
+// Which KART a selector reading is, 0 if it is within Margin of a threshold
+static uint8_t ClassifySelector( uint16_t Reading, uint16_t Margin )
+{
+	uint16_t low = GetCalU16(CAL_KART_SELECT_LOW);
+	uint16_t high = GetCalU16(CAL_KART_SELECT_HIGH);
+
+	if(Reading + Margin < low) {
+		return 3;
+	}
+	if(Reading > high + Margin) {
+		return 1;
+	}
+	if(Reading >= low + Margin && Reading + Margin <= high) {
+		return 2;
+	}
+	return 0;
+}
+
+// Smallest angle between two headings (degrees)
+static uint16_t HeadingChange( uint16_t From, uint16_t To )
+{
+	uint16_t change = (From > To) ? From - To : To - From;
+	change %= 360;
+	return (change > 180) ? 360 - change : change;
+}
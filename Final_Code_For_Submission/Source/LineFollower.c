@@ -0,0 +1,213 @@
+/****************************************************************************
+ Module
+	LineFollower.c
+
+ Revision			Revised by:
+	0.1.1				Alex
+	0.1.2				Alex
+
+ Description
+	Follows the tape with the two reflective sensors mounted either side of
+	the front of the kart. The sensors are sampled in the background by the
+	ADC module. Every CONTROL_TIMER tick the difference between the two
+	readings over their sum gives how far off the tape we are, and a PD
+	correction on that error is split between the wheels. Without tape under
+	either sensor the kart drives straight.
+
+	AtRatio is posted when the tape becomes centered between the sensors and
+	OffRatio when it drifts off center or is lost.
+
+ Edits:
+	0.1.1 - Initial version for the obstacle approach and the return from
+	        the shooting point
+	0.1.2 - AtRatio and OffRatio are published on the event bus
+****************************************************************************/
+
+/*----------------------------- Include Files -----------------------------*/
+#include "Headers.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+// Reading over bare floor, subtracted from both sensors (ADC counts)
+#define FLOOR_READING 600
+
+// Combined reading above the floor that means tape is under a sensor
+#define TAPE_PRESENT 800
+
+// Error counted as centered on the tape
+#define CENTERED_ERROR 0.15f
+
+// PD gains, error runs from -1 (tape under the right sensor) to 1 (left)
+#define LINE_KP 0.6f
+#define LINE_KD 0.05f				// Per second of error rate
+
+// Largest share of the base speed moved between the wheels
+#define MAX_CORRECTION 0.5f
+
+/*---------------------------- Module Functions ---------------------------*/
+static uint16_t AboveFloor( uint8_t Channel );
+
+/*---------------------------- Module Variables ---------------------------*/
+static bool Following = false;
+static float BaseSpeed;
+static float LastError;
+static bool HaveLastError;
+static bool Centered;
+
+/*------------------------------ Module Code ------------------------------*/
+
+/****************************************************************************
+ Function
+	StartLineFollower
+
+ Parameters
+	float forward speed as a fraction of half speed
+
+ Returns
+	none
+
+ Description
+	Starts driving forward and steering onto the tape every control tick
+****************************************************************************/
+void StartLineFollower( float Speed )
+{
+	BaseSpeed = Speed;
+	HaveLastError = false;
+	Centered = false;
+	Following = true;
+	UpdateLineFollower();
+}
+
+/****************************************************************************
+ Function
+	SetLineFollowerSpeed
+
+ Parameters
+	float forward speed as a fraction of half speed
+
+ Returns
+	none
+
+ Description
+	Changes the base speed, used at the next control tick
+****************************************************************************/
+void SetLineFollowerSpeed( float Speed )
+{
+	BaseSpeed = Speed;
+}
+
+/****************************************************************************
+ Function
+	StopLineFollower
+
+ Parameters
+	none
+
+ Returns
+	none
+
+ Description
+	Stops the control tick, leaves the motors to the caller
+****************************************************************************/
+void StopLineFollower( void )
+{
+	Following = false;
+	ES_Timer_StopTimer(CONTROL_TIMER);
+}
+
+/****************************************************************************
+ Function
+	UpdateLineFollower
+
+ Parameters
+	none
+
+ Returns
+	none
+
+ Description
+	Runs one control tick, call on every CONTROL_TIMER timeout while
+	following
+****************************************************************************/
+void UpdateLineFollower( void )
+{
+	if(!Following) {
+		return;
+	}
+
+	float correction = 0;
+	float error;
+	bool onTape = QueryLineError(&error);
+
+	if(onTape) {
+		float rate = 0;
+		if(HaveLastError) {
+			rate = (error - LastError)*1000/CONTROL_TICK;
+		}
+		correction = LINE_KP*error + LINE_KD*rate;
+		if(correction > MAX_CORRECTION) {
+			correction = MAX_CORRECTION;
+		}
+		if(correction < -MAX_CORRECTION) {
+			correction = -MAX_CORRECTION;
+		}
+		LastError = error;
+		HaveLastError = true;
+	}
+	else {
+		// Don't carry a derivative across losing the tape
+		HaveLastError = false;
+	}
+
+	// Tell the state machines when we settle on the tape or come off it
+	bool centered = onTape && error < CENTERED_ERROR && error > -CENTERED_ERROR;
+	if(centered != Centered) {
+		ES_Event newEvent = {centered ? AtRatio : OffRatio, 0};
+		ES_EventBus_Publish(newEvent);
+		Centered = centered;
+	}
+
+	// Positive error means the tape is to the left, so slow the port wheel
+	SetWheelSpeeds(BaseSpeed*(1 - correction), BaseSpeed*(1 + correction));
+
+	ES_Timer_InitTimer(CONTROL_TIMER,CONTROL_TICK);
+}
+
+/****************************************************************************
+ Function
+	QueryLineError
+
+ Parameters
+	float * offset of the tape, -1 under the right sensor to 1 under the left
+
+ Returns
+	bool false if neither sensor sees tape, the error is left unchanged
+
+ Description
+	Reads the latest tape sensor samples
+****************************************************************************/
+bool QueryLineError( float *Error )
+{
+	uint16_t left = AboveFloor(LEFT_TAPE_CHANNEL);
+	uint16_t right = AboveFloor(RIGHT_TAPE_CHANNEL);
+	uint16_t total = left + right;
+
+	if(total < TAPE_PRESENT) {
+		return false;
+	}
+	*Error = ((float)left - right)/total;
+	return true;
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+
+// Sensor reading with the bare floor taken off
+static uint16_t AboveFloor( uint8_t Channel )
+{
+	uint16_t reading = QueryADCLatest(Channel);
+	if(reading < FLOOR_READING) {
+		return 0;
+	}
+	return reading - FLOOR_READING;
+}
@@ -5,6 +5,12 @@
  Revision			Revised by: 
 	0.1.1				Alex
 	0.1.2				Alex
+	0.1.3				Alex
+	0.1.4				Alex
+	0.1.5				Alex
+	0.1.6				Alex
+	0.1.7				Alex
+	0.1.8				Alex
 
  Description
 	Master state machine that contains all other state machines for the Kart
@@ -12,6 +18,12 @@
  Edits:
 	0.1.1 - Set up as template to test hierarchical state machine mechanics
 	0.1.2 - Include printouts in all modules to follow states with keystrokes
+	0.1.3 - Runs the battery monitor alongside the DRS
+	0.1.4 - Runs the servo sequencer alongside the DRS
+	0.1.5 - Subscribes to the sensor events published on the event bus
+	0.1.6 - Gives the deadline monitor the game play and running game states
+	0.1.7 - Loads the calibration store before anything that uses it starts
+	0.1.8 - Runs the kart select self-test alongside the DRS
 ****************************************************************************/
 /*----------------------------- Include Files -----------------------------*/
 /* include header files for this state machine as well as any machines at the
@@ -28,6 +40,12 @@ static ES_Event DuringMaster( ES_Event Event);
 // with the introduction of Gen2, we need a module level Priority var as well
 static uint8_t MyPriority;
 
+// Published events the state machines below us run on
+static const ES_EventTyp_t Subscriptions[] = {
+	FlagDropped, CautionFlagDropped, GameOver, KartUpdated,
+	DetectedBeacon, AtRatio, OffRatio
+};
+
 /*------------------------------ Module Code ------------------------------*/
 /****************************************************************************
  Function
@@ -48,11 +66,18 @@ bool InitMaster ( uint8_t Priority )
   ES_Event ThisEvent;
 
   MyPriority = Priority;  // save our priority
+	InitCalStore();
+	for(uint8_t i = 0; i < sizeof(Subscriptions)/sizeof(Subscriptions[0]); i++) {
+		ES_EventBus_Subscribe(MyPriority, Subscriptions[i]);
+	}
+	ES_Watchdog_SetStateQuery(MyPriority, QueryMasterState);
 	
   // Initialize PWM and non-PWM motor pins
   InitPWM( );
 	InitBallShooter();
 	InitBeaconCaptureResponse();
+	// Build the map section lookup tables
+	InitMapSections();
   ThisEvent.EventType = ES_ENTRY;
   
   // Start the Master State machine
@@ -129,6 +154,25 @@ bool PostMaster( ES_Event ThisEvent )
   return ES_PostToService( MyPriority, ThisEvent);
 }
 
+/****************************************************************************
+ Function
+     QueryMasterState
+
+ Parameters
+     None
+
+ Returns
+     uint16_t the game play state in the high byte and the running game
+     state in the low byte
+
+ Description
+     Where the machines below us are, for the deadline monitor
+****************************************************************************/
+uint16_t QueryMasterState( void )
+{
+	return ((uint16_t)QueryGamePlay() << 8) | QueryRunningGame();
+}
+
 /***************************************************************************
  private functions
  ***************************************************************************/
@@ -145,6 +189,8 @@ static ES_Event DuringMaster( ES_Event Event )
 		// Call start functions for gameplay SM and SPI SM
 		
 		StartDRS(Event);
+		StartKartSelect(Event);
+		StartBattery(Event);
 		StartGamePlay(Event);   
 	}
 	else if ( Event.EventType == ES_EXIT) {
@@ -165,6 +211,9 @@ static ES_Event DuringMaster( ES_Event Event )
 		// Call gameplay SM and SPI SM run functions
 		
 		RunDRS(Event);
+		RunKartSelect(Event);
+		RunBattery(Event);
+		RunServoSequencer(Event);
 		RunGamePlay(Event);			
 	}
 	return(Event);
@@ -0,0 +1,165 @@
+/****************************************************************************
+ Module
+	MotionProfile.c
+
+ Revision			Revised by:
+	0.1.1				Alex
+
+ Description
+	Generates trapezoidal velocity profiles (accelerate, cruise, decelerate)
+	for straight-line and in-place rotation moves. A profile is planned once
+	per move and then sampled every control tick by the Drive module.
+
+ Edits:
+	0.1.1 - Replaces the fixed drive/rotate timers so the kart ramps in and out
+	        of every move instead of slipping at full duty
+****************************************************************************/
+
+/*----------------------------- Include Files -----------------------------*/
+#include "Headers.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+
+/*---------------------------- Module Functions ---------------------------*/
+static uint16_t SecondsToTicks( float Seconds );
+
+/*---------------------------- Module Variables ---------------------------*/
+
+/*------------------------------ Module Code ------------------------------*/
+
+/****************************************************************************
+ Function
+	PlanProfile
+
+ Parameters
+	PROFILE_t * profile to fill in
+	float distance to travel (pixels or degrees)
+	float max velocity (units/sec)
+	float acceleration (units/sec^2)
+
+ Returns
+	none
+
+ Description
+	Splits the move into acceleration, cruise and deceleration phases. Moves
+	too short to reach MaxVelocity become triangular (no cruise phase).
+****************************************************************************/
+void PlanProfile( PROFILE_t *Profile, float Distance, float MaxVelocity, float Acceleration )
+{
+	float accelSeconds;
+	float cruiseSeconds;
+	float peakVelocity;
+
+	if(Distance < 0) {
+		Distance = -Distance;
+	}
+
+	Profile->Distance = Distance;
+	Profile->Acceleration = Acceleration;
+
+	// Nothing to do for an empty move
+	if(Distance == 0 || MaxVelocity <= 0 || Acceleration <= 0) {
+		Profile->PeakVelocity = 0;
+		Profile->AccelTime = 0;
+		Profile->CruiseTime = 0;
+		Profile->TotalTime = 0;
+		return;
+	}
+
+	// Check if we can reach max velocity before we have to slow down again
+	if(MaxVelocity*MaxVelocity/Acceleration >= Distance) {
+		// Triangular profile, peak halfway through the move
+		peakVelocity = sqrt(Distance*Acceleration);
+		cruiseSeconds = 0;
+	}
+	else {
+		// Trapezoidal profile, cruise covers whatever the ramps don't
+		peakVelocity = MaxVelocity;
+		cruiseSeconds = (Distance - MaxVelocity*MaxVelocity/Acceleration)/MaxVelocity;
+	}
+	accelSeconds = peakVelocity/Acceleration;
+
+	Profile->PeakVelocity = peakVelocity;
+	Profile->AccelTime = SecondsToTicks(accelSeconds);
+	Profile->CruiseTime = SecondsToTicks(cruiseSeconds);
+	Profile->TotalTime = 2*Profile->AccelTime + Profile->CruiseTime;
+}
+
+/****************************************************************************
+ Function
+	QueryProfileVelocity
+
+ Parameters
+	PROFILE_t * planned profile
+	uint16_t ticks since the start of the move
+
+ Returns
+	float velocity setpoint (units/sec), 0 once the move is complete
+
+ Description
+	Samples the velocity profile at the given time
+****************************************************************************/
+float QueryProfileVelocity( const PROFILE_t *Profile, uint16_t Time )
+{
+	float seconds;
+
+	// Accelerating
+	if(Time < Profile->AccelTime) {
+		seconds = (float)Time/ONE_SEC;
+		return Profile->Acceleration*seconds;
+	}
+	// Cruising
+	if(Time < Profile->AccelTime + Profile->CruiseTime) {
+		return Profile->PeakVelocity;
+	}
+	// Decelerating
+	if(Time < Profile->TotalTime) {
+		seconds = (float)(Profile->TotalTime - Time)/ONE_SEC;
+		return Profile->Acceleration*seconds;
+	}
+	// Move complete
+	return 0;
+}
+
+/****************************************************************************
+ Function
+	ProfileDistanceForTime
+
+ Parameters
+	uint16_t ticks available for the move
+	float max velocity (units/sec)
+	float acceleration (units/sec^2)
+
+ Returns
+	float the longest distance that can be profiled in the given time
+
+ Description
+	Inverse of PlanProfile, used to cap the length of a single move
+****************************************************************************/
+float ProfileDistanceForTime( uint16_t Time, float MaxVelocity, float Acceleration )
+{
+	float seconds = (float)Time/ONE_SEC;
+
+	// Not enough time to reach max velocity, triangular profile
+	if(seconds*Acceleration <= 2*MaxVelocity) {
+		return Acceleration*(seconds/2)*(seconds/2);
+	}
+	// Time left over is spent cruising
+	return MaxVelocity*(seconds - MaxVelocity/Acceleration);
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+
+// Convert seconds to framework ticks, rounding up so moves never end early
+static uint16_t SecondsToTicks( float Seconds )
+{
+	float ticks = Seconds*ONE_SEC;
+	uint16_t wholeTicks = (uint16_t)ticks;
+
+	if(ticks > wholeTicks) {
+		wholeTicks++;
+	}
+	return wholeTicks;
+}
@@ -7,6 +7,8 @@
 	0.2.1				Alex
 	0.3.1				Alex
 	0.4.1				Alex
+	0.4.2				Alex
+	0.4.3				Alex
 
  Description
 	Obstacle crossing state machine that controls traversing the obstacle
@@ -18,6 +20,9 @@
 	0.2.1 - Update obstacle state machine for tape finding with two analog tape sensors
 	0.3.1 - Update to use timers to cross the obstacle
 	0.3.1 - Use drive type system to control movement toward end of obstacle
+	0.4.2 - Follow the tape up to the obstacle instead of driving blind
+	0.4.3 - Climb speed worked out the way SetWheelSpeeds maps speed to
+	        duty, so the climb is at the tuned duties again
 ****************************************************************************/
 /*----------------------------- Include Files -----------------------------*/
 #include "Headers.h"
@@ -31,8 +36,12 @@
 #define SLIGHT_LEFT_PORT HALF_SPEED_PORT + 5
 #define SLIGHT_LEFT_STARBOARD HALF_SPEED_STARBOARD - 5
 
-#define TIME_TO_OEPOINT 200 //milisec
-#define TIME_TO_TEETERPOINT (1.5*ONE_SEC) //milisec
+// Line follower speeds up to the obstacle, as fractions of half speed.
+// The climb was tuned at quarter speed + 10 duty, half a count is added so
+// the truncation in SetWheelSpeeds still lands on it
+#define APPROACH_SPEED 1.0f
+#define CLIMB_SPEED (((float)(QUARTER_SPEED_PORT+10-MIN_DRIVE_DUTY) + 0.5f)/ \
+										 (HALF_SPEED_PORT-MIN_DRIVE_DUTY))
 
 #define X_CheckTime 100
 #define Y_CheckTime 100
@@ -178,12 +187,8 @@ ES_Event RunObstacle( ES_Event CurrentEvent )
 						if(CurrentEvent.EventParam == NITRO_TIMER) {
 							// Set left motor to drive forward
 							printf("Nitro Timer \r\n");
-							HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~ BIT3HI;
-							// Set right motor to drive forward
-							HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~ BIT2HI;
-							// Set PWM to (1/4 Speed)
-							SetPWMDuty(QUARTER_SPEED_PORT+10,PORT_MOTOR);
-							SetPWMDuty(QUARTER_SPEED_STARBOARD+10,STARBOARD_MOTOR);
+							// Slow down for the climb, still on the tape
+							SetLineFollowerSpeed(CLIMB_SPEED);
 							ES_Timer_InitTimer(OBS_TIMER,X_CheckTime);	 
 						} 
 						else if(CurrentEvent.EventParam == OBS_TIMER) {
@@ -466,22 +471,17 @@ static ES_Event DuringFindYState( ES_Event Event)
 		// set timer 
 		ES_Timer_InitTimer(NITRO_TIMER,ONE_SEC);
 		
-		printf("Drive Forward Slowly \r\n");
-		// Drive forward slowly
-		// Set left motor to drive forward
-		HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~ BIT3HI;
-		// Set right motor to drive forward
-		HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~ BIT2HI;
-		// Set PWM to (1/4 Speed)
-		SetPWMDuty(HALF_SPEED_PORT,PORT_MOTOR);
-		SetPWMDuty(HALF_SPEED_STARBOARD,STARBOARD_MOTOR);
+		printf("Follow Tape To Obstacle \r\n");
+		// Drive forward at half speed along the tape
+		StartLineFollower(APPROACH_SPEED);
 	}
 	else if ( Event.EventType == ES_EXIT) {
 		printf("Exited FindY State \r\n");
-		// No exit functionality 
+		StopLineFollower();
 	}
-	else {
-		// No during functionality
+	else if ( Event.EventType == ES_TIMEOUT && Event.EventParam == CONTROL_TIMER ) {
+		// New wheel speeds every control tick
+		UpdateLineFollower();
 	}
 	return( Event );  // Don't remap event
 }
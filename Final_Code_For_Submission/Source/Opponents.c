@@ -0,0 +1,258 @@
+/****************************************************************************
+ Module
+	Opponents.c
+
+ Revision			Revised by:
+	0.1.1				Alex
+
+ Description
+	Tracks the other two karts from the positions the DRS reports. Each new
+	position gives a velocity estimate that is smoothed and used to predict
+	where the kart will be over the next second. The path follower asks
+	PlanAroundOpponents how to slow down or move over so we don't run into
+	anyone or sit in front of a faster kart.
+
+ Edits:
+	0.1.1 - Initial version
+****************************************************************************/
+
+/*----------------------------- Include Files -----------------------------*/
+#include "Headers.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define PI 3.14159265
+
+// Tracks without a new position for this long are dropped
+#define STALE_TIME ONE_SEC
+
+// Weight given to each new velocity measurement
+#define VELOCITY_GAIN 0.5f
+
+// How far ahead to look for collisions, and in how many steps
+#define PREDICT_TIME ONE_SEC
+#define PREDICT_STEPS 10
+
+// Closest we want to get to another kart (pixels), roughly two kart widths
+#define SAFE_DISTANCE 30.0f
+
+// Largest sideways move off the racing line (pixels)
+#define MAX_LATERAL_OFFSET 10.0f
+
+// Never slow down below this fraction of the planned speed
+#define MIN_SPEED_SCALE 0.3f
+
+// Our speed at half speed duty
+#define HALF_SPEED_PIXELS ((float)PIXELS_PER_3SEC/3)
+
+/*---------------------------- Module Functions ---------------------------*/
+
+/*---------------------------- Module Variables ---------------------------*/
+static OPPONENT_t Tracks[NUM_KARTS];
+static bool HaveSample[NUM_KARTS];
+
+/*------------------------------ Module Code ------------------------------*/
+
+/****************************************************************************
+ Function
+	UpdateOpponent
+
+ Parameters
+	uint8_t kart number (1-3)
+	uint16_t X position from the DRS
+	uint16_t Y position from the DRS
+
+ Returns
+	none
+
+ Description
+	Called by the DRS each time it reads a kart's position. Updates the
+	smoothed velocity from the change since the last position.
+****************************************************************************/
+void UpdateOpponent( uint8_t KartNumber, uint16_t X, uint16_t Y )
+{
+	if(KartNumber < 1 || KartNumber > NUM_KARTS) {
+		return;
+	}
+
+	uint8_t index = KartNumber - 1;
+	OPPONENT_t *track = &Tracks[index];
+	uint16_t now = ES_Timer_GetTime();
+
+	// We don't need to avoid ourselves, and karts off the field read as 0,0
+	if(KartNumber == QueryMyKartNumber() || (X == 0 && Y == 0)) {
+		track->Valid = false;
+		HaveSample[index] = false;
+		return;
+	}
+
+	if(HaveSample[index]) {
+		uint16_t elapsed = now - track->LastUpdate;
+
+		// Same frame, nothing new to learn
+		if(elapsed == 0) {
+			return;
+		}
+
+		if(elapsed > STALE_TIME) {
+			// Too long since the last position to trust a velocity from it
+			track->VX = 0;
+			track->VY = 0;
+		}
+		else {
+			float measuredVX = (X - track->X)*ONE_SEC/elapsed;
+			float measuredVY = (Y - track->Y)*ONE_SEC/elapsed;
+			track->VX += VELOCITY_GAIN*(measuredVX - track->VX);
+			track->VY += VELOCITY_GAIN*(measuredVY - track->VY);
+			track->Valid = true;
+		}
+	}
+	else {
+		track->VX = 0;
+		track->VY = 0;
+	}
+
+	track->X = X;
+	track->Y = Y;
+	track->LastUpdate = now;
+	HaveSample[index] = true;
+}
+
+/****************************************************************************
+ Function
+	QueryOpponent
+
+ Parameters
+	uint8_t kart number (1-3)
+
+ Returns
+	OPPONENT_t the current track for that kart
+
+ Description
+	Returns the track, marked invalid if it is our kart or has gone stale
+****************************************************************************/
+OPPONENT_t QueryOpponent( uint8_t KartNumber )
+{
+	OPPONENT_t track = {false, 0, 0, 0, 0, 0};
+
+	if(KartNumber < 1 || KartNumber > NUM_KARTS) {
+		return track;
+	}
+
+	track = Tracks[KartNumber - 1];
+	if((uint16_t)(ES_Timer_GetTime() - track.LastUpdate) > STALE_TIME) {
+		track.Valid = false;
+	}
+	return track;
+}
+
+/****************************************************************************
+ Function
+	PredictOpponent
+
+ Parameters
+	uint8_t kart number (1-3)
+	uint16_t ticks into the future
+
+ Returns
+	POINT_t predicted position of the kart
+
+ Description
+	Extrapolates the kart's position at its current velocity
+****************************************************************************/
+POINT_t PredictOpponent( uint8_t KartNumber, uint16_t Ticks )
+{
+	OPPONENT_t track = QueryOpponent(KartNumber);
+	POINT_t prediction;
+
+	float X = track.X + track.VX*Ticks/ONE_SEC;
+	float Y = track.Y + track.VY*Ticks/ONE_SEC;
+	prediction.X = (X > 0) ? (uint16_t)X : 0;
+	prediction.Y = (Y > 0) ? (uint16_t)Y : 0;
+	return prediction;
+}
+
+/****************************************************************************
+ Function
+	PlanAroundOpponents
+
+ Parameters
+	KART_t our kart
+	float our planned speed as a fraction of half speed
+	float * speed scale to apply to the planned speed
+	float * sideways offset for the steering target (pixels, positive is to
+	        the left of our heading when looking down on the field)
+
+ Returns
+	none
+
+ Description
+	Steps our path and every opponent's predicted path over the next second.
+	If anyone comes within SAFE_DISTANCE we move away from their side, and if
+	they are in front of us we drop to their speed instead of running into
+	them.
+****************************************************************************/
+void PlanAroundOpponents( KART_t myKart, float Speed, float *SpeedScale, float *LateralOffset )
+{
+	float headingX = -cos(myKart.KartTheta*PI/180);
+	float headingY = sin(myKart.KartTheta*PI/180);
+	float velocity = Speed*HALF_SPEED_PIXELS;
+
+	*SpeedScale = 1;
+	*LateralOffset = 0;
+
+	for(uint8_t kart = 1; kart <= NUM_KARTS; kart++) {
+		OPPONENT_t track = QueryOpponent(kart);
+		if(!track.Valid) {
+			continue;
+		}
+
+		// Find the closest we get to them over the next second
+		float closest = -1;
+		for(uint8_t step = 0; step <= PREDICT_STEPS; step++) {
+			float seconds = (float)step*PREDICT_TIME/PREDICT_STEPS/ONE_SEC;
+			float dX = (track.X + track.VX*seconds) - (myKart.KartX + headingX*velocity*seconds);
+			float dY = (track.Y + track.VY*seconds) - (myKart.KartY + headingY*velocity*seconds);
+			float distance = sqrt(dX*dX + dY*dY);
+			if(closest < 0 || distance < closest) {
+				closest = distance;
+			}
+		}
+
+		if(closest >= SAFE_DISTANCE) {
+			continue;
+		}
+
+		// Where they are relative to us right now
+		float toX = track.X - myKart.KartX;
+		float toY = track.Y - myKart.KartY;
+		float ahead = toX*headingX + toY*headingY;
+		float side = headingX*toY - headingY*toX;
+
+		// In front of us, match their speed along our heading
+		if(ahead > 0 && velocity > 0) {
+			float scale = (track.VX*headingX + track.VY*headingY)/velocity;
+			if(scale < MIN_SPEED_SCALE) {
+				scale = MIN_SPEED_SCALE;
+			}
+			if(scale < *SpeedScale) {
+				*SpeedScale = scale;
+			}
+		}
+
+		// Move away from the side they are on, more the closer they get
+		float push = SAFE_DISTANCE - closest;
+		if(side > 0) {
+			*LateralOffset -= push;
+		}
+		else {
+			*LateralOffset += push;
+		}
+	}
+
+	if(*LateralOffset > MAX_LATERAL_OFFSET) {
+		*LateralOffset = MAX_LATERAL_OFFSET;
+	}
+	if(*LateralOffset < -MAX_LATERAL_OFFSET) {
+		*LateralOffset = -MAX_LATERAL_OFFSET;
+	}
+}
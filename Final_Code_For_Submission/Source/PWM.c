@@ -7,6 +7,7 @@
 	0.2.1					Denny 						
 	0.3.0					Eric						
 	0.3.1 				Eric						
+	0.3.2 				Alex
 
  Description
    PWM service to initialize the Tiva's hardware PWM output to drive our
@@ -20,6 +21,8 @@
 			Reformed functions to allow for all pwm channels currently to be
 			used by both functions
 	0.3.1 - Added motor control pins.
+	0.3.2 - Motor duty is scaled for the battery voltage, GetLastPWM still
+			returns the duty that was asked for
 ****************************************************************************/
 
 /*----------------------------- Include Files -----------------------------*/
@@ -184,11 +187,13 @@ void InitPWM( void )
      none
 
  Description
-		Sets PWM duty cycle to given value
+		Sets PWM duty cycle to given value. Motor channels are scaled by
+		nominal over measured battery voltage.
 ****************************************************************************/
 void SetPWMDuty(uint8_t duty, int channel) {
 	int newDuty;
 	static bool zeroStatus = false;
+	uint16_t motorDuty;
 	//check if requested duty is 0 more than 100
 	if(duty == 0) {
 		newDuty = 0;
@@ -196,11 +201,13 @@ void SetPWMDuty(uint8_t duty, int channel) {
 	}
 	else {
 		if(channel == 1 || channel == 0) {
-			if(duty >= 100) {
+			// Same wheel speed whatever the battery voltage
+			motorDuty = (uint16_t)(duty*QueryDutyScale() + 0.5f);
+			if(motorDuty >= 100) {
 				newDuty = ((PeriodInMicroS * PWMTicksPerMicroS) - 1);
 			}
 			else {
-				newDuty = ((PeriodInMicroS * PWMTicksPerMicroS) - 1)*duty/100;
+				newDuty = ((PeriodInMicroS * PWMTicksPerMicroS) - 1)*motorDuty/100;
 			}
 		}
 		else if(channel == 2 || channel == 3) {
@@ -0,0 +1,391 @@
+/****************************************************************************
+ Module
+	PathFollower.c
+
+ Revision			Revised by:
+	0.1.1				Alex
+	0.1.2				Alex
+	0.1.3				Alex
+	0.1.4				Alex
+
+ Description
+	Pure pursuit path follower that drives the lap continuously instead of
+	stopping and turning in place at every waypoint. The path is the corner
+	loop with the shooting point and obstacle entry added while those tasks
+	are still pending. Every control tick the kart steers toward a point
+	LOOKAHEAD_DIST pixels further along the path.
+
+ Edits:
+	0.1.1 - Initial version, falls back to stop-turn-drive on large heading
+	        errors and when a decision zone needs to be handled
+	0.1.2 - Steers along the precomputed racing line and uses its speed plan
+	        once the shooting and obstacle tasks are done for the lap
+	0.1.3 - Slows down or moves over for opponents predicted to get close
+	0.1.4 - Hands back to the driving state machine at the start of a lap
+	        when a task left off the path is still to be done, so a failed
+	        shot or obstacle is tried again the next lap
+****************************************************************************/
+
+/*----------------------------- Include Files -----------------------------*/
+#include "Headers.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define PI 3.14159265
+#define MAX_PATH_POINTS 6
+
+// Distance along the path to the point we steer toward (pixels)
+#define LOOKAHEAD_DIST 25
+
+// Heading error allowed when starting to follow, and before giving up (degrees)
+#define FOLLOW_ENTRY_ANGLE 30
+#define FOLLOW_EXIT_ANGLE 60
+
+// Cruise speed as a fraction of half speed, slowed down to half of this in turns
+#define FOLLOW_SPEED 1.0f
+
+// Wheel track found from the measured straight speed and spin rate (pixels)
+#define TRACK_WIDTH ((float)PIXELS_PER_3SEC/3*ROTATION_TIME/ONE_SEC/PI)
+
+/*---------------------------- Module Functions ---------------------------*/
+static void BuildPath( bool ShotPending, bool ObstaclePending );
+static uint8_t NextIndex( uint8_t index );
+static float SegmentProgress( uint8_t segment, float X, float Y, float *DistSquared );
+static void PathLookahead( KART_t myKart, float *TargetX, float *TargetY );
+static float HeadingError( KART_t myKart, float TargetX, float TargetY );
+
+/*---------------------------- Module Variables ---------------------------*/
+static POINT_t Path[MAX_PATH_POINTS];
+static uint8_t PathLength;
+// Segment currently being followed, runs from Path[CurrentSegment] to the next point
+static uint8_t CurrentSegment;
+static bool FollowShot;
+static bool FollowObstacle;
+static bool Following = false;
+// Section at the last tick, to see a new lap starting
+static MapSection LastSection;
+
+/*------------------------------ Module Code ------------------------------*/
+
+/****************************************************************************
+ Function
+	PathFollowable
+
+ Parameters
+	bool true if the shooting task still needs to be done
+	bool true if the obstacle task still needs to be done
+
+ Returns
+	bool true if the kart is lined up well enough to follow the path
+
+ Description
+	Builds the path for the rest of the lap and finds the segment the kart
+	is closest to. Called before entering the following state.
+****************************************************************************/
+bool PathFollowable( bool ShotPending, bool ObstaclePending )
+{
+	KART_t myKart = QueryMyKart( );
+	float distSquared;
+	float bestDistSquared = 0;
+
+	BuildPath(ShotPending, ObstaclePending);
+
+	// Find the closest segment of the loop
+	for(uint8_t i = 0; i < PathLength; i++) {
+		SegmentProgress(i, myKart.KartX, myKart.KartY, &distSquared);
+		if(i == 0 || distSquared < bestDistSquared) {
+			bestDistSquared = distSquared;
+			CurrentSegment = i;
+		}
+	}
+
+	// Don't follow if we would have to turn hard to get on the path
+	float targetX;
+	float targetY;
+	PathLookahead(myKart, &targetX, &targetY);
+	float error = HeadingError(myKart, targetX, targetY);
+	if(error < 0) {
+		error = -error;
+	}
+	return (error <= FOLLOW_ENTRY_ANGLE);
+}
+
+/****************************************************************************
+ Function
+	StartPathFollower
+
+ Parameters
+	none
+
+ Returns
+	none
+
+ Description
+	Starts steering along the path built by PathFollowable
+****************************************************************************/
+void StartPathFollower( void )
+{
+	printf("Following Path \r\n");
+	clearThetas();
+	KART_t myKart = QueryMyKart( );
+	POINT_t current = {myKart.KartX, myKart.KartY};
+	LastSection = FindSection(current);
+	Following = true;
+	UpdatePathFollower();
+}
+
+/****************************************************************************
+ Function
+	StopPathFollower
+
+ Parameters
+	none
+
+ Returns
+	none
+
+ Description
+	Stops the control tick and the motors
+****************************************************************************/
+void StopPathFollower( void )
+{
+	Following = false;
+	ES_Timer_StopTimer(CONTROL_TIMER);
+	SetWheelSpeeds(0,0);
+}
+
+/****************************************************************************
+ Function
+	UpdatePathFollower
+
+ Parameters
+	none
+
+ Returns
+	none
+
+ Description
+	Runs one control tick of pure pursuit. Posts AtNextPoint to hand control
+	back to the stop-turn-drive states when the heading error is too large or
+	when a pending decision zone has been reached.
+****************************************************************************/
+void UpdatePathFollower( void )
+{
+	if(!Following) {
+		return;
+	}
+
+	KART_t myKart = QueryMyKart( );
+	POINT_t current = {myKart.KartX, myKart.KartY};
+	float distSquared;
+	float nextDistSquared;
+
+	// Let the driving state machine handle the decision zones
+	MapSection currentSection = FindSection(current);
+	if((currentSection == ShootingDecisionZone && FollowShot) ||
+		 (currentSection == ObstacleDecisionZone && FollowObstacle)) {
+		Following = false;
+		ES_Event newEvent = {AtNextPoint, 0};
+		PostMaster(newEvent);
+		return;
+	}
+
+	// A task that failed was left off the path, the driving state machine
+	// only tries it again once it has seen the lap start
+	bool newLap = (currentSection == LeftStraight && LastSection != LeftStraight);
+	LastSection = currentSection;
+	if(newLap && ((!myKart.ShotComplete && !FollowShot) ||
+								(!myKart.ObstacleComplete && !FollowObstacle))) {
+		Following = false;
+		ES_Event newEvent = {AtNextPoint, 0};
+		PostMaster(newEvent);
+		return;
+	}
+
+	// Move on to the next segment once we are past the end of this one or
+	// closer to the next one
+	float segmentProgress = SegmentProgress(CurrentSegment, myKart.KartX, myKart.KartY, &distSquared);
+	SegmentProgress(NextIndex(CurrentSegment), myKart.KartX, myKart.KartY, &nextDistSquared);
+	if(segmentProgress >= 1 || nextDistSquared < distSquared) {
+		CurrentSegment = NextIndex(CurrentSegment);
+	}
+
+	// Once the tasks are done the lap follows the racing line, otherwise
+	// steer along the waypoints through the shooting and obstacle points
+	float targetX;
+	float targetY;
+	float progress;
+	float speed = -1;
+	if(!FollowShot && !FollowObstacle && RacingLineProgress(currentSection, current, &progress)) {
+		const RACING_POINT_t *ahead = QueryRacingLine(currentSection, progress, LOOKAHEAD_DIST);
+		targetX = ahead->X;
+		targetY = ahead->Y;
+		speed = QueryRacingLine(currentSection, progress, 0)->Speed;
+	}
+	else {
+		PathLookahead(myKart, &targetX, &targetY);
+	}
+
+	// Move the target over and slow down if we are going to get close to
+	// another kart
+	float speedScale;
+	float lateralOffset;
+	PlanAroundOpponents(myKart, (speed < 0) ? FOLLOW_SPEED : speed, &speedScale, &lateralOffset);
+	targetX -= sin(myKart.KartTheta*PI/180)*lateralOffset;
+	targetY -= cos(myKart.KartTheta*PI/180)*lateralOffset;
+
+	// Angle between our heading and the lookahead point
+	float alpha = HeadingError(myKart, targetX, targetY);
+	float absAlpha = alpha;
+	if(alpha < 0) {
+		absAlpha = -alpha;
+	}
+
+	// Too far off the path, fall back to turning in place
+	if(absAlpha > FOLLOW_EXIT_ANGLE) {
+		printf("Heading error %d, stop and turn \r\n", (int)alpha);
+		Following = false;
+		ES_Event newEvent = {AtNextPoint, 0};
+		PostMaster(newEvent);
+		return;
+	}
+
+	// Pure pursuit curvature, positive alpha turns the same way as a
+	// counter-clockwise rotation in Drive so the port wheel slows down
+	float curvature = 2*sin(alpha*PI/180)/LOOKAHEAD_DIST;
+	if(speed < 0) {
+		speed = FOLLOW_SPEED*(1 - 0.5f*absAlpha/FOLLOW_EXIT_ANGLE);
+	}
+	speed *= speedScale;
+	SetWheelSpeeds(speed*(1 - curvature*TRACK_WIDTH/2), speed*(1 + curvature*TRACK_WIDTH/2));
+
+	ES_Timer_InitTimer(CONTROL_TIMER,CONTROL_TICK);
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+
+// Lays out the lap in driving order starting from the bottom left corner
+static void BuildPath( bool ShotPending, bool ObstaclePending )
+{
+	FollowShot = ShotPending;
+	FollowObstacle = ObstaclePending;
+	PathLength = 0;
+
+	Path[PathLength].X = cornerPointMatrix_X[3];
+	Path[PathLength++].Y = cornerPointMatrix_Y[3];
+	// Obstacle entry sits on the bottom straight
+	if(ObstaclePending) {
+		Path[PathLength++] = ObstacleEntry;
+	}
+	Path[PathLength].X = cornerPointMatrix_X[0];
+	Path[PathLength++].Y = cornerPointMatrix_Y[0];
+	Path[PathLength].X = cornerPointMatrix_X[1];
+	Path[PathLength++].Y = cornerPointMatrix_Y[1];
+	Path[PathLength].X = cornerPointMatrix_X[2];
+	Path[PathLength++].Y = cornerPointMatrix_Y[2];
+	// Shooting point sits on the left straight
+	if(ShotPending) {
+		Path[PathLength++] = ShootingPoint;
+	}
+}
+
+// Index of the path point after the given one, the path is a closed loop
+static uint8_t NextIndex( uint8_t index )
+{
+	index++;
+	if(index >= PathLength) {
+		index = 0;
+	}
+	return index;
+}
+
+// Returns how far along a segment (0 to 1) the closest point to X,Y is and
+// the squared distance to that point
+static float SegmentProgress( uint8_t segment, float X, float Y, float *DistSquared )
+{
+	POINT_t start = Path[segment];
+	POINT_t end = Path[NextIndex(segment)];
+	float segX = (float)end.X - start.X;
+	float segY = (float)end.Y - start.Y;
+	float lengthSquared = segX*segX + segY*segY;
+	float progress = 0;
+
+	if(lengthSquared > 0) {
+		progress = ((X - start.X)*segX + (Y - start.Y)*segY)/lengthSquared;
+	}
+
+	// Clamp to the segment for the distance
+	float clamped = progress;
+	if(clamped < 0) {
+		clamped = 0;
+	}
+	if(clamped > 1) {
+		clamped = 1;
+	}
+	float dX = start.X + clamped*segX - X;
+	float dY = start.Y + clamped*segY - Y;
+	*DistSquared = dX*dX + dY*dY;
+
+	return progress;
+}
+
+// Finds the point LOOKAHEAD_DIST along the waypoint path from the kart
+static void PathLookahead( KART_t myKart, float *TargetX, float *TargetY )
+{
+	uint8_t segment = CurrentSegment;
+	float distSquared;
+	float progress = SegmentProgress(segment, myKart.KartX, myKart.KartY, &distSquared);
+	if(progress < 0) {
+		progress = 0;
+	}
+
+	// Walk LOOKAHEAD_DIST along the path from the closest point
+	float remaining = LOOKAHEAD_DIST;
+	float targetX = 0;
+	float targetY = 0;
+	for(uint8_t i = 0; i < PathLength; i++) {
+		POINT_t start = Path[segment];
+		POINT_t end = Path[NextIndex(segment)];
+		float segX = (float)end.X - start.X;
+		float segY = (float)end.Y - start.Y;
+		float length = sqrt(segX*segX + segY*segY);
+		float left = length*(1 - progress);
+
+		if(remaining <= left || length == 0) {
+			float along = progress;
+			if(length > 0) {
+				along += remaining/length;
+			}
+			targetX = start.X + along*segX;
+			targetY = start.Y + along*segY;
+			break;
+		}
+		remaining -= left;
+		segment = NextIndex(segment);
+		progress = 0;
+		targetX = end.X;
+		targetY = end.Y;
+	}
+	*TargetX = targetX;
+	*TargetY = targetY;
+}
+
+// Returns the heading error to a target point in degrees, using the same
+// angle convention as Calculate in Drive
+static float HeadingError( KART_t myKart, float TargetX, float TargetY )
+{
+	// Heading vector is (-cos(theta), sin(theta))
+	float deltaX = TargetX - myKart.KartX;
+	float deltaY = TargetY - myKart.KartY;
+	float error = atan2(deltaY, -deltaX)*180/PI - myKart.KartTheta;
+
+	// Wrap to +-180
+	while(error > 180) {
+		error -= 360;
+	}
+	while(error < -180) {
+		error += 360;
+	}
+	return error;
+}
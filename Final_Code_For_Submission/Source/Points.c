@@ -1,77 +1,341 @@
+//#define TEST
+/****************************************************************************
+ Module
+	Points.c
+
+ Revision			Revised by:
+	0.1.1				Alex
+	0.1.2				Alex
+
+ Description
+	Map geometry, finds which section of the track a point is in
+
+ Edits:
+	0.1.1 - Range checks against the inner square and decision zones
+	0.1.2 - FindSection is a table lookup built once from the Points.h
+	        constants, with hysteresis at the section boundaries
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
 #include "Headers.h"
 
+/*----------------------------- Module Defines ----------------------------*/
+// DRS coordinates past the edge of the table are treated as the edge
+#define MAP_SIZE 256
+
+// Every coordinate the range checks compare against
+#define NUM_BREAKS 7
+// A value can be below, on, or above each break
+#define NUM_CLASSES (2*NUM_BREAKS + 1)
+
+// Decision zone overlays, set while the task is still to be done
+#define SDZ_FLAG BIT0HI
+#define ODZ_FLAG BIT1HI
+#define NUM_OVERLAYS 4
+
+// Pixels past a boundary before we believe we changed section
+#define SECTION_HYSTERESIS 3
+
+/*---------------------------- Module Functions ---------------------------*/
+static void BuildAxis( const uint16_t *Breaks, uint8_t *ClassTable, uint16_t *Representative );
+static MapSection StraightRules( POINT_t current );
+static MapSection LookupSection( uint16_t X, uint16_t Y, uint8_t Overlays );
+
+/*---------------------------- Module Variables ---------------------------*/
+static const uint16_t XBreaks[NUM_BREAKS] = {x1, x1+cornerSize, x2-cornerSize, x2, SDZ_X, ODZ_Xmin, ODZ_Xmax};
+static const uint16_t YBreaks[NUM_BREAKS] = {y1, y1+cornerSize, y2-cornerSize, y2, SDZ_Ymin, SDZ_Ymax, ODZ_Y};
+
+// Coordinate to interval class for each axis
+static uint8_t XClass[MAP_SIZE];
+static uint8_t YClass[MAP_SIZE];
+
+// Section for every combination of overlays and interval classes
+static uint8_t SectionTable[NUM_OVERLAYS][NUM_CLASSES][NUM_CLASSES];
+
+// Nothing is complete at the start of the race
+static uint8_t ActiveOverlays = SDZ_FLAG | ODZ_FLAG;
+static MapSection LastSection = DeadZone;
+
+/*------------------------------ Module Code ------------------------------*/
+
+/****************************************************************************
+ Function
+	InitMapSections
+
+ Parameters
+	none
+
+ Returns
+	none
+
+ Description
+	Builds the section lookup tables. Every coordinate between two breaks
+	gives the same answer from the range checks, so the checks only need to
+	be run once per cell.
+****************************************************************************/
+void InitMapSections( void )
+{
+	uint16_t xRepresentative[NUM_CLASSES];
+	uint16_t yRepresentative[NUM_CLASSES];
+
+	BuildAxis(XBreaks, XClass, xRepresentative);
+	BuildAxis(YBreaks, YClass, yRepresentative);
+
+	for(uint8_t i = 0; i < NUM_CLASSES; i++) {
+		for(uint8_t j = 0; j < NUM_CLASSES; j++) {
+			POINT_t cell = {xRepresentative[i], yRepresentative[j]};
+			uint8_t zones = 0;
+
+			if(cell.Y >= SDZ_Ymin && cell.Y <= SDZ_Ymax && cell.X <= SDZ_X) {
+				zones |= SDZ_FLAG;
+			}
+			if(cell.Y >= ODZ_Y && cell.X >= ODZ_Xmin && cell.X <= ODZ_Xmax) {
+				zones |= ODZ_FLAG;
+			}
+
+			// Shooting zone is checked before the obstacle zone
+			for(uint8_t overlays = 0; overlays < NUM_OVERLAYS; overlays++) {
+				if(zones & overlays & SDZ_FLAG) {
+					SectionTable[overlays][i][j] = ShootingDecisionZone;
+				}
+				else if(zones & overlays & ODZ_FLAG) {
+					SectionTable[overlays][i][j] = ObstacleDecisionZone;
+				}
+				else {
+					SectionTable[overlays][i][j] = StraightRules(cell);
+				}
+			}
+		}
+	}
+}
+
+/****************************************************************************
+ Function
+	SetSectionOverlays
+
+ Parameters
+	bool true once the shot has been made
+	bool true once the obstacle has been crossed
+
+ Returns
+	none
+
+ Description
+	Turns the decision zones off once their task is done, called by the DRS
+	whenever it updates our kart
+****************************************************************************/
+void SetSectionOverlays( bool ShotComplete, bool ObstacleComplete )
+{
+	uint8_t overlays = 0;
+
+	if(!ShotComplete) {
+		overlays |= SDZ_FLAG;
+	}
+	if(!ObstacleComplete) {
+		overlays |= ODZ_FLAG;
+	}
+	ActiveOverlays = overlays;
+}
+
+/****************************************************************************
+ Function
+	FindSection
+
+ Parameters
+	POINT_t position of the kart
+
+ Returns
+	MapSection the section of the map the kart is in
+
+ Description
+	Looks the position up in the section table. Stays in the previous section
+	until the kart is SECTION_HYSTERESIS pixels clear of it so the answer
+	doesn't chatter on a boundary.
+****************************************************************************/
+MapSection FindSection( POINT_t current )
+{
+	MapSection section = LookupSection(current.X, current.Y, ActiveOverlays);
+
+	if(section != LastSection) {
+		uint16_t left = (current.X > SECTION_HYSTERESIS) ? current.X - SECTION_HYSTERESIS : 0;
+		uint16_t down = (current.Y > SECTION_HYSTERESIS) ? current.Y - SECTION_HYSTERESIS : 0;
+
+		// Still within reach of the old section, keep it
+		if(LookupSection(left, current.Y, ActiveOverlays) == LastSection ||
+			 LookupSection(current.X + SECTION_HYSTERESIS, current.Y, ActiveOverlays) == LastSection ||
+			 LookupSection(current.X, down, ActiveOverlays) == LastSection ||
+			 LookupSection(current.X, current.Y + SECTION_HYSTERESIS, ActiveOverlays) == LastSection) {
+			section = LastSection;
+		}
+	}
+
+	LastSection = section;
+	return section;
+}
+
 // Find the straightway that the bot is currently on
-MapSection FindSection( POINT_t current ) {
-	
-	KART_t myKart;
-	myKart = QueryMyKart( );
-	
-	if(current.Y >= SDZ_Ymin && current.Y <= SDZ_Ymax && current.X <= SDZ_X && !myKart.ShotComplete) {
-		printf("In Shooting Decision Zone \r\n");
+MapSection FindNextSection( MapSection current ) {
+	printf("Next Section is ");
+	switch(current) {
+		case BottomStraight:
+			printf("Right Straight \r\n");
+			return RightStraight;
+		case RightStraight: 
+			printf("Top Straight \r\n");
+			return TopStraight;
+		case TopStraight:
+			printf("Left Straight \r\n");
+			return LeftStraight;
+		case LeftStraight:
+			printf("Bottom Straight \r\n");
+			return BottomStraight;	
+		default:
+			return DeadZone;
+	}
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+
+// Fills in the interval class of every coordinate on one axis, and the
+// first coordinate in each class to evaluate the range checks at
+static void BuildAxis( const uint16_t *Breaks, uint8_t *ClassTable, uint16_t *Representative )
+{
+	for(uint8_t i = 0; i < NUM_CLASSES; i++) {
+		Representative[i] = MAP_SIZE - 1;
+	}
+
+	for(uint16_t value = MAP_SIZE; value > 0; value--) {
+		uint16_t coord = value - 1;
+		uint8_t below = 0;
+		uint8_t on = 0;
+
+		// Count distinct breaks below this coordinate
+		for(uint8_t i = 0; i < NUM_BREAKS; i++) {
+			bool repeated = false;
+			for(uint8_t j = 0; j < i; j++) {
+				if(Breaks[j] == Breaks[i]) {
+					repeated = true;
+				}
+			}
+			if(!repeated && Breaks[i] < coord) {
+				below++;
+			}
+			if(Breaks[i] == coord) {
+				on = 1;
+			}
+		}
+
+		ClassTable[coord] = 2*below + on;
+		// Walking down so this ends up as the lowest coordinate in the class
+		Representative[2*below + on] = coord;
+	}
+}
+
+// Section from the inner square and corner regions, ignoring the decision zones
+static MapSection StraightRules( POINT_t current )
+{
+	if((current.Y >= y2 && current.X <= x2) || ((current.Y >= y2-cornerSize && current.Y <= y2) && (current.X >= x1 && current.X <= x1+cornerSize))) {
+		return BottomStraight;
+	}
+	else if((current.Y >= y1 && current.X >= x2) || ((current.Y >= y2-cornerSize && current.Y <= y2) && (current.X >= x2-cornerSize && current.X <= x2))) {
+		return RightStraight;
+	}
+	else if((current.Y <= y1 && current.X >= x1) || ((current.Y >= y1 && current.Y <= y1+cornerSize) && (current.X >= x2-cornerSize && current.X <= x2))) {
+		return TopStraight;
+	}
+	else if((current.Y <= y2 && current.X <= x1) || ((current.Y >= y1 && current.Y <= y1+cornerSize) && (current.X >= x1 && current.X <= x1+cornerSize))) {
+		return LeftStraight;
+	}
+	else if(current.Y >= y2 - cornerSize) {
+		return BottomStraight;
+	}
+	else if(current.X >= x2 - cornerSize) {
+		return RightStraight;
+	}
+	else if(current.Y <= y1 + cornerSize) {
+		return TopStraight;
+	}
+	else if(current.X <= x1 + cornerSize) {
+		return LeftStraight;
+	}
+	return DeadZone;
+}
+
+// Table lookup with no range checks, coordinates off the table use the edge
+static MapSection LookupSection( uint16_t X, uint16_t Y, uint8_t Overlays )
+{
+	X = (X < MAP_SIZE) ? X : MAP_SIZE - 1;
+	Y = (Y < MAP_SIZE) ? Y : MAP_SIZE - 1;
+	return (MapSection)SectionTable[Overlays][XClass[X]][YClass[Y]];
+}
+
+#ifdef TEST
+#include <stdio.h>
+
+// Original range checks, kept to check the table against
+static MapSection LegacyFindSection( POINT_t current, bool ShotComplete, bool ObstacleComplete )
+{
+	if(current.Y >= SDZ_Ymin && current.Y <= SDZ_Ymax && current.X <= SDZ_X && !ShotComplete) {
 		return ShootingDecisionZone;
 	}
-	// Obstacle Decision Zone
-	else if(current.Y >= ODZ_Y && current.X >= ODZ_Xmin && current.X <= ODZ_Xmax && !myKart.ObstacleComplete) {
-		printf("In Obstacle Decision Zone \r\n");
+	else if(current.Y >= ODZ_Y && current.X >= ODZ_Xmin && current.X <= ODZ_Xmax && !ObstacleComplete) {
 		return  ObstacleDecisionZone;
 	}
-	// Find section of map according to current location
 	else if((current.Y >= y2 && current.X <= x2) || ((current.Y >= y2-cornerSize && current.Y <= y2) && (current.X >= x1 && current.X <= x1+cornerSize))) {
-		printf("In Bottom Straight \r\n");
 		return BottomStraight;
 	}
 	else if((current.Y >= y1 && current.X >= x2) || ((current.Y >= y2-cornerSize && current.Y <= y2) && (current.X >= x2-cornerSize && current.X <= x2))) {
-		printf("In Right Straight \r\n");
 		return RightStraight;
 	}
 	else if((current.Y <= y1 && current.X >= x1) || ((current.Y >= y1 && current.Y <= y1+cornerSize) && (current.X >= x2-cornerSize && current.X <= x2))) {
-		printf("In Top Straight \r\n");
 		return TopStraight;
 	}
 	else if((current.Y <= y2 && current.X <= x1) || ((current.Y >= y1 && current.Y <= y1+cornerSize) && (current.X >= x1 && current.X <= x1+cornerSize))) {
-		printf("In Left Straight \r\n");
 		return LeftStraight;
 	}
 	else if(current.Y >= y2 - cornerSize) {
-		printf("In Bin \r\n");
 		return BottomStraight;
 	}
 	else if(current.X >= x2 - cornerSize) {
-		printf("In Rin \r\n");
 		return RightStraight;
 	}
 	else if(current.Y <= y1 + cornerSize) {
-		printf("In Tin \r\n");
 		return TopStraight;
 	}
 	else if(current.X <= x1 + cornerSize) {
-		printf("In Lin \r\n");
 		return LeftStraight;
 	}
-	else{
-			return DeadZone;
-	}
+	return DeadZone;
 }
 
-// Find the straightway that the bot is currently on
-MapSection FindNextSection( MapSection current ) {
-	printf("Next Section is ");
-	switch(current) {
-		case BottomStraight:
-			printf("Right Straight \r\n");
-			return RightStraight;
-		case RightStraight: 
-			printf("Top Straight \r\n");
-			return TopStraight;
-		case TopStraight:
-			printf("Left Straight \r\n");
-			return LeftStraight;
-		case LeftStraight:
-			printf("Bottom Straight \r\n");
-			return BottomStraight;	
-		default:
-			return DeadZone;
-	}
-}
+// Sweep every pixel of the field with every combination of completed tasks
+int main(void)
+{
+	uint32_t mismatches = 0;
+
+	InitMapSections();
 
+	for(uint8_t overlays = 0; overlays < NUM_OVERLAYS; overlays++) {
+		bool shotComplete = !(overlays & SDZ_FLAG);
+		bool obstacleComplete = !(overlays & ODZ_FLAG);
 
+		for(uint16_t x = 0; x < MAP_SIZE + 64; x++) {
+			for(uint16_t y = 0; y < MAP_SIZE + 64; y++) {
+				POINT_t point = {x, y};
+				MapSection expected = LegacyFindSection(point, shotComplete, obstacleComplete);
+				MapSection actual = LookupSection(x, y, overlays);
+				if(expected != actual) {
+					if(mismatches < 20) {
+						printf("Mismatch at %d %d overlays %d: expected %d got %d\n\r", x, y, overlays, expected, actual);
+					}
+					mismatches++;
+				}
+			}
+		}
+	}
+
+	printf("%s: %lu mismatches\n\r", (mismatches == 0) ? "PASS" : "FAIL", (unsigned long)mismatches);
+	return (mismatches != 0);
+}
+#endif
@@ -0,0 +1,127 @@
+/****************************************************************************
+ Module
+	RacingLine.c
+
+ Revision			Revised by:
+	0.1.1				Alex
+
+ Description
+	Lookups into the precomputed racing line. The table is generated offline
+	by Tools/racing_line.py into RacingLineTable.c. A position is turned into
+	a progress along its section by projecting onto the section's straight,
+	so a lookup is a dot product and an index with no searching.
+
+ Edits:
+	0.1.1 - Initial version for the path follower
+****************************************************************************/
+
+/*----------------------------- Include Files -----------------------------*/
+#include "Headers.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+
+/*---------------------------- Module Functions ---------------------------*/
+static int8_t SectionIndex( MapSection section );
+
+/*---------------------------- Module Variables ---------------------------*/
+
+/*------------------------------ Module Code ------------------------------*/
+
+/****************************************************************************
+ Function
+	RacingLineProgress
+
+ Parameters
+	MapSection section the kart is in
+	POINT_t current position of the kart
+	float * progress along the section (pixels)
+
+ Returns
+	bool false if the section is not on the racing line
+
+ Description
+	Projects the position onto the section's straight to find how far along
+	the section the kart is
+****************************************************************************/
+bool RacingLineProgress( MapSection section, POINT_t current, float *Progress )
+{
+	int8_t index = SectionIndex(section);
+	if(index < 0) {
+		return false;
+	}
+
+	const RACING_SECTION_t *line = &RacingLineSections[index];
+	float progress = (current.X - line->StartX)*line->DirX + (current.Y - line->StartY)*line->DirY;
+
+	// Keep the progress inside this section
+	if(progress < 0) {
+		progress = 0;
+	}
+	if(progress > line->Spacing*(RACING_LINE_SAMPLES - 1)) {
+		progress = line->Spacing*(RACING_LINE_SAMPLES - 1);
+	}
+	*Progress = progress;
+	return true;
+}
+
+/****************************************************************************
+ Function
+	QueryRacingLine
+
+ Parameters
+	MapSection section the kart is in
+	float progress along the section from RacingLineProgress (pixels)
+	float distance to look ahead of the progress (pixels)
+
+ Returns
+	const RACING_POINT_t * closest sample, NULL if the section is not on the line
+
+ Description
+	Returns the racing line sample Ahead pixels along the loop from the
+	given progress, carrying into the following sections as needed
+****************************************************************************/
+const RACING_POINT_t *QueryRacingLine( MapSection section, float Progress, float Ahead )
+{
+	int8_t index = SectionIndex(section);
+	if(index < 0) {
+		return NULL;
+	}
+
+	float distance = Progress + Ahead;
+
+	// Carry into the next section if we look past the end of this one
+	while(distance >= RacingLineSections[index].Spacing*RACING_LINE_SAMPLES) {
+		distance -= RacingLineSections[index].Spacing*RACING_LINE_SAMPLES;
+		index = (index + 1) % RACING_LINE_SECTIONS;
+	}
+
+	uint8_t sample = (uint8_t)(distance/RacingLineSections[index].Spacing + 0.5f);
+	if(sample >= RACING_LINE_SAMPLES) {
+		sample = 0;
+		index = (index + 1) % RACING_LINE_SECTIONS;
+	}
+	return &RacingLine[index][sample];
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+
+// Table index for a map section, the decision zones sit on the straights
+static int8_t SectionIndex( MapSection section )
+{
+	switch(section) {
+		case BottomStraight:
+		case ObstacleDecisionZone:
+			return 0;
+		case RightStraight:
+			return 1;
+		case TopStraight:
+			return 2;
+		case LeftStraight:
+		case ShootingDecisionZone:
+			return 3;
+		default:
+			return -1;
+	}
+}
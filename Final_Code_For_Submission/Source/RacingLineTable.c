@@ -0,0 +1,166 @@
+/****************************************************************************
+ Module
+	RacingLineTable.c
+
+ Description
+	Generated by Tools/racing_line.py from the Points.h waypoints, do not edit
+	by hand. Corner radius 30 px, max speed 1, lateral accel 18 px/s^2,
+	accel 150 px/s^2. Speeds assume the default speed calibration,
+	PIXELS_PER_3SEC_DEFAULT in PWM.h.
+****************************************************************************/
+
+#include "Headers.h"
+
+const RACING_SECTION_t RacingLineSections[RACING_LINE_SECTIONS] = {
+	// BottomStraight
+	{128.39f, 154.53f, 0.9986f, 0.0538f, 3.714f},
+	// RightStraight
+	{230.00f, 128.34f, 0.0000f, -1.0000f, 4.015f},
+	// TopStraight
+	{200.00f, 17.00f, -1.0000f, 0.0000f, 3.660f},
+	// LeftStraight
+	{100.00f, 47.00f, 0.0000f, 1.0000f, 3.846f},
+};
+
+const RACING_POINT_t RacingLine[RACING_LINE_SECTIONS][RACING_LINE_SAMPLES] = {
+	// BottomStraight
+	{
+		{128.39f, 154.53f, 176.9f, 0.00000f, 1.000f},
+		{132.10f, 154.73f, 176.9f, 0.00000f, 1.000f},
+		{135.80f, 154.93f, 176.9f, 0.00000f, 1.000f},
+		{139.51f, 155.13f, 176.9f, 0.00000f, 1.000f},
+		{143.22f, 155.33f, 176.9f, 0.00000f, 1.000f},
+		{146.93f, 155.53f, 176.9f, 0.00000f, 1.000f},
+		{150.64f, 155.73f, 176.9f, 0.00000f, 1.000f},
+		{154.35f, 155.93f, 176.9f, 0.00000f, 1.000f},
+		{158.05f, 156.13f, 176.9f, 0.00000f, 1.000f},
+		{161.76f, 156.33f, 176.9f, 0.00000f, 1.000f},
+		{165.47f, 156.53f, 176.9f, 0.00000f, 1.000f},
+		{169.18f, 156.73f, 176.9f, 0.00000f, 1.000f},
+		{172.89f, 156.92f, 176.9f, 0.00000f, 1.000f},
+		{176.60f, 157.12f, 176.9f, 0.00000f, 1.000f},
+		{180.30f, 157.32f, 176.9f, 0.00000f, 1.000f},
+		{184.01f, 157.52f, 176.9f, 0.00000f, 1.000f},
+		{187.72f, 157.72f, 176.9f, 0.00000f, 1.000f},
+		{191.43f, 157.92f, 176.9f, 0.00000f, 1.000f},
+		{195.14f, 158.12f, 176.9f, 0.00000f, 1.000f},
+		{198.85f, 158.32f, 177.8f, 0.03333f, 0.606f},
+		{202.56f, 158.23f, 184.9f, 0.03333f, 0.606f},
+		{206.23f, 157.69f, 192.0f, 0.03333f, 0.606f},
+		{209.80f, 156.69f, 199.1f, 0.03333f, 0.606f},
+		{213.23f, 155.27f, 206.2f, 0.03333f, 0.606f},
+		{216.45f, 153.43f, 213.3f, 0.03333f, 0.606f},
+		{219.42f, 151.20f, 220.4f, 0.03333f, 0.606f},
+		{222.10f, 148.63f, 227.4f, 0.03333f, 0.606f},
+		{224.43f, 145.75f, 234.5f, 0.03333f, 0.606f},
+		{226.40f, 142.60f, 241.6f, 0.03333f, 0.606f},
+		{227.95f, 139.23f, 248.7f, 0.03333f, 0.606f},
+		{229.09f, 135.69f, 255.8f, 0.03333f, 0.606f},
+		{229.77f, 132.05f, 262.9f, 0.03333f, 0.606f},
+	},
+	// RightStraight
+	{
+		{230.00f, 128.34f, 270.0f, 0.00000f, 1.000f},
+		{230.00f, 124.33f, 270.0f, 0.00000f, 1.000f},
+		{230.00f, 120.31f, 270.0f, 0.00000f, 1.000f},
+		{230.00f, 116.30f, 270.0f, 0.00000f, 1.000f},
+		{230.00f, 112.28f, 270.0f, 0.00000f, 1.000f},
+		{230.00f, 108.27f, 270.0f, 0.00000f, 1.000f},
+		{230.00f, 104.25f, 270.0f, 0.00000f, 1.000f},
+		{230.00f, 100.24f, 270.0f, 0.00000f, 1.000f},
+		{230.00f, 96.22f, 270.0f, 0.00000f, 1.000f},
+		{230.00f, 92.21f, 270.0f, 0.00000f, 1.000f},
+		{230.00f, 88.20f, 270.0f, 0.00000f, 1.000f},
+		{230.00f, 84.18f, 270.0f, 0.00000f, 1.000f},
+		{230.00f, 80.17f, 270.0f, 0.00000f, 1.000f},
+		{230.00f, 76.15f, 270.0f, 0.00000f, 1.000f},
+		{230.00f, 72.14f, 270.0f, 0.00000f, 1.000f},
+		{230.00f, 68.12f, 270.0f, 0.00000f, 1.000f},
+		{230.00f, 64.11f, 270.0f, 0.00000f, 1.000f},
+		{230.00f, 60.09f, 270.0f, 0.00000f, 1.000f},
+		{230.00f, 56.08f, 270.0f, 0.00000f, 1.000f},
+		{230.00f, 52.07f, 270.0f, 0.00000f, 1.000f},
+		{230.00f, 48.05f, 270.0f, 0.00000f, 1.000f},
+		{229.85f, 44.04f, 275.7f, 0.03333f, 0.606f},
+		{229.19f, 40.08f, 283.3f, 0.03333f, 0.606f},
+		{228.01f, 36.25f, 291.0f, 0.03333f, 0.606f},
+		{226.32f, 32.61f, 298.7f, 0.03333f, 0.606f},
+		{224.17f, 29.23f, 306.3f, 0.03333f, 0.606f},
+		{221.58f, 26.16f, 314.0f, 0.03333f, 0.606f},
+		{218.61f, 23.47f, 321.7f, 0.03333f, 0.606f},
+		{215.30f, 21.20f, 329.3f, 0.03333f, 0.606f},
+		{211.72f, 19.39f, 337.0f, 0.03333f, 0.606f},
+		{207.93f, 18.07f, 344.7f, 0.03333f, 0.606f},
+		{204.00f, 17.27f, 352.3f, 0.03333f, 0.606f},
+	},
+	// TopStraight
+	{
+		{200.00f, 17.00f, 0.0f, 0.00000f, 1.000f},
+		{196.34f, 17.00f, 0.0f, 0.00000f, 1.000f},
+		{192.68f, 17.00f, 0.0f, 0.00000f, 1.000f},
+		{189.02f, 17.00f, 0.0f, 0.00000f, 1.000f},
+		{185.36f, 17.00f, 0.0f, 0.00000f, 1.000f},
+		{181.70f, 17.00f, 0.0f, 0.00000f, 1.000f},
+		{178.04f, 17.00f, 0.0f, 0.00000f, 1.000f},
+		{174.38f, 17.00f, 0.0f, 0.00000f, 1.000f},
+		{170.72f, 17.00f, 0.0f, 0.00000f, 1.000f},
+		{167.06f, 17.00f, 0.0f, 0.00000f, 1.000f},
+		{163.40f, 17.00f, 0.0f, 0.00000f, 1.000f},
+		{159.74f, 17.00f, 0.0f, 0.00000f, 1.000f},
+		{156.08f, 17.00f, 0.0f, 0.00000f, 1.000f},
+		{152.42f, 17.00f, 0.0f, 0.00000f, 1.000f},
+		{148.76f, 17.00f, 0.0f, 0.00000f, 1.000f},
+		{145.10f, 17.00f, 0.0f, 0.00000f, 1.000f},
+		{141.44f, 17.00f, 0.0f, 0.00000f, 1.000f},
+		{137.78f, 17.00f, 0.0f, 0.00000f, 1.000f},
+		{134.12f, 17.00f, 0.0f, 0.00000f, 1.000f},
+		{130.46f, 17.00f, 0.0f, 0.00000f, 1.000f},
+		{126.80f, 17.17f, 6.1f, 0.03333f, 0.606f},
+		{123.20f, 17.78f, 13.1f, 0.03333f, 0.606f},
+		{119.69f, 18.83f, 20.1f, 0.03333f, 0.606f},
+		{116.34f, 20.29f, 27.1f, 0.03333f, 0.606f},
+		{113.19f, 22.15f, 34.1f, 0.03333f, 0.606f},
+		{110.29f, 24.38f, 41.1f, 0.03333f, 0.606f},
+		{107.69f, 26.95f, 48.1f, 0.03333f, 0.606f},
+		{105.41f, 29.81f, 55.0f, 0.03333f, 0.606f},
+		{103.50f, 32.93f, 62.0f, 0.03333f, 0.606f},
+		{101.99f, 36.26f, 69.0f, 0.03333f, 0.606f},
+		{100.89f, 39.75f, 76.0f, 0.03333f, 0.606f},
+		{100.22f, 43.35f, 83.0f, 0.03333f, 0.606f},
+	},
+	// LeftStraight
+	{
+		{100.00f, 47.00f, 90.0f, 0.00000f, 1.000f},
+		{100.00f, 50.85f, 90.0f, 0.00000f, 1.000f},
+		{100.00f, 54.69f, 90.0f, 0.00000f, 1.000f},
+		{100.00f, 58.54f, 90.0f, 0.00000f, 1.000f},
+		{100.00f, 62.39f, 90.0f, 0.00000f, 1.000f},
+		{100.00f, 66.23f, 90.0f, 0.00000f, 1.000f},
+		{100.00f, 70.08f, 90.0f, 0.00000f, 1.000f},
+		{100.00f, 73.92f, 90.0f, 0.00000f, 1.000f},
+		{100.00f, 77.77f, 90.0f, 0.00000f, 1.000f},
+		{100.00f, 81.62f, 90.0f, 0.00000f, 1.000f},
+		{100.00f, 85.46f, 90.0f, 0.00000f, 1.000f},
+		{100.00f, 89.31f, 90.0f, 0.00000f, 1.000f},
+		{100.00f, 93.16f, 90.0f, 0.00000f, 1.000f},
+		{100.00f, 97.00f, 90.0f, 0.00000f, 1.000f},
+		{100.00f, 100.85f, 90.0f, 0.00000f, 1.000f},
+		{100.00f, 104.69f, 90.0f, 0.00000f, 1.000f},
+		{100.00f, 108.54f, 90.0f, 0.00000f, 1.000f},
+		{100.00f, 112.39f, 90.0f, 0.00000f, 1.000f},
+		{100.00f, 116.23f, 90.0f, 0.00000f, 1.000f},
+		{100.00f, 120.08f, 90.0f, 0.00000f, 1.000f},
+		{100.00f, 123.93f, 90.0f, 0.00000f, 1.000f},
+		{100.17f, 127.77f, 96.1f, 0.03333f, 0.606f},
+		{100.82f, 131.55f, 103.5f, 0.03333f, 0.606f},
+		{101.96f, 135.23f, 110.8f, 0.03333f, 0.606f},
+		{103.55f, 138.73f, 118.2f, 0.03333f, 0.606f},
+		{105.58f, 141.99f, 125.5f, 0.03333f, 0.606f},
+		{108.00f, 144.97f, 132.8f, 0.03333f, 0.606f},
+		{110.79f, 147.62f, 140.2f, 0.03333f, 0.606f},
+		{113.90f, 149.88f, 147.5f, 0.03333f, 0.606f},
+		{117.26f, 151.73f, 154.9f, 0.03333f, 0.606f},
+		{120.84f, 153.14f, 162.2f, 0.03333f, 0.606f},
+		{124.57f, 154.08f, 169.6f, 0.03333f, 0.606f},
+	},
+};
@@ -9,6 +9,12 @@
 	0.2.2				Denny
 	0.2.3				Denny
 	0.3.0				Denny
+	0.3.1				Alex
+	0.3.2				Alex
+	0.3.3				Alex
+	0.3.4				Alex
+	0.3.5				Alex
+	0.3.6				Alex
 
  Description
 	SPI state machine service to communicate with the DrEd Reckoning system 
@@ -30,6 +36,20 @@
 	0.2.3 - Changed read of SPI data input to 16bit, then shifted >>8bits so we
 	get the actual input from the DRS, since the register fills in from MSB to LSB.
 	0.3.0 - Final code for grading
+	0.3.1 - Kart select is read from the background ADC samples instead of
+	a blocking conversion
+	0.3.2 - Posts KartUpdated with a pooled copy of our kart every time our
+	position is read, so the state machines don't have to query for it
+	0.3.3 - Game state changes and kart updates are published on the event bus
+	instead of posted to the Master
+	0.3.4 - Kart select thresholds come from the calibration store
+	0.3.5 - Kart number is set by the KartSelect self-test. The three karts
+	are kept in one table and parsed by the same code, so the smoothed
+	heading no longer lands in Kart3 when we are kart 1 or 2. Only DRS_TIMER
+	timeouts move the transfer along.
+	0.3.6 - The race state is followed from the DRS before KartSelect has
+	picked our KART, so a flag dropped during the self-test is still seen.
+	QueryGameStateRead says whether the karts' game states are real yet.
 
 ****************************************************************************/
 // If we are debugging and setting our own Game/KART states
@@ -40,7 +60,6 @@
    next lower level in the hierarchy that are sub-machines to this machine
 */
 #include "Headers.h"
-#include "ADMulti.h"
 
 
 /*----------------------------- Module Defines ----------------------------*/
@@ -70,6 +89,12 @@
 #define DRS_COMMAND_TIMEOUT 10		// Tick count for SendCommand timeout (10 ms)
 #define DRS_COMMAND_DELAY		10		// Tick count for 2ms delay between commands (3 ms)
 
+// Kart select voltage is sampled in the background with the other analog inputs
+#define ADC_SAMPLE_RATE			1000	// Samples per second
+
+// Kart number LEDs on F2-4
+#define KART_LEDS						(BIT2HI | BIT3HI | BIT4HI)
+
 
 /*---------------------------- Module Functions ---------------------------*/
 /* prototypes for private functions for this service.They should be functions
@@ -79,6 +104,10 @@ static bool DRSSendQuery ( void );
 static uint8_t DRSQuerySelect( void );
 static bool DRSSaveData ( void );
 static void CheckDRSEvents( void );
+static void PostKartUpdate( void );
+static uint8_t KartIndex( uint8_t Query );
+static void SaveGameState( KART_t *pKart, uint8_t State );
+static void SaveKartPose( KART_t *pKart );
 static ES_Event DuringDRS_Ready( ES_Event Event);
 static ES_Event DuringDRS_Transfer( ES_Event Event);
 static ES_Event DuringDRS_Wait( ES_Event Event);
@@ -93,15 +122,19 @@ static uint8_t CurrentQuery;				// Keep track of the current query
 static uint8_t LastQuery;						// Save the last query in case of transfer failure
 static bool EOTResponseFlag;				// Track if EOT interrupt occured
 
-static uint8_t MY_KART;							// Save our KART number
-static KART_t Kart1;								// Structure for KART1 (All KART information)
-static KART_t Kart2;								// Structure for KART2 (All KART information)
-static KART_t Kart3;								// Structure for KART3 (All KART information)
+static uint8_t MY_KART;							// Save our KART number, 0 until KartSelect sets it
+static KART_t Karts[NUM_KARTS];			// Every KART as the DRS reports it, KART1 first
+static bool GameStateRead;					// Karts[].GameState has come from the DRS
+static uint16_t SmoothedTheta;			// Our heading through the moving average
 static KART_t CurrentKartState;			// Structure to save our Kart (Current)
 static KART_t LastKartState;				// Structure to save our Kart (Last for event checkers)
 
 static uint16_t NewDRSRead[8]; 			// Array to save 8 byte response from DRS
-static uint32_t ADResults[4];				// Array to save the ADC results for MY_KART
+
+// Position query for each KART, indexed like Karts
+static const uint8_t KartQueries[NUM_KARTS] = { QUERY_KART1, QUERY_KART2, QUERY_KART3 };
+// LEDs lit for each KART
+static const uint32_t KartLEDs[NUM_KARTS] = { BIT4HI, BIT4HI | BIT3HI, BIT4HI | BIT3HI | BIT2HI };
 
 
 /*------------------------------ Module Code ------------------------------*/
@@ -220,8 +253,13 @@ void StartDRS( ES_Event CurrentEvent )
 	while ((HWREG(SYSCTL_PRGPIO) & SYSCTL_PRGPIO_R5 ) != SYSCTL_PRGPIO_R5 ) 
 		;
 	
-	// Initialize AD input
-	ADC_MultiInit(1);
+	// Start sampling the kart select voltage in the background
+	InitADCService(NUM_ADC_CHANNELS, ADC_SAMPLE_RATE);
+	MY_KART = 0;
+	for(uint8_t i = 0; i < NUM_KARTS; i++) {
+		Karts[i] = (KART_t){0};
+	}
+	GameStateRead = false;
 	
 	// Enable pins E5 and F2-4 for digital I/O
 	HWREG(GPIO_PORTE_BASE + GPIO_O_DEN) |= BIT5HI;
@@ -233,22 +271,7 @@ void StartDRS( ES_Event CurrentEvent )
 	HWREG(GPIO_PORTE_BASE + ALL_BITS) &= ~BIT5HI;
 	HWREG(GPIO_PORTF_BASE + ALL_BITS) &= ~(BIT2HI | BIT3HI| BIT4HI);
 	
-	// Read Kart# and illuminate appropriate pin
-	ADC_MultiRead(ADResults);
-	uint32_t kart = ADResults[0];
-	if (kart < 300) { 
-		HWREG(GPIO_PORTF_BASE + ALL_BITS) |= (BIT4HI | BIT3HI | BIT2HI);
-		MY_KART = 3;	
-	}else if (kart > 1100) {
-		HWREG(GPIO_PORTF_BASE + ALL_BITS) |= BIT4HI;
-		HWREG(GPIO_PORTF_BASE + ALL_BITS) &= ~(BIT3HI | BIT2HI);
-		MY_KART = 1;
-	}else {
-		HWREG(GPIO_PORTF_BASE + ALL_BITS) |= (BIT4HI | BIT3HI);
-		HWREG(GPIO_PORTF_BASE + ALL_BITS) &= ~BIT2HI;
-		MY_KART = 2;
-	}
-	printf("MY KART = %d\r\n", MY_KART);
+	// Kart# is set by the KartSelect self-test, see KartSelect.c
 	
 	// Set the CurrentState to Wait and start the wait timer
 	CurrentState = DRS_Wait;
@@ -345,6 +368,7 @@ ES_Event RunDRS ( ES_Event CurrentEvent )
 						{
 							// SaveData was successful, move to next state
 							CheckDRSEvents();
+							PostKartUpdate();
 							NextState = DRS_Wait;
 							MakeTransition = true;
 						}
@@ -365,7 +389,7 @@ ES_Event RunDRS ( ES_Event CurrentEvent )
 						// No EOT interrupt received, if EOTResponseFlag is false repeat last 
 						// query by setting current state to Wait and modifying CurentEvent to
 						// resend the failed query
-						if( EOTResponseFlag == false)
+						if( EOTResponseFlag == false && CurrentEvent.EventParam == DRS_TIMER)
 						{
 							printf("SPI Timeout: Retry sending previous query\r\n");
 							NextState = DRS_Wait;
@@ -391,6 +415,8 @@ ES_Event RunDRS ( ES_Event CurrentEvent )
 				switch ( CurrentEvent.EventType )
 				{
 					case ES_TIMEOUT : 
+							// Other machines' timers come through the Master too
+							if( CurrentEvent.EventParam != DRS_TIMER ) break;
 							// Delay of 3ms successful, set to Ready
 							NextState = DRS_Ready;
 							MakeTransition = true;
@@ -512,6 +538,92 @@ KART_t QueryMyKart ( void )
 	return CurrentKartState;
 }
 
+/****************************************************************************
+ Function
+	QueryMyKartNumber
+
+ Parameters
+   none
+
+ Returns
+   uint8_t
+
+ Description
+   Returns which KART (1-3) we were assigned
+****************************************************************************/
+uint8_t QueryMyKartNumber ( void )
+{
+	return MY_KART;
+}
+
+/****************************************************************************
+ Function
+	SetMyKartNumber
+
+ Parameters
+   uint8_t KART (1-3)
+
+ Returns
+   none
+
+ Description
+   Takes on the given KART number and lights its LEDs. Our heading average
+   is started again, it belonged to the last KART.
+****************************************************************************/
+void SetMyKartNumber ( uint8_t KartNumber )
+{
+	if(KartNumber < 1 || KartNumber > NUM_KARTS || KartNumber == MY_KART) {
+		return;
+	}
+	MY_KART = KartNumber;
+	clearThetas();
+	HWREG(GPIO_PORTF_BASE + ALL_BITS) &= ~KART_LEDS;
+	HWREG(GPIO_PORTF_BASE + ALL_BITS) |= KartLEDs[KartNumber - 1];
+	printf("MY KART = %d\r\n", MY_KART);
+}
+
+/****************************************************************************
+ Function
+	QueryKart
+
+ Parameters
+   uint8_t KART (1-3)
+
+ Returns
+   KART_t
+
+ Description
+   Returns any KART as last read from the DRS, without our heading
+   smoothing. All zero if there is no such KART or it hasn't been read.
+****************************************************************************/
+KART_t QueryKart ( uint8_t KartNumber )
+{
+	KART_t Kart = {0};
+	if(KartNumber >= 1 && KartNumber <= NUM_KARTS) {
+		Kart = Karts[KartNumber - 1];
+	}
+	return Kart;
+}
+
+/****************************************************************************
+ Function
+	QueryGameStateRead
+
+ Parameters
+   none
+
+ Returns
+   bool true once the DRS game state has been read
+
+ Description
+   Until then every KART's GameState is the zeroed DRS_WaitingForStart,
+   whatever the race is doing
+****************************************************************************/
+bool QueryGameStateRead ( void )
+{
+	return GameStateRead;
+}
+
 /***************************************************************************
  private functions
  ***************************************************************************/
@@ -626,164 +738,50 @@ static bool DRSSaveData ( void)
 		LastKartState = CurrentKartState;
 		
 		// Save the data read from the RS to the appropriate variables
-		switch(CurrentQuery)
+		if(CurrentQuery == QUERY_GAME_STATE)
 		{
-			case QUERY_GAME_STATE  :
+			// Bytes 3-5 are the state of KART1-3
+			for(uint8_t i = 0; i < NUM_KARTS; i++)
 			{
-				// Save the CurrentGameState for each of the KARTS
-				uint8_t Kart1State = NewDRSRead[3];
-				uint8_t Kart2State = NewDRSRead[4];
-				uint8_t Kart3State = NewDRSRead[5];
-		
-				// Cycle through GameState and pull GameState information for each KART
-				// Start by setting GameState
-				uint8_t Kart1GameState = ( (Kart1State & GAME_STATE_MASK)>>3);
-				switch( Kart1GameState )
-				{
-					case WAIT_FOR_START : Kart1.GameState = DRS_WaitingForStart; break;
-					case FLAG_DROPPED : 	Kart1.GameState = DRS_FlagDropped; break;
-					case CAUTION_FLAG : 	Kart1.GameState = DRS_CautionFlag; break;
-					case RACE_OVER : 			Kart1.GameState = DRS_RaceOver; break;
-				}
-				
-				uint8_t Kart2GameState = ( (Kart2State & GAME_STATE_MASK)>>3);
-				switch( Kart2GameState )
-				{
-					case WAIT_FOR_START : Kart2.GameState = DRS_WaitingForStart; break;
-					case FLAG_DROPPED : 	Kart2.GameState = DRS_FlagDropped; break;
-					case CAUTION_FLAG : 	Kart2.GameState = DRS_CautionFlag; break;
-					case RACE_OVER : 			Kart2.GameState = DRS_RaceOver; break;
-				}
-				
-				uint8_t Kart3GameState = ( (Kart3State & GAME_STATE_MASK)>>3);
-				switch( Kart3GameState )
-				{
-					case WAIT_FOR_START : Kart3.GameState = DRS_WaitingForStart; break;
-					case FLAG_DROPPED : 	Kart3.GameState = DRS_FlagDropped; break;
-					case CAUTION_FLAG : 	Kart3.GameState = DRS_CautionFlag; break;
-					case RACE_OVER : 			Kart3.GameState = DRS_RaceOver; break;
-				}
-			
-				// Then set number of laps remaining 
-				Kart1.LapsRemaining = (Kart1State & LAPS_REMAINING_MASK);
-				Kart2.LapsRemaining = (Kart2State & LAPS_REMAINING_MASK);
-				Kart3.LapsRemaining = (Kart3State & LAPS_REMAINING_MASK);
-						
-				// Then check if our robot has sucessfully made a shot into the bucket
-				if( (Kart1State & SHOT_COMPLETE) == SHOT_COMPLETE ) Kart1.ShotComplete = true;
-				else Kart1.ShotComplete = false;
-				
-				if( (Kart2State & SHOT_COMPLETE) == SHOT_COMPLETE ) Kart2.ShotComplete = true;
-				else Kart2.ShotComplete = false;
-				
-				if( (Kart3State & SHOT_COMPLETE) == SHOT_COMPLETE ) Kart3.ShotComplete = true;
-				else Kart3.ShotComplete = false;
-				
-				// Finally check if sea-saw has been succesfully navigated
-				if( (Kart1State & OBSTICAL_COMPLETE) == OBSTICAL_COMPLETE ) Kart1.ObstacleComplete = true;
-				else Kart1.ObstacleComplete = false;
-				
-				if( (Kart2State & OBSTICAL_COMPLETE) == OBSTICAL_COMPLETE ) Kart2.ObstacleComplete = true;
-				else Kart2.ObstacleComplete = false;
-				
-				if( (Kart3State & OBSTICAL_COMPLETE) == OBSTICAL_COMPLETE ) Kart3.ObstacleComplete = true;
-				else Kart3.ObstacleComplete = false;
-
-				break;
-			}
-			
-			case QUERY_KART1 : 
-			{
-				// Save the position of KART1
-				Kart1.KartX = ((NewDRSRead[2]<<8) + NewDRSRead[3]);
-				Kart1.KartY = ((NewDRSRead[4]<<8) + NewDRSRead[5]);
-				
-				// Save the orientation of KART1
-				// Check if KartTheta is a negative number first
-				if( NewDRSRead[6] == 0xff ) 
-				{
-					// Find the two's complement of the LSB, and 
-					uint8_t BitFlip = ~NewDRSRead[7];
-					BitFlip += 1;
-					
-					// Subtract that from 360 to get theta (0-359)
-					Kart1.KartTheta = 360 - BitFlip;
-				}
-				else Kart1.KartTheta = (NewDRSRead[7]);
-				
-				// Add this angle for smoothing if we are KART1
-				if(MY_KART == 1){
-					addAngleEntry(Kart1.KartTheta);
-					Kart3.KartTheta = getDesiredTheta();
-				}
-			
-				break;
+				SaveGameState(&Karts[i], NewDRSRead[3 + i]);
 			}
-			
-			case QUERY_KART2 :
+			GameStateRead = true;
+		}
+		else
+		{
+			uint8_t Index = KartIndex(CurrentQuery);
+			if(Index < NUM_KARTS)
 			{
-				// Save the position and orientation of KART1
-				// Cycle through NewDRSRead and pull KART1 information
-				Kart2.KartX = ((NewDRSRead[2]<<8) + NewDRSRead[3]);
-				Kart2.KartY = ((NewDRSRead[4]<<8) + NewDRSRead[5]);
-				
-				// Save the orientation of KART2
-				// Check if KartTheta is a negative number first
-				if( NewDRSRead[6] == 0xff ) 
-				{
-					// Find the two's complement of the LSB, and 
-					uint8_t BitFlip = ~NewDRSRead[7];
-					BitFlip += 1;
-					
-					// Subtract that from 360 to get theta (0-359)
-					Kart2.KartTheta = 360 - BitFlip;
-				}
-				else Kart2.KartTheta = (NewDRSRead[7]);
-				
-				// Add this angle for smoothing if we are KART2
-				if(MY_KART == 2){
-					addAngleEntry(Kart2.KartTheta);
-					Kart3.KartTheta = getDesiredTheta();
-				}
+				SaveKartPose(&Karts[Index]);
 				
-				break;
-			}
-			
-			case QUERY_KART3 :
-			{
-				// Save the position and orientation of KART1
-				// Cycle through NewDRSRead and pull KART1 information
-				Kart3.KartX = ((NewDRSRead[2]<<8) + NewDRSRead[3]);
-				Kart3.KartY = ((NewDRSRead[4]<<8) + NewDRSRead[5]);
+				// Update the velocity track for this kart
+				UpdateOpponent(Index + 1, Karts[Index].KartX, Karts[Index].KartY);
 				
-				// Save the orientation of KART2
-				// Check if KartTheta is a negative number first
-				if( NewDRSRead[6] == 0xff ) 
+				// Add this angle for smoothing if this is our KART
+				if(Index + 1 == MY_KART)
 				{
-					// Find the two's complement of the LSB, and 
-					uint8_t BitFlip = ~NewDRSRead[7];
-					BitFlip += 1;
-					
-					// Subtract that from 360 to get theta (0-359)
-					Kart3.KartTheta = 360 - BitFlip;
+					addAngleEntry(Karts[Index].KartTheta);
+					SmoothedTheta = getDesiredTheta();
 				}
-				else Kart3.KartTheta = (NewDRSRead[7]);
-				
-				// Add this angle for smoothing if we are KART3
-				if(MY_KART == 3){
-					addAngleEntry(Kart3.KartTheta);
-					Kart3.KartTheta = getDesiredTheta();
-				}
-				
-				break;
 			}
 		}
 	}
 	
 	// SaveCurrentKartState and LastCurrentState
-	if(MY_KART == 1) CurrentKartState = Kart1;
-	else if(MY_KART == 2) CurrentKartState = Kart2;
-	else if(MY_KART == 3) CurrentKartState = Kart3;
+	if(MY_KART != 0)
+	{
+		CurrentKartState = Karts[MY_KART - 1];
+		CurrentKartState.KartTheta = SmoothedTheta;
+	}
+	else
+	{
+		// Until we know which KART we are follow the race from KART1, the
+		// DRS gives every KART the same flag until one finishes
+		CurrentKartState.GameState = Karts[0].GameState;
+	}
+	
+	// Turn off the decision zones for tasks we have finished
+	SetSectionOverlays(CurrentKartState.ShotComplete, CurrentKartState.ObstacleComplete);
 	
 	// Print our KART information for debugging
 	//printf("MYKART: %d KARTX: %d KARTY: %d DRSTheta: %d KARTTheta: %d\r\n", MY_KART, CurrentKartState.KartX, CurrentKartState.KartY, CurrentKartState.KartTheta, QueryTheta());
@@ -792,6 +790,41 @@ static bool DRSSaveData ( void)
 }
 
 
+/****************************************************************************
+ Function
+   PostKartUpdate
+
+ Parameters
+   none
+
+ Returns
+   none
+
+ Description
+   Posts KartUpdated with a copy of our kart in the event pool if the read
+   that was just saved was our position
+****************************************************************************/
+static void PostKartUpdate( void )
+{
+	if( MY_KART == 0 || KartIndex(CurrentQuery) != MY_KART - 1 )
+	{
+		return;
+	}
+	
+	KART_t *pKart;
+	uint16_t Handle = ES_EventPool_Alloc(sizeof(KART_t), (void **)&pKart);
+	if( Handle == ES_NO_PAYLOAD )
+	{
+		// Pool is empty, the machines still have QueryMyKart
+		return;
+	}
+	*pKart = CurrentKartState;
+	ES_Event NewEvent = {KartUpdated, Handle};
+	ES_EventBus_Publish(NewEvent);
+	// The subscribers' queues hold it now
+	ES_EventPool_Release(Handle);
+}
+
 /****************************************************************************
  Function
    CheckDRSEvents
@@ -809,14 +842,14 @@ static void CheckDRSEvents( void )
 {
 	if(CurrentKartState.GameState != LastKartState.GameState)
 	{
-		ES_Event NewEvent;
+		ES_Event NewEvent = {ES_NO_EVENT, 0};
 		if(CurrentKartState.GameState == DRS_FlagDropped)
 		{
 			//printf("Flag Dropped!\r\n");
 			NewEvent.EventType = FlagDropped;
 			// Set GameState LED
 			HWREG(GPIO_PORTE_BASE + ALL_BITS) |= BIT5HI;
-			PostMaster(NewEvent);
+			ES_EventBus_Publish(NewEvent);
 		}
 		else if(CurrentKartState.GameState == DRS_CautionFlag)
 		{
@@ -824,7 +857,7 @@ static void CheckDRSEvents( void )
 			NewEvent.EventType = CautionFlagDropped;
 			// Set GameState LED
 			HWREG(GPIO_PORTE_BASE + ALL_BITS) &= ~BIT5HI;
-			PostMaster(NewEvent);
+			ES_EventBus_Publish(NewEvent);
 		}
 		else if(CurrentKartState.GameState == DRS_RaceOver)
 		{
@@ -832,7 +865,7 @@ static void CheckDRSEvents( void )
 			NewEvent.EventType = GameOver;
 			// Set GameState LED
 			HWREG(GPIO_PORTE_BASE + ALL_BITS) &= ~BIT5HI;
-			PostMaster(NewEvent);
+			ES_EventBus_Publish(NewEvent);
 		}
 		else if(CurrentKartState.GameState == DRS_WaitingForStart)
 		{
@@ -840,12 +873,101 @@ static void CheckDRSEvents( void )
 			// Set GameState LED
 			HWREG(GPIO_PORTE_BASE + ALL_BITS) &= ~BIT5HI;
 			//NewEvent.EventType = WaitForStart;
-			PostMaster(NewEvent);
 		}
 	}
 }
 
 
+/****************************************************************************
+ Function
+   KartIndex
+
+ Parameters
+   uint8_t query sent to the DRS
+
+ Returns
+   uint8_t index into Karts, NUM_KARTS if it isn't a KART query
+
+ Description
+  Finds which KART a position query was for
+****************************************************************************/
+static uint8_t KartIndex( uint8_t Query )
+{
+	uint8_t Index = 0;
+	while(Index < NUM_KARTS && KartQueries[Index] != Query)
+	{
+		Index++;
+	}
+	return Index;
+}
+
+/****************************************************************************
+ Function
+   SaveGameState
+
+ Parameters
+   KART_t * KART to save into
+   uint8_t that KART's byte of the game state response
+
+ Returns
+   none
+
+ Description
+  Pulls the game state, laps remaining and finished tasks for one KART
+****************************************************************************/
+static void SaveGameState( KART_t *pKart, uint8_t State )
+{
+	// Start by setting GameState
+	switch( (State & GAME_STATE_MASK)>>3 )
+	{
+		case WAIT_FOR_START : pKart->GameState = DRS_WaitingForStart; break;
+		case FLAG_DROPPED : 	pKart->GameState = DRS_FlagDropped; break;
+		case CAUTION_FLAG : 	pKart->GameState = DRS_CautionFlag; break;
+		case RACE_OVER : 			pKart->GameState = DRS_RaceOver; break;
+	}
+	
+	// Then set number of laps remaining 
+	pKart->LapsRemaining = (State & LAPS_REMAINING_MASK);
+	
+	// Then check if the robot has sucessfully made a shot into the bucket
+	pKart->ShotComplete = ((State & SHOT_COMPLETE) == SHOT_COMPLETE);
+	
+	// Finally check if sea-saw has been succesfully navigated
+	pKart->ObstacleComplete = ((State & OBSTICAL_COMPLETE) == OBSTICAL_COMPLETE);
+}
+
+/****************************************************************************
+ Function
+   SaveKartPose
+
+ Parameters
+   KART_t * KART the position query was for
+
+ Returns
+   none
+
+ Description
+  Pulls the position and orientation out of a KART query response
+****************************************************************************/
+static void SaveKartPose( KART_t *pKart )
+{
+	pKart->KartX = ((NewDRSRead[2]<<8) + NewDRSRead[3]);
+	pKart->KartY = ((NewDRSRead[4]<<8) + NewDRSRead[5]);
+	
+	// Check if KartTheta is a negative number first
+	if( NewDRSRead[6] == 0xff ) 
+	{
+		// Find the two's complement of the LSB, and 
+		uint8_t BitFlip = ~NewDRSRead[7];
+		BitFlip += 1;
+		
+		// Subtract that from 360 to get theta (0-359)
+		pKart->KartTheta = 360 - BitFlip;
+	}
+	else pKart->KartTheta = (NewDRSRead[7]);
+}
+
+
 /****************************************************************************
  Function
    DuringDRS_Ready
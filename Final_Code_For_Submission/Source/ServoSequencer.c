@@ -0,0 +1,375 @@
+/****************************************************************************
+ Module
+	ServoSequencer.c
+
+ Revision			Revised by:
+	0.1.1				Alex
+	0.1.2				Alex
+
+ Description
+	Plays keyframe tracks on the servo channels without blocking. Each
+	keyframe moves a servo to a pulse width over a duration, and the width is
+	stepped once per 20 ms servo period on SERVO_TIMER so the move is
+	smooth. A keyframe that goes to the width the servo is already at is a
+	wait. Every servo channel has its own track so several servos move at
+	once.
+
+	A track can be armed, which plays all but its last keyframe and holds.
+	Triggering it then only has to play the last keyframe. A trigger that
+	comes in while the track is still arming is kept and played as soon as
+	the hold is reached.
+
+	A channel can be interlocked on another one. A triggered track then
+	stays at its hold until the other channel has stopped moving.
+
+	ServoSequenceDone is posted with the channel in EventParam when a track
+	reaches its hold and when it finishes.
+
+ Edits:
+	0.1.1 - Initial version for the ball shooter
+	0.1.2 - Interlock so a trigger waits for another servo to stop
+****************************************************************************/
+
+/*----------------------------- Include Files -----------------------------*/
+#include "Headers.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+// Servo channels on the PWM module, 2 is the flicker and 3 the hopper
+#define FIRST_SERVO_CHANNEL 2
+#define NUM_SERVOS 2
+#define NO_INTERLOCK 0xFF
+
+typedef enum { TrackIdle, TrackPlaying, TrackHolding } TrackState_t;
+
+// Playback state for one servo channel
+typedef struct {
+			TrackState_t							State;
+			const SERVO_KEYFRAME_t		*Frames;
+			uint8_t										NumFrames;
+			uint8_t										Frame;					// Keyframe being played
+			uint8_t										HoldFrame;			// Stop before this keyframe, NumFrames if none
+			bool											Triggered;			// Play past the hold once it is reached
+			uint8_t										Interlock;			// Channel that must be still before passing the hold
+			uint16_t									StartWidth;			// Width at the start of this keyframe
+			uint16_t									Width;					// Width last sent to the servo
+			uint16_t									Elapsed;				// Time into this keyframe
+} SERVO_TRACK_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+static SERVO_TRACK_t *FindTrack( uint8_t Channel );
+static void StartTrack( SERVO_TRACK_t *track, const SERVO_KEYFRAME_t *Frames, uint8_t NumFrames, uint8_t HoldFrame );
+static void StepTrack( SERVO_TRACK_t *track, uint8_t Channel );
+static void BeginFrame( SERVO_TRACK_t *track, uint8_t Channel );
+static void PostTrackDone( uint8_t Channel );
+static bool Blocked( SERVO_TRACK_t *track );
+static void ReleaseInterlocks( uint8_t Channel );
+
+/*---------------------------- Module Variables ---------------------------*/
+static SERVO_TRACK_t Tracks[NUM_SERVOS];
+static bool TimerRunning = false;
+
+/*------------------------------ Module Code ------------------------------*/
+
+/****************************************************************************
+ Function
+	InitServoSequencer
+
+ Parameters
+	none
+
+ Returns
+	none
+
+ Description
+	Clears all tracks
+****************************************************************************/
+void InitServoSequencer( void )
+{
+	for(uint8_t i = 0; i < NUM_SERVOS; i++) {
+		Tracks[i].State = TrackIdle;
+		Tracks[i].Width = 0;
+		Tracks[i].Interlock = NO_INTERLOCK;
+	}
+	TimerRunning = false;
+}
+
+/****************************************************************************
+ Function
+	PlayServoTrack
+
+ Parameters
+	uint8_t servo channel
+	const SERVO_KEYFRAME_t * keyframes, must stay valid while playing
+	uint8_t number of keyframes
+
+ Returns
+	bool false if the channel is not a servo
+
+ Description
+	Starts playing the whole track, replacing anything already playing on
+	the channel
+****************************************************************************/
+bool PlayServoTrack( uint8_t Channel, const SERVO_KEYFRAME_t *Frames, uint8_t NumFrames )
+{
+	SERVO_TRACK_t *track = FindTrack(Channel);
+	if(track == NULL || NumFrames == 0) {
+		return false;
+	}
+	StartTrack(track, Frames, NumFrames, NumFrames);
+	BeginFrame(track, Channel);
+	return true;
+}
+
+/****************************************************************************
+ Function
+	ArmServoTrack
+
+ Parameters
+	uint8_t servo channel
+	const SERVO_KEYFRAME_t * keyframes, must stay valid while playing
+	uint8_t number of keyframes
+
+ Returns
+	bool false if the channel is not a servo
+
+ Description
+	Plays every keyframe but the last and holds until TriggerServoTrack
+****************************************************************************/
+bool ArmServoTrack( uint8_t Channel, const SERVO_KEYFRAME_t *Frames, uint8_t NumFrames )
+{
+	SERVO_TRACK_t *track = FindTrack(Channel);
+	if(track == NULL || NumFrames == 0) {
+		return false;
+	}
+	StartTrack(track, Frames, NumFrames, NumFrames - 1);
+	BeginFrame(track, Channel);
+	return true;
+}
+
+/****************************************************************************
+ Function
+	TriggerServoTrack
+
+ Parameters
+	uint8_t servo channel
+
+ Returns
+	bool false if there is no armed track on the channel
+
+ Description
+	Plays the last keyframe of an armed track, straight away if it is
+	holding or as soon as it gets to the hold
+****************************************************************************/
+bool TriggerServoTrack( uint8_t Channel )
+{
+	SERVO_TRACK_t *track = FindTrack(Channel);
+	if(track == NULL || track->State == TrackIdle || track->HoldFrame >= track->NumFrames) {
+		return false;
+	}
+
+	track->Triggered = true;
+	if(track->State == TrackHolding && !Blocked(track)) {
+		track->State = TrackPlaying;
+		BeginFrame(track, Channel);
+	}
+	return true;
+}
+
+/****************************************************************************
+ Function
+	SetServoInterlock
+
+ Parameters
+	uint8_t servo channel to hold back
+	uint8_t servo channel it waits for, or a non-servo channel to clear
+
+ Returns
+	none
+
+ Description
+	Keeps a triggered track at its hold while the other servo is moving
+****************************************************************************/
+void SetServoInterlock( uint8_t Channel, uint8_t BlockingChannel )
+{
+	SERVO_TRACK_t *track = FindTrack(Channel);
+	if(track == NULL) {
+		return;
+	}
+	if(FindTrack(BlockingChannel) == NULL || BlockingChannel == Channel) {
+		track->Interlock = NO_INTERLOCK;
+	}
+	else {
+		track->Interlock = BlockingChannel;
+	}
+}
+
+/****************************************************************************
+ Function
+	QueryServoTrack
+
+ Parameters
+	uint8_t servo channel
+
+ Returns
+	bool true if the channel is still moving toward its hold or end
+
+ Description
+	Holding and finished tracks are not busy
+****************************************************************************/
+bool QueryServoTrack( uint8_t Channel )
+{
+	SERVO_TRACK_t *track = FindTrack(Channel);
+	return (track != NULL && track->State == TrackPlaying);
+}
+
+/****************************************************************************
+ Function
+	RunServoSequencer
+
+ Parameters
+	ES_Event : the event to process
+
+ Returns
+	ES_Event, ES_NO_EVENT
+
+ Description
+	Steps every playing track on each SERVO_TIMER timeout
+****************************************************************************/
+ES_Event RunServoSequencer( ES_Event ThisEvent )
+{
+	ES_Event ReturnEvent = {ES_NO_EVENT};
+
+	if(ThisEvent.EventType == ES_TIMEOUT && ThisEvent.EventParam == SERVO_TIMER) {
+		TimerRunning = false;
+		for(uint8_t i = 0; i < NUM_SERVOS; i++) {
+			if(Tracks[i].State == TrackPlaying) {
+				StepTrack(&Tracks[i], FIRST_SERVO_CHANNEL + i);
+			}
+		}
+
+		// Keep ticking while anything is moving
+		for(uint8_t i = 0; i < NUM_SERVOS; i++) {
+			if(Tracks[i].State == TrackPlaying && !TimerRunning) {
+				ES_Timer_InitTimer(SERVO_TIMER,SERVO_TICK);
+				TimerRunning = true;
+			}
+		}
+	}
+	return ReturnEvent;
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+
+// Track for a servo channel, NULL if it is not a servo
+static SERVO_TRACK_t *FindTrack( uint8_t Channel )
+{
+	if(Channel < FIRST_SERVO_CHANNEL || Channel >= FIRST_SERVO_CHANNEL + NUM_SERVOS) {
+		return NULL;
+	}
+	return &Tracks[Channel - FIRST_SERVO_CHANNEL];
+}
+
+// Loads a track to play from its first keyframe
+static void StartTrack( SERVO_TRACK_t *track, const SERVO_KEYFRAME_t *Frames, uint8_t NumFrames, uint8_t HoldFrame )
+{
+	track->Frames = Frames;
+	track->NumFrames = NumFrames;
+	track->HoldFrame = HoldFrame;
+	track->Frame = 0;
+	track->Triggered = false;
+	track->State = TrackPlaying;
+}
+
+// Starts the current keyframe, or holds or finishes the track
+static void BeginFrame( SERVO_TRACK_t *track, uint8_t Channel )
+{
+	// Wait at the hold until triggered and clear of the interlock
+	if(track->Frame == track->HoldFrame && (!track->Triggered || Blocked(track))) {
+		track->State = TrackHolding;
+		// A blocked trigger isn't news to the owner, it asked to fire
+		if(!track->Triggered) {
+			PostTrackDone(Channel);
+		}
+		ReleaseInterlocks(Channel);
+		return;
+	}
+	if(track->Frame >= track->NumFrames) {
+		track->State = TrackIdle;
+		PostTrackDone(Channel);
+		ReleaseInterlocks(Channel);
+		return;
+	}
+
+	const SERVO_KEYFRAME_t *frame = &track->Frames[track->Frame];
+	track->Elapsed = 0;
+
+	// Unknown position or no time to move, jump straight there
+	if(track->Width == 0 || frame->Duration == 0) {
+		track->Width = frame->Width;
+		SetPWMWidth(track->Width, Channel);
+	}
+	track->StartWidth = track->Width;
+
+	if(frame->Duration == 0) {
+		track->Frame++;
+		BeginFrame(track, Channel);
+		return;
+	}
+
+	if(!TimerRunning) {
+		ES_Timer_InitTimer(SERVO_TIMER,SERVO_TICK);
+		TimerRunning = true;
+	}
+}
+
+// Moves a track one servo period along its keyframe
+static void StepTrack( SERVO_TRACK_t *track, uint8_t Channel )
+{
+	const SERVO_KEYFRAME_t *frame = &track->Frames[track->Frame];
+	track->Elapsed += SERVO_TICK;
+
+	if(track->Elapsed >= frame->Duration) {
+		track->Width = frame->Width;
+		SetPWMWidth(track->Width, Channel);
+		track->Frame++;
+		BeginFrame(track, Channel);
+		return;
+	}
+
+	// Linear move from the start width to the keyframe width
+	int32_t change = (int32_t)frame->Width - track->StartWidth;
+	uint16_t width = track->StartWidth + change*track->Elapsed/frame->Duration;
+	if(width != track->Width) {
+		track->Width = width;
+		SetPWMWidth(track->Width, Channel);
+	}
+}
+
+// True if the track's interlock channel is still moving
+static bool Blocked( SERVO_TRACK_t *track )
+{
+	SERVO_TRACK_t *blocking = FindTrack(track->Interlock);
+	return (blocking != NULL && blocking->State == TrackPlaying);
+}
+
+// Lets triggered tracks waiting on a channel go now that it has stopped
+static void ReleaseInterlocks( uint8_t Channel )
+{
+	for(uint8_t i = 0; i < NUM_SERVOS; i++) {
+		SERVO_TRACK_t *track = &Tracks[i];
+		if(track->Interlock == Channel && track->State == TrackHolding &&
+		   track->Triggered && !Blocked(track)) {
+			track->State = TrackPlaying;
+			BeginFrame(track, FIRST_SERVO_CHANNEL + i);
+		}
+	}
+}
+
+// Lets the owner of the channel know its track has stopped
+static void PostTrackDone( uint8_t Channel )
+{
+	ES_Event newEvent = {ServoSequenceDone, Channel};
+	PostMaster(newEvent);
+}
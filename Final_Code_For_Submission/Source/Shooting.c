@@ -6,6 +6,12 @@
 	0.1.1				Alex
 	0.2.1				Alex
 	0.3.1				Alex
+	0.3.2				Alex
+	0.3.3				Alex
+	0.3.4				Alex
+	0.4.1				Alex
+	0.4.2				Alex
+	0.4.3				Alex
 
  Description
 	Driving state machine that controls the shooting
@@ -14,36 +20,43 @@
 	0.1.1 - Set up as template
 	0.2.1 - Make change to have only one beacon sensor
 	0.3.1 - Include driving to final point as part of shooting module
+	0.3.2 - Beacon capture moved to BeaconDetector.c, turn back to the center
+	        of the beacon before firing
+	0.3.3 - DetectedBeacon carries the beacon band as well as the time
+	0.3.4 - Steers onto the tape on the way back from the shooting point
+	0.4.1 - Plans one turn and drive to the closest legal firing pose and
+	        turns to face the beacon, replacing the orient and creep steps
+	0.4.2 - Waits for the whole burst to be fired, the fire timer is a
+	        backstop
+	0.4.3 - The backstop allows for a burst that starts while the shooter
+	        is still arming
 ****************************************************************************/
 /*----------------------------- Include Files -----------------------------*/
 #include "Headers.h"
 
 /*----------------------------- Module Defines ----------------------------*/
 #define LOAD_TIME ONE_SEC
-#define FIRE_TIME ONE_SEC
-#define BEACON_LOW (30000)
-#define BEACON_HIGH (33000)
-#define X_CheckTime 100
+// Backstop past the longest a burst can take, in case BallsFired never comes
+#define FIRE_MARGIN (ONE_SEC/2)
+
+// Speed back to the tape as a fraction of half speed
+#define RETURN_SPEED 1.0f
 
 /*---------------------------- Module Functions ---------------------------*/
-static ES_Event DuringOrientState( ES_Event Event );
-static ES_Event DuringFindYState( ES_Event Event );
-static ES_Event DuringShootingTurningState( ES_Event Event );
-static ES_Event DuringFindXState( ES_Event Event );
+static ES_Event DuringPlanShotState( ES_Event Event );
+static ES_Event DuringShotTurningState( ES_Event Event );
+static ES_Event DuringShotDrivingState( ES_Event Event );
+static ES_Event DuringAimState( ES_Event Event );
 static ES_Event DuringFindBeaconState( ES_Event Event );
 static ES_Event DuringFireState( ES_Event Event );
 static ES_Event DuringReturnToTapeState( ES_Event Event );
-void BeaconCaptureResponse( void );
-bool FindBeacon (void);
 
 /*---------------------------- Module Variables ---------------------------*/
 static ShootingState CurrentState;
-static uint32_t LastCapture;
-static uint32_t BeaconPeriod;
 POINT_t currentPoint_Shooting;
 KART_t myKart_Shooting;
-POINT_t ShootingPoint_Shooting = {SP_X,SP_Y};
-static bool SearchBeacon = false;
+static SHOT_PLAN_t ShotPlan;
+static bool CenteringOnBeacon = false;
 
 /*------------------------------ Module Code ------------------------------*/
 
@@ -58,11 +71,17 @@ static bool SearchBeacon = false;
    None
 
  Description
-   Starts in orient state
+   Plans the shot, starts by driving to the firing pose unless we are
+   already in the firing zone
 ****************************************************************************/
 void StartShooting ( ES_Event CurrentEvent )
 {
-	CurrentState = OrientState;
+	if(PlanShot(QueryMyKart( ), &ShotPlan)) {
+		CurrentState = PlanShotState;
+	}
+	else {
+		CurrentState = AimState;
+	}
 
 	// Call the entry function (if any) for the ENTRY_STATE
 	RunShooting(CurrentEvent);
@@ -94,103 +113,74 @@ ES_Event RunShooting( ES_Event CurrentEvent )
 
 	switch ( CurrentState )
 	{
-		case OrientState :
+		case PlanShotState :
 			// Execute during function
-			CurrentEvent = DuringOrientState(CurrentEvent);
+			CurrentEvent = DuringPlanShotState(CurrentEvent);
 			// Process events
 			if ( CurrentEvent.EventType != ES_NO_EVENT )        //If an event is active
 			{
-			switch (CurrentEvent.EventType)
+				switch (CurrentEvent.EventType)
 				{
-					case ES_TIMEOUT:
-						// Move forward if the bot is at around the correct X value
-						if(CurrentEvent.EventParam == CHECK_TIMER) {
-							printf("At 90 \r\n");
-							NextState = FindYState;
-							MakeTransition = true;
-						 // Murder the motors
-							HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~(BIT2HI | BIT3HI);
-							SetPWMDuty(0,STARBOARD_MOTOR);
-							SetPWMDuty(0,PORT_MOTOR);
-						}
+					case PathGenerated:
+						NextState = ShotTurningState;
+						MakeTransition = true;
 						break;
-					}
 				}
+			}
 			break;
-		case FindYState :
-			 // Execute during function
-			 CurrentEvent = DuringFindYState(CurrentEvent);
-			 // Process events
-			 if ( CurrentEvent.EventType != ES_NO_EVENT )        //If an event is active
-			 {
-					switch (CurrentEvent.EventType)
-					{
-						 case ES_TIMEOUT:
-								// If at shooting point, move on
-								if(CurrentEvent.EventParam == CHECK_TIMER) {
-									if(currentPoint_Shooting.Y >= ShootingPoint_Shooting.Y) {
-									  // Murder the motors
-										HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~(BIT2HI | BIT3HI);
-										SetPWMDuty(0,STARBOARD_MOTOR);
-										SetPWMDuty(0,PORT_MOTOR);
-
-										NextState = ShootingTurningState;//Decide what the next state will be
-										MakeTransition = true; //mark that we are taking a transition
-									}
-									else {
-										ES_Timer_InitTimer(CHECK_TIMER,X_CheckTime);
-									}
-								}
-								break;
-					}
-			 }
-			 break;
-		case ShootingTurningState :
-		  // Execute during function
-		  CurrentEvent = DuringShootingTurningState(CurrentEvent);
-		  // Process events
-		  if ( CurrentEvent.EventType != ES_NO_EVENT )        //If an event is active
-		  {
+		case ShotTurningState :
+			// Execute during function
+			CurrentEvent = DuringShotTurningState(CurrentEvent);
+			// Process events
+			if ( CurrentEvent.EventType != ES_NO_EVENT )        //If an event is active
+			{
 				switch (CurrentEvent.EventType)
-					{
-						case ES_TIMEOUT:
-							// Move forward if the bot is at around the correct X value
-							if(CurrentEvent.EventParam == CHECK_TIMER) {
-								printf("At 180 \r\n");
-								NextState = FindXState;
-								MakeTransition = true;
-							}
-						}
+				{
+					case AtNextAngle:
+						NextState = ShotDrivingState;
+						MakeTransition = true;
+						break;
 				}
-		 break;
-		case FindXState :
-		  // Execute during function
-		  CurrentEvent = DuringFindXState(CurrentEvent);
-		  // Process events
-		  if ( CurrentEvent.EventType != ES_NO_EVENT )        //If an event is active
-		  {
+			}
+			break;
+		case ShotDrivingState :
+			// Execute during function
+			CurrentEvent = DuringShotDrivingState(CurrentEvent);
+			// Process events
+			if ( CurrentEvent.EventType != ES_NO_EVENT )        //If an event is active
+			{
 				switch (CurrentEvent.EventType)
 				{
-					case ES_TIMEOUT:
-						// If at shooting point, move on
-						if(CurrentEvent.EventParam == CHECK_TIMER) {
-							if(currentPoint_Shooting.X >= ShootingPoint_Shooting.X) {
-								// Murder the motors
-								HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~(BIT2HI | BIT3HI);
-								SetPWMDuty(0,STARBOARD_MOTOR);
-								SetPWMDuty(0,PORT_MOTOR);
-
-								NextState = FindBeaconState;//Decide what the next state will be
-								MakeTransition = true; //mark that we are taking a transition
-							}
-							else {
-								ES_Timer_InitTimer(CHECK_TIMER,X_CheckTime);
-							}
+					case AtNextPoint:
+						// Aim once we are in the zone, otherwise plan the next leg
+						if(InFiringZone(currentPoint_Shooting)) {
+							printf("In Firing Zone \r\n");
+							NextState = AimState;
+						}
+						else {
+							NextState = PlanShotState;
 						}
+						MakeTransition = true;
 						break;
 				}
-		 }
-		 break;
+			}
+			break;
+		case AimState :
+			// Execute during function
+			CurrentEvent = DuringAimState(CurrentEvent);
+			// Process events
+			if ( CurrentEvent.EventType != ES_NO_EVENT )        //If an event is active
+			{
+				switch (CurrentEvent.EventType)
+				{
+					case AtNextAngle:
+						printf("Aimed At %d \r\n", myKart_Shooting.KartTheta);
+						NextState = FindBeaconState;
+						MakeTransition = true;
+						break;
+				}
+			}
+			break;
 		case FindBeaconState :
 			 // Execute during function
 			 CurrentEvent = DuringFindBeaconState(CurrentEvent);
@@ -202,13 +192,38 @@ ES_Event RunShooting( ES_Event CurrentEvent )
 						case DetectedBeacon: //If event is event one
 							printf("Detected Beacon \r\n");
 						 
-							// Murder the motors
-							HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~(BIT2HI | BIT3HI);
-							SetPWMDuty(0,STARBOARD_MOTOR);
-							SetPWMDuty(0,PORT_MOTOR);
+							// EventParam has the band and how long ago we passed the
+							// center of the beacon
+							printf("Beacon band %d \r\n", BEACON_EVENT_BAND(CurrentEvent.EventParam));
+							if(BEACON_EVENT_TIME(CurrentEvent.EventParam) == 0) {
+								// Murder the motors
+								HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~(BIT2HI | BIT3HI);
+								SetPWMDuty(0,STARBOARD_MOTOR);
+								SetPWMDuty(0,PORT_MOTOR);
 
-							NextState = FireState;//Decide what the next state will be
-							MakeTransition = true; //mark that we are taking a transition
+								NextState = FireState;//Decide what the next state will be
+								MakeTransition = true; //mark that we are taking a transition
+							}
+							else {
+								// Turn back clockwise at the same speed for the same time
+								HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~BIT3HI;
+								HWREG(GPIO_PORTB_BASE + ALL_BITS) |= BIT2HI;
+								ES_Timer_InitTimer(CHECK_TIMER,BEACON_EVENT_TIME(CurrentEvent.EventParam));
+								CenteringOnBeacon = true;
+							}
+							break;
+						case ES_TIMEOUT:
+							// Back at the center of the beacon
+							if(CurrentEvent.EventParam == CHECK_TIMER && CenteringOnBeacon) {
+								printf("Centered On Beacon \r\n");
+								// Murder the motors
+								HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~(BIT2HI | BIT3HI);
+								SetPWMDuty(0,STARBOARD_MOTOR);
+								SetPWMDuty(0,PORT_MOTOR);
+
+								NextState = FireState;
+								MakeTransition = true;
+							}
 							break;
 					}
 			 }
@@ -222,9 +237,14 @@ ES_Event RunShooting( ES_Event CurrentEvent )
 			{
 				switch (CurrentEvent.EventType)
 				{
+					case BallsFired :
+						printf("Balls Fired: %d \r\n", CurrentEvent.EventParam);
+						NextState = ReturnToTapeState;//Decide what the next state will be
+						MakeTransition = true; //mark that we are taking a transition
+						break;
 					case ES_TIMEOUT : //If event is event one
 						if(CurrentEvent.EventParam == FIRE_BALL_TIMER) {
-							printf("Ball Fired \r\n");
+							printf("Fire Timed Out \r\n");
 							NextState = ReturnToTapeState;//Decide what the next state will be
 							MakeTransition = true; //mark that we are taking a transition
 						}
@@ -243,6 +263,8 @@ ES_Event RunShooting( ES_Event CurrentEvent )
 					case ES_TIMEOUT :
 						if(CurrentEvent.EventParam == BACK_TO_COURSE_TIMER) {
 							printf("At Near Tape Point \r\n");	
+							// Stop steering before the motors so no tick restarts them
+							StopLineFollower();
 							// Murder the motors
 							HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~(BIT2HI | BIT3HI);
 							SetPWMDuty(0,STARBOARD_MOTOR);
@@ -295,55 +317,18 @@ ShootingState QueryShooting ( void )
  private functions
  ***************************************************************************/
 
-// During funciton for OrientState
-static ES_Event DuringOrientState( ES_Event Event)
+// During funciton for PlanShotState
+static ES_Event DuringPlanShotState( ES_Event Event)
 {
 	// process ES_ENTRY & ES_EXIT events
 	if ( Event.EventType == ES_ENTRY  ) {
-		printf("Entered Orient State (Shooting) \r\n");	 
-		// Find differnece in angles
-		int deltaTheta;
-		deltaTheta = 90 - myKart_Shooting.KartTheta;//getDesiredTheta();
-
-		printf("Vector Calculations Dist: %d  Desired Theta: %d \n\r", 90, myKart_Shooting.KartTheta);
-		
-		// Guarantee that the bot never rotates more than 180 degrees
-		if(deltaTheta > 180) {
-			deltaTheta = deltaTheta - 360;
-		}
-		if(deltaTheta < (-1)*180) {
-			deltaTheta = deltaTheta + 360;
-		}
-		
-		// Check direction of turn
-		if(deltaTheta >= 0) {
-			// Set to turn counter-clockwise, drive for length of drive timer
-			HWREG(GPIO_PORTB_BASE + ALL_BITS) |= BIT3HI;
-			HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~ BIT2HI;
-		}
-		else {
-			deltaTheta = abs(deltaTheta);
-			// Set to turn clockwise, drive for length of drive timer
-			HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~BIT3HI;
-			HWREG(GPIO_PORTB_BASE + ALL_BITS) |=  BIT2HI;
-		}
-			
-		// Set PWM to (Half Speed)
-		SetPWMDuty(HALF_SPEED_PORT,PORT_MOTOR);
-		SetPWMDuty(HALF_SPEED_STARBOARD,STARBOARD_MOTOR);
-		if (deltaTheta == 0) {
-			ES_Event NewEvent = {ES_TIMEOUT,CHECK_TIMER};
-			PostMaster(NewEvent);
-			printf("theta = 0\r\n");
-		}
-		else {
-			ES_Timer_InitTimer(CHECK_TIMER,ROTATION_TIME*deltaTheta/360);
-			printf("theta != 0\r\n");
-		}
-		printf("is timer active %d\r\n",ES_Timer_isActive(CHECK_TIMER));
+		printf("Entered Plan Shot State \r\n");
+		// Plan from where we are now and head for the firing pose
+		PlanShot(myKart_Shooting, &ShotPlan);
+		Calculate(ShotPlan.FirePoint.X, ShotPlan.FirePoint.Y);
 	}
 	else if ( Event.EventType == ES_EXIT) {
-		printf("Exited Orient State (Shooting) \r\n");
+		printf("Exited Plan Shot State \r\n");
 		// No exit functionality 
 	}
 	else {
@@ -352,83 +337,36 @@ static ES_Event DuringOrientState( ES_Event Event)
 	return( Event );  // Don't remap event
 }
 
-// During funciton for FindYState
-static ES_Event DuringFindYState( ES_Event Event )
+// During funciton for ShotTurningState
+static ES_Event DuringShotTurningState( ES_Event Event)
 {
 	// process ES_ENTRY & ES_EXIT events
 	if ( Event.EventType == ES_ENTRY  ) {
-		printf("Entered Find Y State \r\n");
-			
-		printf("%d %d %d \n\r", myKart_Shooting.KartX, myKart_Shooting.KartY, myKart_Shooting.KartTheta);
-		printf("Drive Forward \r\n");
-		// Drive slowly
-		// Set Motors forward, drive for length of drive timer
-		HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~ BIT3HI;
-		HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~ BIT2HI;
-		// Set PWM to (quarter Speed)
-		SetPWMDuty(QUARTER_SPEED_PORT-10,PORT_MOTOR);
-		SetPWMDuty(QUARTER_SPEED_STARBOARD-10,STARBOARD_MOTOR);
-
-		// Start timer to check Y
-		ES_Timer_InitTimer(CHECK_TIMER,X_CheckTime);
+		printf("Entered Turning State (Shooting) \r\n");
+		// Turn toward the firing pose
+		TurnTheta( );
 	}
 	else if ( Event.EventType == ES_EXIT) {
-		printf("Exited Find Y State (Shooting) \r\n");
+		printf("Exited Turning State (Shooting) \r\n");
 		// No exit functionality 
 	}
 	else {
-		// No during functionallity	
+		// No during functionality
 	}
 	return( Event );  // Don't remap event
 }
 
-// During funciton for ShootingTurningState
-static ES_Event DuringShootingTurningState( ES_Event Event)
+// During funciton for ShotDrivingState
+static ES_Event DuringShotDrivingState( ES_Event Event)
 {
 	// process ES_ENTRY & ES_EXIT events
 	if ( Event.EventType == ES_ENTRY  ) {
-		printf("Entered Turning State (Shooting) \r\n");
-			 
-		// Find differnece in angles
-		int deltaTheta;
-		deltaTheta = 180 - myKart_Shooting.KartTheta;//getDesiredTheta();
-
-		printf("Vector Calculations Dist: %d  Desired Theta: %d \n\r", 180, getDesiredTheta());
-
-		//garuntee that the bot never rotates more than 180 degrees
-		if(deltaTheta > 180) {
-			deltaTheta = deltaTheta - 360;
-		}
-		if(deltaTheta < (-1)*180) {
-			deltaTheta = deltaTheta + 360;
-		}
-
-		// Check direction of turn
-		if(deltaTheta >= 0) {
-			// Set to turn counter-clockwise, drive for length of drive timer
-			HWREG(GPIO_PORTB_BASE + ALL_BITS) |= BIT3HI;
-			HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~ BIT2HI;
-		}
-		else {
-			deltaTheta = abs(deltaTheta);
-			// Set to turn clockwise, drive for length of drive timer
-			HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~BIT3HI;
-			HWREG(GPIO_PORTB_BASE + ALL_BITS) |=  BIT2HI;
-		}
-		// Set PWM to (HalfSpeed)
-		SetPWMDuty(HALF_SPEED_PORT,PORT_MOTOR);
-		SetPWMDuty(HALF_SPEED_STARBOARD,STARBOARD_MOTOR);
-		// Start timer for drive time
-		if (deltaTheta == 0) {
-				ES_Event NewEvent = {ES_TIMEOUT,CHECK_TIMER};
-				PostMaster(NewEvent);
-		}
-		else {
-			ES_Timer_InitTimer(CHECK_TIMER,ROTATION_TIME*deltaTheta/360 + 50);
-		}
+		printf("Entered Driving State (Shooting) \r\n");
+		// Drive to the firing pose
+		DriveForward( );
 	}
 	else if ( Event.EventType == ES_EXIT) {
-		printf("Exited Turning State (Shooting) \r\n");
+		printf("Exited Driving State (Shooting) \r\n");
 		// No exit functionality 
 	}
 	else {
@@ -437,26 +375,18 @@ static ES_Event DuringShootingTurningState( ES_Event Event)
 	return( Event );  // Don't remap event
 }
 
-// During funciton for FindXState
-static ES_Event DuringFindXState( ES_Event Event)
+// During funciton for AimState
+static ES_Event DuringAimState( ES_Event Event)
 {
 	// process ES_ENTRY & ES_EXIT events
 	if ( Event.EventType == ES_ENTRY  ) {
-		printf("Entered Find X State \r\n");
-		printf("Drive Forward \r\n");
-		// Drive slowly
-		// Set Motors forward, drive for length of drive timer
-		HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~ BIT3HI;
-		HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~ BIT2HI;
-		// Set PWM to (1/8 Speed)
-		SetPWMDuty(QUARTER_SPEED_PORT-10,PORT_MOTOR);
-		SetPWMDuty(QUARTER_SPEED_STARBOARD-10,STARBOARD_MOTOR);
-		
-		// Start timer to check X
-		ES_Timer_InitTimer(CHECK_TIMER,X_CheckTime);
+		printf("Entered Aim State \r\n");
+		// Face just clockwise of the beacon so the sweep finds it quickly
+		PlanShot(myKart_Shooting, &ShotPlan);
+		TurnToHeading(ShotPlan.SweepHeading);
 	}
 	else if ( Event.EventType == ES_EXIT) {
-		printf("Exited Find X State (Shooting) \r\n");
+		printf("Exited Aim State \r\n");
 		// No exit functionality 
 	}
 	else {
@@ -491,11 +421,14 @@ static ES_Event DuringFindBeaconState( ES_Event Event)
 		printf("Open Gate (let one ball out) \r\n");
 		ES_Timer_InitTimer(LOAD_BALL_TIMER,LOAD_TIME);
 		
-		SearchBeacon = true;
+		// Start looking for the beacon
+		CenteringOnBeacon = false;
+		StartBeaconSweep();
 	}
 	else if ( Event.EventType == ES_EXIT) {
 		printf("Exited Find Beacon State \r\n");
-		// No exit functionality
+		// Stop looking for the beacon
+		StopBeaconSweep();
 	}
 	else {
 		// No during functionality
@@ -508,11 +441,10 @@ static ES_Event DuringFireState( ES_Event Event)
 {
 	// process ES_ENTRY & ES_EXIT events
 	if ( Event.EventType == ES_ENTRY  ) {
-		SearchBeacon = false;
 		printf("Entered Fire State \r\n");
 		printf("Start Fire Timer \r\n");
 		// Start load ball timer
-		ES_Timer_InitTimer(FIRE_BALL_TIMER,FIRE_TIME);
+		ES_Timer_InitTimer(FIRE_BALL_TIMER,QueryBurstTime() + FIRE_MARGIN);
 		// Activate twanger
 		printf("Activate Twanger \r\n");
 		FireBallShooter();
@@ -520,7 +452,7 @@ static ES_Event DuringFireState( ES_Event Event)
 	}
 	else if ( Event.EventType == ES_EXIT) {
 		printf("Exited Fire State \r\n");
-		// No exit functionality
+		ES_Timer_StopTimer(FIRE_BALL_TIMER);
 	}
 	else {
 		// No during functionality
@@ -534,142 +466,21 @@ static ES_Event DuringReturnToTapeState( ES_Event Event)
 	// process ES_ENTRY & ES_EXIT events
 	if ( Event.EventType == ES_ENTRY  ) {
 		printf("Entered Return To Tape State \r\n");
-		printf("Forward for two seconds \r\n");
 
-		// Go forward
-		// Set left motor to drive reverse
-		HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~BIT3HI;
-		// Set right motor to drive reverse
-		HWREG(GPIO_PORTB_BASE + ALL_BITS) &= ~BIT2HI;
-		// Set PWM to (1/2 Speed)
-		SetPWMDuty(HALF_SPEED_PORT,PORT_MOTOR);
-		SetPWMDuty(HALF_SPEED_STARBOARD,STARBOARD_MOTOR);			
+		// Go forward at half speed, steering onto the tape once the sensors
+		// see it
+		StartLineFollower(RETURN_SPEED);
 		
-		// Start reverse timer
+		// Same time as before, the follower only changes the heading
 		ES_Timer_InitTimer(BACK_TO_COURSE_TIMER,ONE_SEC/2);
 	}
 	else if ( Event.EventType == ES_EXIT) {
 		printf("Exited Return To Tape State \r\n");
-		// No exit functionality
+		StopLineFollower();
 	}
-	else {
-		// No during functionality
+	else if ( Event.EventType == ES_TIMEOUT && Event.EventParam == CONTROL_TIMER ) {
+		// New wheel speeds every control tick
+		UpdateLineFollower();
 	}
 	return( Event );  // Don't remap event
 }
-
-/****************************************************************************
- Function
-   InitBeaconCaptureResponse
-
- Parameters
-     none
-
- Returns
-     none
-
- Description
-		Initializes input capture response on pin C4
-****************************************************************************/
-bool InitBeaconCaptureResponse (void)
-{
-	// Start by enabling the clock to the timer (Wide Timer 0)
-  HWREG(SYSCTL_RCGCWTIMER) |= SYSCTL_RCGCWTIMER_R0;
-	// Enable the clock to Port C
-	HWREG(SYSCTL_RCGCGPIO) |= SYSCTL_RCGCGPIO_R2;
-	// Since we added this Port C clock init, we can immediately start
-  // into configuring the timer, no need for further delay
-  
-  // Make sure that Wide Timer 0 Timer A is disabled before configuring
-  HWREG(WTIMER0_BASE+TIMER_O_CTL) &= ~TIMER_CTL_TAEN;
-  
-	// Set Wide Timer 0 Timer A in 32bit wide (individual, not concatenated) mode
-	// the constant name derives from the 16/32 bit timer, but this is a 32/64
-	// bit timer so we are setting the 32bit mode
-  HWREG(WTIMER0_BASE+TIMER_O_CFG) = TIMER_CFG_16_BIT;
-
-	// We want to use the full 32 bit count, so initialize the Interval Load
-	// register to 0xffff.ffff (this is its default value)
-  HWREG(WTIMER0_BASE+TIMER_O_TAILR) = 0xffffffff;
-
-	// Vet up Wide Timer 0 Timer A in capture mode (TAMR=3, TAAMS = 0), 
-	// for edge time (TACMR = 1) and up-counting (TACDIR = 1)
-  HWREG(WTIMER0_BASE+TIMER_O_TAMR) = 
-      (HWREG(WTIMER0_BASE+TIMER_O_TAMR) & ~TIMER_TAMR_TAAMS) | 
-        (TIMER_TAMR_TACDIR | TIMER_TAMR_TACMR | TIMER_TAMR_TAMR_CAP);
-
-	// To set the event to rising edge, we need to modify the TAEVENT bits 
-	// in GPTMCTL. Rising edge = 00, so we clear the TAEVENT bits
-  HWREG(WTIMER0_BASE+TIMER_O_CTL) &= ~TIMER_CTL_TAEVENT_M;
-
-	// Now Set up PortC Pin4 to do the capture (clock was enabled earlier)
-	// start by setting the alternate function for Port C bit 4 (WT0CCP0)
-	HWREG(GPIO_PORTC_BASE+GPIO_O_AFSEL) |= BIT4HI;
-
-	// Then, map bit 4's alternate function to WT0CCP0
-	// 7 is the mux value to select WT0CCP0, 16 to shift it over to the
-	// right nibble for bit 4 (4 bits/nibble * 4 bits)
-	HWREG(GPIO_PORTC_BASE+GPIO_O_PCTL) = 
-    (HWREG(GPIO_PORTC_BASE+GPIO_O_PCTL) & 0xfff0ffff) + (7<<16);
-
-	// Enable pin 4 on Port C as digital I/O
-	HWREG(GPIO_PORTC_BASE+GPIO_O_DEN) |= BIT4HI;
-	
-	// make pin 4 on Port C into an input
-	HWREG(GPIO_PORTC_BASE+GPIO_O_DIR) &= BIT4LO;
-
-	// back to the timer to enable a local capture interrupt
-  HWREG(WTIMER0_BASE+TIMER_O_IMR) |= TIMER_IMR_CAEIM;
-
-	// enable the Timer A in Wide Timer 0 interrupt in the NVIC
-	// it is interrupt number 94 so appears in EN2 at bit 30
-  HWREG(NVIC_EN2) |= BIT30HI;
-
-	// make sure interrupts are enabled globally
-  __enable_irq();
-
-	// now kick the timer off by enabling it and enabling the timer to
-	// stall while stopped by the debugger
-  HWREG(WTIMER0_BASE+TIMER_O_CTL) |= (TIMER_CTL_TAEN | TIMER_CTL_TASTALL);
-	
-	printf("IRSensor Initialized\n\r");
-	return true;
-}
-
-/****************************************************************************
- Function
-   BeaconCaptureResponse
-
- Parameters
-     none
-
- Returns
-     none
-
- Description
-		Posts a found beacon event if two consecutive input capture interrupts occur
-		at the correct frequency
-****************************************************************************/
-void BeaconCaptureResponse( void )
-{
-	uint32_t ThisCapture;
-
-	// Clear the interrupt source
-	HWREG(WTIMER0_BASE+TIMER_O_ICR) = TIMER_ICR_CAECINT;
-
-	// Read the capture value and calculate the period
-	ThisCapture = HWREG(WTIMER0_BASE+TIMER_O_TAR);
-	BeaconPeriod = (ThisCapture - LastCapture);
-
-	// Only post if the beacon is being searched for
-	if(SearchBeacon) {
-		if( (BeaconPeriod > BEACON_LOW) && (BeaconPeriod < BEACON_HIGH)){
-			ES_Event newEvent = {DetectedBeacon};
-			PostMaster(newEvent);
-			printf("Beacon Located\n\r");
-		}
-	}
-
-	// Update LastCapture to ThisCapture
-	LastCapture = ThisCapture;
-}
@@ -0,0 +1,147 @@
+/****************************************************************************
+ Module
+	ShotPlanner.c
+
+ Revision			Revised by:
+	0.1.1				Alex
+
+ Description
+	Plans the shot from wherever the kart is when it enters the shooting
+	state machine. The firing pose is the closest point in the firing zone
+	to the kart, and the firing heading points from there at the beacon.
+	The beacon sweep starts SWEEP_LEAD degrees clockwise of that heading so
+	the counter-clockwise sweep crosses the beacon straight away.
+
+ Edits:
+	0.1.1 - Initial version, replaces the fixed orient and creep sequence
+****************************************************************************/
+
+/*----------------------------- Include Files -----------------------------*/
+#include "Headers.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define PI 3.14159265
+
+// Beacon sits straight ahead of the shooting point when facing 180, which
+// is where the beacon sweep used to start
+#define BEACON_X ((x1 + x2)/2)
+#define BEACON_Y SP_Y
+
+// Firing zone, the old sequence fired once past SP_X and SP_Y
+#define SHOT_ZONE_SIZE 10
+#define SHOT_ZONE_XMIN SP_X
+#define SHOT_ZONE_XMAX (SP_X + SHOT_ZONE_SIZE)
+#define SHOT_ZONE_YMIN SP_Y
+#define SHOT_ZONE_YMAX (SP_Y + SHOT_ZONE_SIZE)
+
+// Aim this far inside the zone edges so DRS noise doesn't put us outside
+#define ZONE_MARGIN 2
+
+// Degrees clockwise of the beacon to start the sweep from
+#define SWEEP_LEAD 20
+
+/*---------------------------- Module Functions ---------------------------*/
+static uint16_t Clamp( uint16_t value, uint16_t min, uint16_t max );
+static uint16_t WrapHeading( int16_t heading );
+
+/*---------------------------- Module Variables ---------------------------*/
+
+/*------------------------------ Module Code ------------------------------*/
+
+/****************************************************************************
+ Function
+	PlanShot
+
+ Parameters
+	KART_t our kart
+	SHOT_PLAN_t * plan to fill in
+
+ Returns
+	bool true if the kart has to drive to the firing pose first
+
+ Description
+	Finds the closest firing pose and the headings to fire and sweep from
+****************************************************************************/
+bool PlanShot( KART_t myKart, SHOT_PLAN_t *Plan )
+{
+	POINT_t current = {myKart.KartX, myKart.KartY};
+	bool needsDrive = !InFiringZone(current);
+
+	if(needsDrive) {
+		Plan->FirePoint.X = Clamp(myKart.KartX, SHOT_ZONE_XMIN + ZONE_MARGIN, SHOT_ZONE_XMAX - ZONE_MARGIN);
+		Plan->FirePoint.Y = Clamp(myKart.KartY, SHOT_ZONE_YMIN + ZONE_MARGIN, SHOT_ZONE_YMAX - ZONE_MARGIN);
+	}
+	else {
+		Plan->FirePoint = current;
+	}
+
+	Plan->FireHeading = BeaconHeading(Plan->FirePoint);
+	Plan->SweepHeading = WrapHeading(Plan->FireHeading - SWEEP_LEAD);
+
+	printf("Shot Plan X: %d Y: %d Heading: %d \r\n", Plan->FirePoint.X, Plan->FirePoint.Y, Plan->FireHeading);
+	return needsDrive;
+}
+
+/****************************************************************************
+ Function
+	InFiringZone
+
+ Parameters
+	POINT_t position to check
+
+ Returns
+	bool true if a shot from here is legal
+
+ Description
+	Checks the position against the firing zone
+****************************************************************************/
+bool InFiringZone( POINT_t current )
+{
+	return (current.X >= SHOT_ZONE_XMIN && current.X <= SHOT_ZONE_XMAX &&
+	        current.Y >= SHOT_ZONE_YMIN && current.Y <= SHOT_ZONE_YMAX);
+}
+
+/****************************************************************************
+ Function
+	BeaconHeading
+
+ Parameters
+	POINT_t position to fire from
+
+ Returns
+	uint16_t kart heading (0-359) that points at the beacon
+
+ Description
+	Uses the heading vector (-cos(theta), sin(theta)) from the DRS
+****************************************************************************/
+uint16_t BeaconHeading( POINT_t from )
+{
+	float deltaX = (float)BEACON_X - from.X;
+	float deltaY = (float)BEACON_Y - from.Y;
+	return WrapHeading((int16_t)(atan2(deltaY, -deltaX)*180/PI + 0.5f));
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+
+// Limits a value to the range min to max
+static uint16_t Clamp( uint16_t value, uint16_t min, uint16_t max )
+{
+	if(value < min) {
+		return min;
+	}
+	if(value > max) {
+		return max;
+	}
+	return value;
+}
+
+// Wraps a heading in degrees to 0-359
+static uint16_t WrapHeading( int16_t heading )
+{
+	while(heading < 0) {
+		heading += 360;
+	}
+	return heading % 360;
+}
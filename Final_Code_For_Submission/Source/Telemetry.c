@@ -0,0 +1,325 @@
+/****************************************************************************
+ Module
+	Telemetry.c
+
+ Revision			Revised by:
+	0.1.2				Alex
+
+ Description
+	Streams chosen values to the host over the binary console, in place of
+	printing them. Every TELEMETRY_TICK the channels that are due are sampled
+	into one frame:
+
+		sequence number, time (ES timer ticks), channel mask, a 16 bit value
+		per channel
+
+	each little endian, with the values in channel order. A tick is
+	1/ONE_SEC of a second, a little over a millisecond. A channel with a
+	decimation of n is in every nth frame, 1 is every frame and 0 is off.
+	The sequence number goes up for every frame made, sent or not, so the
+	host can see where frames are missing.
+
+	Frames go out through the console framing and its transmit buffer.
+	Sending is limited to TELEMETRY_BYTES_PER_SEC on average, with bursts
+	of up to TELEMETRY_BURST bytes, so replies and printf text always get a
+	share of the UART. A frame over the budget, or one the transmit buffer
+	can't take, is dropped and counted.
+
+	CheckTelemetry is an event checker. It makes at most one frame a call
+	and never posts anything.
+
+ Edits:
+	0.1.1 - Initial version, takes over streaming from Console.c
+	0.1.2 - Time is labelled as timer ticks, and the budget is refilled per
+					ONE_SEC ticks rather than per 1000
+****************************************************************************/
+
+/*----------------------------- Include Files -----------------------------*/
+#include "Headers.h"
+#include "ES_Watchdog.h"
+#include "Console.h"
+#include "Telemetry.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+// 115200 baud is about 11500 bytes a second, leave over half of it
+#define TELEMETRY_BYTES_PER_SEC 5000
+#define TELEMETRY_BURST 256
+
+// Sequence, time and mask
+#define HEADER_BYTES 6
+
+typedef uint16_t TelemetrySample_t( void );
+
+typedef struct {
+			const char					*Name;
+			TelemetrySample_t		*Sample;
+} TELEMETRY_CHANNEL_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+static uint16_t SampleKartX( void );
+static uint16_t SampleKartY( void );
+static uint16_t SampleKartTheta( void );
+static uint16_t SampleHeading( void );
+static uint16_t SampleTargetX( void );
+static uint16_t SampleTargetY( void );
+static uint16_t SamplePortDuty( void );
+static uint16_t SampleStarboardDuty( void );
+static uint16_t SampleMasterState( void );
+static uint16_t SampleDrivingState( void );
+static uint16_t SampleBeaconPeriod( void );
+static uint16_t SampleQueuePeak( void );
+static uint16_t SampleBattery( void );
+static uint16_t SampleOverruns( void );
+static uint16_t SampleDropped( void );
+static void PutU16( uint8_t *Buffer, uint16_t Value );
+
+/*---------------------------- Module Variables ---------------------------*/
+// Indexed by TelemetryChannel_t
+static const TELEMETRY_CHANNEL_t Channels[NUM_TELEMETRY_CHANNELS] = {
+	[TEL_KART_X] =					{"kartx", SampleKartX},
+	[TEL_KART_Y] =					{"karty", SampleKartY},
+	[TEL_KART_THETA] =			{"karttheta", SampleKartTheta},
+	[TEL_HEADING] =					{"heading", SampleHeading},
+	[TEL_TARGET_X] =				{"targetx", SampleTargetX},
+	[TEL_TARGET_Y] =				{"targety", SampleTargetY},
+	[TEL_PORT_DUTY] =				{"portduty", SamplePortDuty},
+	[TEL_STARBOARD_DUTY] =	{"stbdduty", SampleStarboardDuty},
+	[TEL_MASTER_STATE] =		{"masterstate", SampleMasterState},
+	[TEL_DRIVING_STATE] =		{"drivingstate", SampleDrivingState},
+	[TEL_BEACON_PERIOD] =		{"beaconperiod", SampleBeaconPeriod},
+	[TEL_QUEUE_PEAK] =			{"queuepeak", SampleQueuePeak},
+	[TEL_BATTERY] =					{"battery", SampleBattery},
+	[TEL_OVERRUNS] =				{"overruns", SampleOverruns},
+	[TEL_DROPPED] =					{"dropped", SampleDropped}
+};
+
+static uint8_t Decimation[NUM_TELEMETRY_CHANNELS];
+static uint16_t ActiveMask = 0;
+
+static uint16_t Sequence = 0;
+static uint16_t Tick = 0;
+static uint16_t LastTickTime;
+static uint16_t Budget = 0;
+static uint16_t Dropped = 0;
+
+/*------------------------------ Module Code ------------------------------*/
+
+/****************************************************************************
+ Function
+	SetTelemetryChannel
+
+ Parameters
+	uint8_t channel
+	uint8_t send it every this many ticks, 0 to stop sending it
+
+ Returns
+	bool false if there is no such channel
+
+ Description
+	Starting the first channel starts the frames from sequence 0
+****************************************************************************/
+bool SetTelemetryChannel( uint8_t Channel, uint8_t Rate )
+{
+	if(Channel >= NUM_TELEMETRY_CHANNELS) {
+		return false;
+	}
+	if(ActiveMask == 0 && Rate != 0) {
+		Sequence = 0;
+		Tick = 0;
+		Budget = TELEMETRY_BURST;
+		LastTickTime = ES_Timer_GetTime();
+	}
+	Decimation[Channel] = Rate;
+	if(Rate != 0) {
+		ActiveMask |= (1 << Channel);
+	}
+	else {
+		ActiveMask &= ~(1 << Channel);
+	}
+	return true;
+}
+
+/****************************************************************************
+ Function
+	StopTelemetry
+
+ Parameters
+	none
+
+ Returns
+	none
+
+ Description
+	Turns every channel off
+****************************************************************************/
+void StopTelemetry( void )
+{
+	for(uint8_t i = 0; i < NUM_TELEMETRY_CHANNELS; i++) {
+		Decimation[i] = 0;
+	}
+	ActiveMask = 0;
+}
+
+/****************************************************************************
+ Function
+	QueryTelemetryChannel
+
+ Parameters
+	uint8_t channel
+	const char ** set to the channel's name
+	uint8_t * set to its decimation, 0 if it is off
+
+ Returns
+	bool false if there is no such channel
+****************************************************************************/
+bool QueryTelemetryChannel( uint8_t Channel, const char **pName, uint8_t *pDecimation )
+{
+	if(Channel >= NUM_TELEMETRY_CHANNELS) {
+		return false;
+	}
+	*pName = Channels[Channel].Name;
+	*pDecimation = Decimation[Channel];
+	return true;
+}
+
+/****************************************************************************
+ Function
+	CheckTelemetry
+
+ Parameters
+	none
+
+ Returns
+	bool false, telemetry never posts
+
+ Description
+	Samples and sends the channels that are due each TELEMETRY_TICK
+****************************************************************************/
+bool CheckTelemetry( void )
+{
+	uint16_t now = ES_Timer_GetTime();
+	uint16_t elapsed = now - LastTickTime;
+
+	if(ActiveMask == 0 || elapsed < TELEMETRY_TICK) {
+		return false;
+	}
+	// Ticks missed while something else had the processor are skipped
+	LastTickTime = now;
+	uint32_t budget = Budget + (uint32_t)elapsed*TELEMETRY_BYTES_PER_SEC/ONE_SEC;
+	Budget = (budget > TELEMETRY_BURST) ? TELEMETRY_BURST : budget;
+	Tick++;
+
+	uint8_t payload[HEADER_BYTES + NUM_TELEMETRY_CHANNELS*2];
+	uint8_t length = HEADER_BYTES;
+	uint16_t mask = 0;
+	for(uint8_t i = 0; i < NUM_TELEMETRY_CHANNELS; i++) {
+		if(Decimation[i] != 0 && Tick % Decimation[i] == 0) {
+			mask |= (1 << i);
+			PutU16(&payload[length], Channels[i].Sample());
+			length += 2;
+		}
+	}
+	if(mask == 0) {
+		return false;
+	}
+	PutU16(&payload[0], Sequence++);
+	PutU16(&payload[2], now);
+	PutU16(&payload[4], mask);
+
+	uint8_t size = length + CONSOLE_FRAME_OVERHEAD;
+	if(Budget >= size && SendConsoleFrame(CONSOLE_TELEMETRY_DATA, payload, length)) {
+		Budget -= size;
+	}
+	else {
+		Dropped++;
+	}
+	return false;
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+
+// Channel samples
+static uint16_t SampleKartX( void )
+{
+	return QueryMyKart().KartX;
+}
+
+static uint16_t SampleKartY( void )
+{
+	return QueryMyKart().KartY;
+}
+
+static uint16_t SampleKartTheta( void )
+{
+	return QueryMyKart().KartTheta;
+}
+
+static uint16_t SampleHeading( void )
+{
+	return QueryTheta();
+}
+
+static uint16_t SampleTargetX( void )
+{
+	return QueryDriveTarget().X;
+}
+
+static uint16_t SampleTargetY( void )
+{
+	return QueryDriveTarget().Y;
+}
+
+static uint16_t SamplePortDuty( void )
+{
+	return GetLastPWM(PORT_MOTOR);
+}
+
+static uint16_t SampleStarboardDuty( void )
+{
+	return GetLastPWM(STARBOARD_MOTOR);
+}
+
+static uint16_t SampleMasterState( void )
+{
+	return QueryMasterState();
+}
+
+static uint16_t SampleDrivingState( void )
+{
+	return QueryDriving();
+}
+
+static uint16_t SampleBeaconPeriod( void )
+{
+	uint32_t period = QueryBeaconPeriod();
+	return (period > 0xFFFF) ? 0xFFFF : period;
+}
+
+static uint16_t SampleQueuePeak( void )
+{
+	return ES_QueryQueuePeak(0);
+}
+
+static uint16_t SampleBattery( void )
+{
+	return QueryBatteryMillivolts();
+}
+
+static uint16_t SampleOverruns( void )
+{
+	return ES_Watchdog_QueryOverruns();
+}
+
+static uint16_t SampleDropped( void )
+{
+	return Dropped;
+}
+
+// Little endian, like the rest of the console
+static void PutU16( uint8_t *Buffer, uint16_t Value )
+{
+	Buffer[0] = Value & 0xFF;
+	Buffer[1] = Value >> 8;
+}
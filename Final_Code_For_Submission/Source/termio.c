@@ -11,6 +11,7 @@
 #include "driverlib/sysctl.h"
 #include "driverlib/uart.h"
 #include "driverlib/debug.h"
+#include "driverlib/interrupt.h"
 
 #define PORT_NUM			0
 #define UART_BASE			UART0_BASE
@@ -26,6 +27,17 @@
 #define SRC_CLK_FREQ	16000000UL
 #define CLK_FREQ		40000000UL
 
+// Everything sent goes through this ring so text and console frames never
+// interleave, and the UART FIFO is topped up from it without waiting
+#define TX_BUFFER_SIZE	512
+
+static uint8_t TxBuffer[TX_BUFFER_SIZE];
+static uint16_t TxHead;		// Next byte to send
+static uint16_t TxCount;
+static uint16_t TxDropped;	// Text lost because the buffer was full with interrupts off
+
+static void FillTxFIFO(void);
+
 unsigned char TERMIO_GetChar(void) {
 	// (unsigned char)UARTCharGet(uint32_t ui32Base);
 	return UARTgetc();
@@ -33,7 +45,71 @@ unsigned char TERMIO_GetChar(void) {
 
 void TERMIO_PutChar(unsigned char ch) {
 	/* sends a character to the terminal channel */
-	UARTCharPut(UART_BASE, ch);
+	bool wasDisabled = IntMasterDisable();
+	// Text has always waited for room, so it still does, but with
+	// interrupts on so the ISRs keep running while the UART drains
+	FillTxFIFO();
+	while(TxCount == TX_BUFFER_SIZE && !wasDisabled) {
+		IntMasterEnable();
+		IntMasterDisable();
+		FillTxFIFO();
+	}
+	// Called with interrupts off, waiting would hold them off too
+	if(TxCount == TX_BUFFER_SIZE) {
+		TxDropped++;
+		return;
+	}
+	TxBuffer[(TxHead + TxCount) % TX_BUFFER_SIZE] = ch;
+	TxCount++;
+	FillTxFIFO();
+	if(!wasDisabled) {
+		IntMasterEnable();
+	}
+}
+
+bool TERMIO_Write(const uint8_t *data, uint16_t length) {
+	/* queues a block to send, all or nothing, never waits */
+	bool wasDisabled = IntMasterDisable();
+	bool fits = (length <= TX_BUFFER_SIZE - TxCount);
+	if(fits) {
+		for(uint16_t i = 0; i < length; i++) {
+			TxBuffer[(TxHead + TxCount) % TX_BUFFER_SIZE] = data[i];
+			TxCount++;
+		}
+		FillTxFIFO();
+	}
+	if(!wasDisabled) {
+		IntMasterEnable();
+	}
+	return fits;
+}
+
+uint16_t TERMIO_TxDropped(void) {
+	/* characters TERMIO_PutChar has thrown away */
+	return TxDropped;
+}
+
+uint16_t TERMIO_TxFree(void) {
+	/* bytes TERMIO_Write can take right now */
+	return TX_BUFFER_SIZE - TxCount;
+}
+
+void TERMIO_Service(void) {
+	/* moves queued bytes into the UART FIFO, call often */
+	bool wasDisabled = IntMasterDisable();
+	FillTxFIFO();
+	if(!wasDisabled) {
+		IntMasterEnable();
+	}
+}
+
+static void FillTxFIFO(void) {
+	/* as many queued bytes as the FIFO has room for, interrupts off */
+	while(TxCount > 0 && UARTSpaceAvail(UART_BASE)) {
+		UARTCharPutNonBlocking(UART_BASE, TxBuffer[TxHead]);
+		TxHead = (TxHead + 1) % TX_BUFFER_SIZE;
+		TxCount--;
+	}
 }
 
 void TERMIO_Init(void) {
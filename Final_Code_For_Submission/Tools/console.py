@@ -0,0 +1,347 @@
+#!/usr/bin/env python3
+"""Host side of the binary console in Source/Console.c.
+
+Talks to the kart over the debug UART (115200 8N1) to read and set the
+calibration parameters, post events and watch telemetry. Parameter and
+telemetry channel names come from the kart, event names from the enum in
+Headers/ES_Configure.h.
+Anything the kart prints that isn't a frame is shown as log text.
+
+Frames both ways are sync (0xA5), command, payload length, payload and a
+CRC-16/CCITT (starting at 0xFFFF, little endian) of the command, length
+and payload. The commands and replies are listed in Headers/Console.h.
+
+Usage:
+    python3 Tools/console.py --port /dev/ttyACM0                 # interactive
+    python3 Tools/console.py --port COM4 params
+    python3 Tools/console.py --port COM4 set halfport 72
+    python3 Tools/console.py --port COM4 post FlagDropped
+    python3 Tools/console.py --port COM4 telemetry kartx=1,karty=1,battery=50
+
+Tools/telemetry_rec.py records telemetry to a CSV file.
+
+Needs pyserial.
+"""
+
+import argparse
+import cmd
+import os
+import re
+import struct
+import sys
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.dirname(HERE)
+
+SYNC = 0xA5
+REPLY = 0x80
+(PING, PARAM_INFO, PARAM_GET, PARAM_SET, PARAM_RESET, POST_EVENT,
+ TELEMETRY, TELEMETRY_INFO, TELEMETRY_STOP) = range(1, 10)
+TELEMETRY_DATA = 0x40
+STATUS = ["ok", "bad command", "bad length", "bad id", "rejected"]
+
+
+class ConsoleError(Exception):
+    pass
+
+
+def crc16(data, crc=0xFFFF):
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def frame(command, payload=b""):
+    body = bytes([command, len(payload)]) + payload
+    return bytes([SYNC]) + body + struct.pack("<H", crc16(body))
+
+
+def read_events(path=os.path.join(ROOT, "Headers", "ES_Configure.h")):
+    """Return the ES_EventTyp_t names in order, the index is the value."""
+    with open(path, encoding="latin-1") as f:
+        text = f.read()
+    m = re.search(r"typedef\s+enum\s*\{(.*?)\}\s*ES_EventTyp_t", text, re.S)
+    if not m:
+        raise ConsoleError("no ES_EventTyp_t in %s" % path)
+    body = re.sub(r"/\*.*?\*/|//[^\n]*", "", m.group(1), flags=re.S)
+    names = []
+    for item in body.split(","):
+        name = item.split("=")[0].strip()
+        if name and name != "NUM_ES_EVENTS":
+            names.append(name)
+    return names
+
+
+class Link:
+    """Frames over a serial port, text that isn't a frame goes to log."""
+
+    def __init__(self, port, baud=115200, log=sys.stdout):
+        import serial
+        self.serial = serial.Serial(port, baud, timeout=0.05)
+        self.log = log
+        self.buffer = bytearray()
+        self.on_telemetry = None
+
+    def close(self):
+        self.serial.close()
+
+    def send(self, command, payload=b""):
+        self.serial.write(frame(command, payload))
+
+    def poll(self):
+        """Read what has arrived, return the complete frames in it."""
+        self.buffer += self.serial.read(self.serial.in_waiting or 1)
+        frames = []
+        while self.buffer:
+            start = self.buffer.find(SYNC)
+            if start < 0:
+                self._text(self.buffer)
+                self.buffer.clear()
+                break
+            if start > 0:
+                self._text(self.buffer[:start])
+                del self.buffer[:start]
+            if len(self.buffer) < 3:
+                break
+            length = self.buffer[2]
+            end = 3 + length + 2
+            if len(self.buffer) < end:
+                break
+            body = bytes(self.buffer[1:3 + length])
+            if struct.unpack("<H", self.buffer[3 + length:end])[0] != crc16(body):
+                # Not a frame after all, show the sync byte and look again
+                self._text(self.buffer[:1])
+                del self.buffer[:1]
+                continue
+            del self.buffer[:end]
+            if body[0] == TELEMETRY_DATA:
+                if self.on_telemetry:
+                    self.on_telemetry(decode_telemetry(bytes(body[2:])))
+            else:
+                frames.append((body[0], body[2:]))
+        return frames
+
+    def request(self, command, payload=b"", timeout=0.5, retries=3):
+        """Send a command and return the payload of its reply after the status."""
+        for _ in range(retries):
+            self.send(command, payload)
+            deadline = time.monotonic() + timeout
+            while time.monotonic() < deadline:
+                for reply, data in self.poll():
+                    if reply == command | REPLY:
+                        if data[0] != 0:
+                            status = STATUS[data[0]] if data[0] < len(STATUS) else data[0]
+                            raise ConsoleError(status)
+                        return data[1:]
+        raise ConsoleError("no reply")
+
+    def _text(self, data):
+        self.log.write(data.decode("latin-1"))
+        self.log.flush()
+
+
+class Kart:
+    """The console commands, with names looked up for the caller."""
+
+    def __init__(self, link):
+        self.link = link
+        self.events = read_events()
+        version, records, events, channels = self.link.request(PING)
+        if events != len(self.events):
+            print("warning: kart has %d events, ES_Configure.h has %d" % (events, len(self.events)))
+        self.params = {}
+        for pid in range(records):
+            data = self.link.request(PARAM_INFO, bytes([pid]))
+            name = data[6:].decode("latin-1")
+            self.params[name] = (pid, bool(data[1]))
+        self.channels = []
+        for channel in range(channels):
+            data = self.link.request(TELEMETRY_INFO, bytes([channel]))
+            self.channels.append(data[2:].decode("latin-1"))
+
+    def _param(self, name):
+        if name not in self.params:
+            raise ConsoleError("no parameter %s" % name)
+        return self.params[name]
+
+    @staticmethod
+    def _decode(is_float, raw):
+        return struct.unpack("<f", raw)[0] if is_float else struct.unpack("<I", raw)[0]
+
+    def get(self, name):
+        pid, is_float = self._param(name)
+        return self._decode(is_float, self.link.request(PARAM_GET, bytes([pid]))[1:5])
+
+    def set(self, name, value):
+        pid, is_float = self._param(name)
+        raw = struct.pack("<f", float(value)) if is_float else struct.pack("<I", int(value, 0))
+        return self._decode(is_float, self.link.request(PARAM_SET, bytes([pid]) + raw)[1:5])
+
+    def reset(self):
+        self.link.request(PARAM_RESET)
+
+    def post(self, event, param=0):
+        if event not in self.events:
+            raise ConsoleError("no event %s" % event)
+        self.link.request(POST_EVENT, struct.pack("<HH", self.events.index(event), param))
+
+    def telemetry(self, rates):
+        """Set the decimation of each channel in rates, a {name: n} dict."""
+        payload = b""
+        for name, rate in rates.items():
+            if name not in self.channels:
+                raise ConsoleError("no channel %s" % name)
+            payload += bytes([self.channels.index(name), rate])
+        self.link.request(TELEMETRY, payload)
+
+    def telemetry_rates(self):
+        """Return the {name: n} of the channels being sent."""
+        rates = {}
+        for channel, name in enumerate(self.channels):
+            rate = self.link.request(TELEMETRY_INFO, bytes([channel]))[1]
+            if rate:
+                rates[name] = rate
+        return rates
+
+    def stop_telemetry(self):
+        self.link.request(TELEMETRY_STOP)
+
+    def watch(self, rates, show):
+        """Send show(seq, ticks, {name: value}) for each frame until Ctrl-C."""
+        self.telemetry(rates)
+        self.link.on_telemetry = lambda t: show(t[0], t[1], {self.channels[c]: v for c, v in t[2].items()})
+        try:
+            while True:
+                self.link.poll()
+        except KeyboardInterrupt:
+            pass
+        finally:
+            self.link.on_telemetry = None
+            self.stop_telemetry()
+
+
+def decode_telemetry(payload):
+    """Return seq, ticks and {channel: value} from a telemetry frame.
+
+    ticks is the kart's ES timer, ONE_SEC (976) to the second, not ms.
+    """
+    seq, ticks, mask = struct.unpack_from("<HHH", payload)
+    channels = [c for c in range(16) if mask & (1 << c)]
+    values = struct.unpack_from("<%dH" % len(channels), payload, 6)
+    return seq, ticks, dict(zip(channels, values))
+
+
+def parse_rates(arg):
+    """NAME=N[,NAME=N...] to {name: n}, a NAME on its own is every frame."""
+    rates = {}
+    for item in arg.split(","):
+        name, _, rate = item.partition("=")
+        rates[name.strip()] = int(rate) if rate else 1
+    return rates
+
+
+class Shell(cmd.Cmd):
+    intro = "Kart console, help for commands, Ctrl-D to quit"
+    prompt = "kart> "
+
+    def __init__(self, kart):
+        super().__init__()
+        self.kart = kart
+
+    def onecmd(self, line):
+        try:
+            return super().onecmd(line)
+        except (ConsoleError, ValueError) as e:
+            print("error:", e)
+
+    def emptyline(self):
+        for _ in self.kart.link.poll():
+            pass
+
+    def do_params(self, arg):
+        """params: list every parameter and its value"""
+        for name in self.kart.params:
+            print("%-14s %s" % (name, self.kart.get(name)))
+
+    def do_get(self, arg):
+        """get NAME"""
+        print(self.kart.get(arg.strip()))
+
+    def do_set(self, arg):
+        """set NAME VALUE: set and save a parameter"""
+        name, value = arg.split()
+        print("%s = %s" % (name, self.kart.set(name, value)))
+
+    def do_reset(self, arg):
+        """reset: every parameter back to its default"""
+        self.kart.reset()
+
+    def do_events(self, arg):
+        """events: list the events post knows"""
+        print(" ".join(self.kart.events))
+
+    def do_post(self, arg):
+        """post EVENT [PARAM]"""
+        words = arg.split()
+        self.kart.post(words[0], int(words[1], 0) if len(words) > 1 else 0)
+
+    def complete_post(self, text, line, begin, end):
+        return [e for e in self.kart.events if e.startswith(text)]
+
+    def complete_set(self, text, line, begin, end):
+        return [p for p in self.kart.params if p.startswith(text)]
+
+    complete_get = complete_set
+
+    def do_channels(self, arg):
+        """channels: list the telemetry channels and the ones being sent"""
+        rates = self.kart.telemetry_rates()
+        for name in self.kart.channels:
+            print("%-14s %s" % (name, rates.get(name, "off")))
+
+    def do_telemetry(self, arg):
+        """telemetry CHANNEL[=N][,CHANNEL[=N]...]: print every Nth sample until Ctrl-C"""
+        last = [None]
+
+        def show(seq, ticks, values):
+            if last[0] is not None and seq != (last[0] + 1) & 0xFFFF:
+                print("-- %d frames missing" % ((seq - last[0] - 1) & 0xFFFF))
+            last[0] = seq
+            print("%5d %5d " % (seq, ticks) + " ".join("%s=%d" % item for item in values.items()))
+
+        self.kart.watch(parse_rates(arg), show)
+
+    def complete_telemetry(self, text, line, begin, end):
+        return [c for c in self.kart.channels if c.startswith(text)]
+
+    def do_EOF(self, arg):
+        print()
+        return True
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", required=True)
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("command", nargs=argparse.REMAINDER, help="run one command and exit")
+    args = parser.parse_args()
+
+    link = Link(args.port, args.baud)
+    try:
+        shell = Shell(Kart(link))
+        if args.command:
+            shell.onecmd(" ".join(args.command))
+        else:
+            shell.cmdloop()
+    except ConsoleError as e:
+        sys.exit("error: %s" % e)
+    finally:
+        link.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,605 @@
+#!/usr/bin/env python3
+"""Generate a state machine for the HSM engine from a .hsm description.
+
+A .hsm file lists the states of one machine and the transitions out of
+each. From it this writes the transition and state tables, the Start, Run
+and Query functions, stubs for any hooks that don't exist yet, the state
+enum header for a new machine, and a Graphviz diagram. Events the machine
+handles that are missing from ES_Configure.h are added to the event enum.
+
+Before writing anything the description is checked:
+    error    a target or initial state that doesn't exist
+    error    a state that can't be reached from the initial state
+    error    a dead state, one with no way out that isn't marked final
+    error    a row that can never be taken because an unguarded row for
+             the same event comes before it
+    warning  an event from the events list a state neither handles nor
+             ignores, or that no state handles at all
+    warning  a state whose only rows for an event are all guarded
+--strict turns warnings into errors.
+
+Format, one item per line, # starts a comment. A comment on the line
+before an "on" row is copied into the table.
+
+    machine Driving
+    description Driving state machine that controls the driving
+    initial AtPositionState
+    before UpdateCurrentPoint          # gets every event before the machine
+    events NextPointCalculated PathGenerated AtNextPoint
+
+    state AtPositionState AtPosition   # enum name, then name for traces
+        entry exit during              # hooks it has, Entry<State> etc.
+        final                          # no way out is fine
+        ignore PathGenerated *         # events it doesn't care about
+        on NextPointCalculated -> FollowingPathState [CanFollowPath] "Trace"
+        on FlagDropped -> RunningGameStateGP history
+        on ES_TIMEOUT internal / Tick  # action without leaving the state
+
+An existing <Machine>.c is only changed between the hsm_gen markers, and
+stubs are added for hooks, guards and actions it doesn't define yet. A new
+machine gets a whole <Machine>.c and <Machine>.h.
+
+Usage:
+    python3 Tools/hsm_gen.py Tools/machines/Driving.hsm
+    python3 Tools/hsm_gen.py --check Tools/machines/*.hsm   # checks only
+    python3 Tools/hsm_gen.py --dot Driving.dot Tools/machines/Driving.hsm
+"""
+
+import argparse
+import os
+import re
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.dirname(HERE)
+
+BEGIN_TABLES = "/*--------------------------- hsm_gen: tables ----------------------------*/"
+END_TABLES = "/*------------------------- hsm_gen: end tables --------------------------*/"
+BEGIN_FUNCTIONS = "/*-------------------------- hsm_gen: functions ---------------------------*/"
+END_FUNCTIONS = "/*------------------------ hsm_gen: end functions -------------------------*/"
+
+# Framework events a machine may handle without adding them to the enum
+FRAMEWORK_EVENTS = {"ES_TIMEOUT", "ES_NEW_KEY"}
+
+ROW_RE = re.compile(
+    r"on\s+(?P<event>\w+)\s+"
+    r"(?:->\s*(?P<target>\w+)(?P<history>\s+history)?|(?P<internal>internal))"
+    r"(?:\s*\[(?P<guard>\w+)\])?"
+    r"(?:\s*/\s*(?P<action>\w+))?"
+    r'(?:\s*"(?P<trace>[^"]*)")?\s*$')
+
+
+class SpecError(Exception):
+    pass
+
+
+class State:
+    def __init__(self, name, label, line):
+        self.name = name
+        self.label = label
+        self.line = line
+        self.hooks = set()
+        self.final = False
+        self.ignore = set()
+        self.rows = []
+
+
+class Machine:
+    def __init__(self, path):
+        self.path = path
+        self.name = None
+        self.description = None
+        self.initial = None
+        self.before = None
+        self.events = []
+        self.states = []
+
+    def state(self, name):
+        for s in self.states:
+            if s.name == name:
+                return s
+        return None
+
+
+def parse(path):
+    machine = Machine(path)
+    current = None
+    comment = []
+    with open(path) as f:
+        for number, raw in enumerate(f, 1):
+            stripped = raw.strip()
+            if stripped.startswith("#"):
+                comment.append(stripped[1:].strip())
+                continue
+            line = stripped.split(" #")[0].strip()
+            if not line:
+                comment = []
+                continue
+            word, _, rest = line.partition(" ")
+            rest = rest.strip()
+            where = "%s:%d" % (path, number)
+
+            if word == "machine":
+                machine.name = rest
+            elif word == "description":
+                machine.description = rest
+            elif word == "initial":
+                machine.initial = rest
+            elif word == "before":
+                machine.before = rest
+            elif word == "events":
+                machine.events.extend(rest.split())
+            elif word == "state":
+                parts = rest.split()
+                if not parts:
+                    raise SpecError("%s: state needs a name" % where)
+                if machine.state(parts[0]):
+                    raise SpecError("%s: state %s defined twice" % (where, parts[0]))
+                label = parts[1] if len(parts) > 1 else parts[0]
+                current = State(parts[0], label, where)
+                machine.states.append(current)
+            elif current is None:
+                raise SpecError("%s: '%s' outside a state" % (where, word))
+            elif word in ("entry", "exit", "during"):
+                for hook in line.split():
+                    if hook not in ("entry", "exit", "during"):
+                        raise SpecError("%s: unknown hook %s" % (where, hook))
+                    current.hooks.add(hook)
+            elif word == "final":
+                current.final = True
+            elif word == "ignore":
+                current.ignore.update(rest.split())
+            elif word == "on":
+                m = ROW_RE.match(line)
+                if not m:
+                    raise SpecError("%s: can't read transition '%s'" % (where, line))
+                row = m.groupdict()
+                row["history"] = bool(row["history"])
+                row["where"] = where
+                row["comment"] = comment
+                current.rows.append(row)
+            else:
+                raise SpecError("%s: unknown item '%s'" % (where, word))
+            comment = []
+
+    if not machine.name:
+        raise SpecError("%s: no machine name" % path)
+    if not machine.states:
+        raise SpecError("%s: no states" % path)
+    if machine.initial is None:
+        machine.initial = machine.states[0].name
+    return machine
+
+
+def check(machine):
+    """Return (errors, warnings) for a parsed machine."""
+    errors = []
+    warnings = []
+    names = [s.name for s in machine.states]
+
+    if machine.initial not in names:
+        errors.append("initial state %s doesn't exist" % machine.initial)
+
+    for s in machine.states:
+        seen_unguarded = set()
+        for row in s.rows:
+            if row["target"] and row["target"] not in names:
+                errors.append("%s: %s goes to unknown state %s" % (row["where"], row["event"], row["target"]))
+            if row["event"] in seen_unguarded:
+                errors.append("%s: %s in %s can never be taken, an unguarded row comes first" %
+                              (row["where"], row["event"], s.name))
+            if not row["guard"]:
+                seen_unguarded.add(row["event"])
+
+        handled = {row["event"] for row in s.rows}
+        for event in sorted(handled - seen_unguarded):
+            warnings.append("%s: every %s row in %s is guarded, the event can be dropped" %
+                            (s.line, event, s.name))
+        if "*" not in s.ignore:
+            missing = [e for e in machine.events if e not in handled and e not in s.ignore]
+            if missing:
+                warnings.append("%s: %s doesn't handle %s" % (s.line, s.name, ", ".join(missing)))
+
+        leaves = [row for row in s.rows if row["target"] and row["target"] != s.name]
+        if not leaves and not s.final:
+            errors.append("%s: %s is a dead state, nothing leaves it" % (s.line, s.name))
+
+    # Reachability from the initial state
+    if machine.initial in names:
+        reached = {machine.initial}
+        todo = [machine.initial]
+        while todo:
+            s = machine.state(todo.pop())
+            for row in s.rows:
+                target = row["target"]
+                if target in names and target not in reached:
+                    reached.add(target)
+                    todo.append(target)
+        for s in machine.states:
+            if s.name not in reached:
+                errors.append("%s: %s can't be reached from %s" % (s.line, s.name, machine.initial))
+
+    all_handled = {row["event"] for s in machine.states for row in s.rows}
+    for event in machine.events:
+        if event not in all_handled:
+            warnings.append("%s: no state handles %s" % (machine.path, event))
+    return errors, warnings
+
+
+def hook_name(kind, state):
+    return "%s%s" % (kind.capitalize(), state.name)
+
+
+def hook_signature(kind, name):
+    if kind == "during":
+        return "static void %s( ES_Event *Event )" % name
+    return "static void %s( const ES_Event *Event )" % name
+
+
+def referenced_functions(machine):
+    """Every hook, guard and action the tables point at, in table order."""
+    funcs = []
+    for s in machine.states:
+        for kind in ("entry", "exit", "during"):
+            if kind in s.hooks:
+                funcs.append((kind, hook_name(kind, s), s))
+    for s in machine.states:
+        for row in s.rows:
+            if row["guard"]:
+                funcs.append(("guard", row["guard"], s))
+            if row["action"]:
+                funcs.append(("action", row["action"], s))
+    unique = []
+    names = set()
+    for f in funcs:
+        if f[1] not in names:
+            names.add(f[1])
+            unique.append(f)
+    return unique
+
+
+def prototype(kind, name):
+    if kind == "guard":
+        return "static bool %s( const ES_Event *Event )" % name
+    if kind == "action":
+        return "static void %s( const ES_Event *Event )" % name
+    return hook_signature(kind, name)
+
+
+def tables(machine):
+    m = machine.name
+    out = [BEGIN_TABLES]
+    for kind, name, _ in referenced_functions(machine):
+        out.append(prototype(kind, name) + ";")
+    out.append("")
+    out.append("// Transition tables, one per state")
+    for s in machine.states:
+        table = "%sTransitions" % s.label
+        if not s.rows:
+            continue
+        out.append("static const HSM_TRANSITION_t %s[] = {" % table)
+        # Rows for an event have to be together, keep the spec order otherwise
+        order = []
+        for row in s.rows:
+            if row["event"] not in order:
+                order.append(row["event"])
+        rows = [row for event in order for row in s.rows if row["event"] == event]
+        for i, row in enumerate(rows):
+            for line in row["comment"]:
+                out.append("\t// %s" % line)
+            target = row["target"] or "HSM_INTERNAL"
+            trace = '"%s"' % row["trace"] if row["trace"] is not None else "NULL"
+            out.append("\t{%s, %s, %s, %s, %s, %s}%s" %
+                       (row["event"], target, row["guard"] or "NULL", row["action"] or "NULL",
+                        "true" if row["history"] else "false", trace, "," if i < len(rows) - 1 else ""))
+        out.append("};")
+        out.append("")
+    out.append("// Indexed by %sState" % m)
+    out.append("static const HSM_STATE_t %sStates[] = {" % m)
+    width = max(len(s.name) for s in machine.states) + 5
+    for i, s in enumerate(machine.states):
+        hooks = [hook_name(k, s) if k in s.hooks else "NULL" for k in ("entry", "exit", "during")]
+        rows = "HSM_TRANSITIONS(%sTransitions)" % s.label if s.rows else "NULL, 0"
+        index = ("[%s] =" % s.name).ljust(width)
+        out.append('\t%s {"%s", %s, %s,' % (index, s.label, hooks[0], hooks[1]))
+        out.append("\t%s  %s, %s}%s" % (" " * width, hooks[2], rows,
+                                        "," if i < len(machine.states) - 1 else ""))
+    out.append("};")
+    out.append("")
+    out.append("static uint8_t %sLookup[HSM_LOOKUP_SIZE(sizeof(%sStates)/sizeof(%sStates[0]))];" % (m, m, m))
+    out.append("static HSM_t %sHSM = HSM_MACHINE(%sStates, %sLookup);" % (m, m, m))
+    out.append(END_TABLES)
+    return "\n".join(out)
+
+
+def functions(machine):
+    m = machine.name
+    before = "\t%s(&CurrentEvent);\n" % machine.before if machine.before else ""
+    return """%s
+
+/****************************************************************************
+ Function
+     Start%s
+
+ Parameters
+     ES_Event CurrentEvent, ES_ENTRY or ES_ENTRY_HISTORY
+
+ Returns
+     None
+
+ Description
+     Starts in %s, or the last state on ES_ENTRY_HISTORY
+****************************************************************************/
+void Start%s ( ES_Event CurrentEvent )
+{
+%s\tHSM_Start(&%sHSM, %s, &CurrentEvent);
+}
+
+/****************************************************************************
+ Function
+    Run%s
+
+ Parameters
+   ES_Event : the event to process
+
+ Returns
+   ES_Event, the event passed in
+
+ Description
+   Runs the %s state machine
+****************************************************************************/
+ES_Event Run%s( ES_Event CurrentEvent )
+{
+	ES_Event ReturnEvent = CurrentEvent; // assume we are not consuming event
+%s	HSM_Run(&%sHSM, &CurrentEvent);
+	return(ReturnEvent);
+}
+
+/****************************************************************************
+ Function
+     Query%s
+
+ Parameters
+     None
+
+ Returns
+     %sState the current state
+****************************************************************************/
+%sState Query%s ( void )
+{
+	return((%sState)HSM_Query(&%sHSM));
+}
+
+%s""" % (BEGIN_FUNCTIONS, m, machine.initial, m, before, m, machine.initial,
+         m, m, m, before, m, m, m, m, m, m, m, END_FUNCTIONS)
+
+
+def stub(kind, name, state):
+    if kind == "guard":
+        body = "\treturn true;\n"
+        comment = "// Guard used by %s" % state.name
+    elif kind == "action":
+        body = ""
+        comment = "// Action used by %s" % state.name
+    else:
+        body = ""
+        comment = "// %s function for %s" % (kind.capitalize(), state.name)
+    return "%s\n%s\n{\n%s}\n" % (comment, prototype(kind, name), body)
+
+
+def header(machine):
+    m = machine.name
+    states = ", ".join(s.name for s in machine.states)
+    return """/****************************************************************************
+ Header file for %s state machine
+
+ ****************************************************************************/
+
+#ifndef %s_H
+#define %s_H
+
+typedef enum { %s } %sState ;
+
+// Public Function Prototypes
+ES_Event Run%s( ES_Event CurrentEvent );
+void Start%s ( ES_Event CurrentEvent );
+%sState Query%s ( void );
+
+#endif /*%s_H */
+""" % (m, m, m, states, m, m, m, m, m, m)
+
+
+def new_source(machine, spec):
+    description = machine.description or "%s state machine" % machine.name
+    stubs = "\n".join(stub(kind, name, s) for kind, name, s in referenced_functions(machine))
+    before = ""
+    if machine.before:
+        before = "static void %s( const ES_Event *Event );\n" % machine.before
+        stubs += "\n// Called with every event before Start%s and Run%s\nstatic void %s( const ES_Event *Event )\n{\n}\n" % (
+            machine.name, machine.name, machine.before)
+    return """/****************************************************************************
+ Module
+   %s.c
+
+ Revision			Revised by:
+	0.1.1
+
+ Description
+	%s
+
+ Edits:
+	0.1.1 - Generated by Tools/hsm_gen.py from %s
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "Headers.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+
+/*---------------------------- Module Functions ---------------------------*/
+%s
+/*---------------------------- Module Variables ---------------------------*/
+%s
+
+/*------------------------------ Module Code ------------------------------*/
+
+%s
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+
+%s""" % (machine.name, description, spec, before, tables(machine), functions(machine), stubs)
+
+
+def replace_region(text, begin, end, new, path):
+    start = text.find(begin)
+    stop = text.find(end)
+    if start < 0 or stop < start:
+        raise SpecError("%s: hsm_gen markers missing" % path)
+    return text[:start] + new + text[stop + len(end):]
+
+
+def update_source(path, machine):
+    with open(path) as f:
+        text = f.read()
+    text = replace_region(text, BEGIN_TABLES, END_TABLES, tables(machine), path)
+    text = replace_region(text, BEGIN_FUNCTIONS, END_FUNCTIONS, functions(machine), path)
+
+    # Stubs for anything the tables point at that isn't written yet
+    added = []
+    for kind, name, s in referenced_functions(machine):
+        if not re.search(r"^static\s+\w+\s+%s\s*\([^;]*$" % name, text, re.M):
+            text = text.rstrip("\n") + "\n\n" + stub(kind, name, s)
+            added.append(name)
+    with open(path, "w") as f:
+        f.write(text)
+    for name in added:
+        print("%s: added stub for %s" % (path, name))
+
+
+def check_header(path, machine):
+    with open(path) as f:
+        text = f.read()
+    m = re.search(r"typedef\s+enum\s*\{([^}]*)\}\s*%sState" % machine.name, text)
+    if not m:
+        raise SpecError("%s: no %sState enum" % (path, machine.name))
+    states = [s.strip() for s in m.group(1).split(",") if s.strip()]
+    want = [s.name for s in machine.states]
+    if states != want:
+        raise SpecError("%s: %sState is %s, the spec has %s" %
+                        (path, machine.name, ", ".join(states), ", ".join(want)))
+
+
+def update_events(path, machine):
+    """Add events the machine handles to the ES_Configure.h enum."""
+    with open(path) as f:
+        text = f.read()
+    m = re.search(r"typedef enum \{(.*?)\}\s*ES_EventTyp_t", text, re.S)
+    if not m:
+        raise SpecError("%s: can't find the event enum" % path)
+    known = set(re.findall(r"\b([A-Za-z_]\w*)\b", re.sub(r"/\*.*?\*/|//[^\n]*", "", m.group(1))))
+    wanted = machine.events + [row["event"] for s in machine.states for row in s.rows]
+    missing = []
+    for event in wanted:
+        if event not in known and event not in FRAMEWORK_EVENTS and event not in missing:
+            missing.append(event)
+    if not missing:
+        return
+
+    # New events go after the last user event, before the checkpoint ones
+    body = m.group(1)
+    anchor = body.find("//THESE ARE ONLY FOR CHECKPOINT3")
+    if anchor < 0:
+        anchor = body.find("NUM_ES_EVENTS")
+    if anchor < 0:
+        raise SpecError("%s: nowhere to add events" % path)
+    line_start = body.rfind("\n", 0, anchor) + 1
+    indent = body[line_start:anchor]
+    added = "".join("%s%s,\n" % (indent, e) for e in missing)
+    body = body[:line_start] + added + body[line_start:]
+    text = text[:m.start(1)] + body + text[m.end(1):]
+    with open(path, "w") as f:
+        f.write(text)
+    print("%s: added %s" % (path, ", ".join(missing)))
+
+
+def write_dot(path, machine):
+    out = ["digraph %s {" % machine.name,
+           "\trankdir=LR;",
+           '\tnode [shape=box, style=rounded];',
+           '\t__start [shape=point];',
+           "\t__start -> %s;" % machine.initial]
+    for s in machine.states:
+        shape = ", peripheries=2" if s.final else ""
+        out.append('\t%s [label="%s"%s];' % (s.name, s.label, shape))
+    for s in machine.states:
+        for row in s.rows:
+            label = row["event"]
+            if row["guard"]:
+                label += " [%s]" % row["guard"]
+            if row["action"]:
+                label += " / %s" % row["action"]
+            if row["history"]:
+                label += " (H)"
+            target = row["target"] or s.name
+            style = ", style=dashed" if row["internal"] else ""
+            out.append('\t%s -> %s [label="%s"%s];' % (s.name, target, label, style))
+    out.append("}")
+    with open(path, "w") as f:
+        f.write("\n".join(out) + "\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("specs", nargs="+", help=".hsm files")
+    parser.add_argument("--check", action="store_true", help="run the checks, write nothing")
+    parser.add_argument("--strict", action="store_true", help="treat warnings as errors")
+    parser.add_argument("--dot", help="write a Graphviz diagram here (one spec only)")
+    parser.add_argument("--source", default=os.path.join(ROOT, "Source"))
+    parser.add_argument("--headers", default=os.path.join(ROOT, "Headers"))
+    args = parser.parse_args()
+
+    if args.dot and len(args.specs) > 1:
+        sys.exit("--dot takes one spec")
+
+    failed = False
+    for spec in args.specs:
+        try:
+            machine = parse(spec)
+            errors, warnings = check(machine)
+            for w in warnings:
+                print("warning: %s" % w)
+            for e in errors:
+                print("error: %s" % e)
+            if errors or (args.strict and warnings):
+                failed = True
+                continue
+            if args.dot:
+                write_dot(args.dot, machine)
+            if args.check:
+                continue
+
+            source = os.path.join(args.source, "%s.c" % machine.name)
+            header_path = os.path.join(args.headers, "%s.h" % machine.name)
+            rel_spec = os.path.relpath(spec, ROOT).replace(os.sep, "/")
+            if os.path.exists(header_path):
+                check_header(header_path, machine)
+            else:
+                with open(header_path, "w") as f:
+                    f.write(header(machine))
+                print("wrote %s" % header_path)
+            if os.path.exists(source):
+                update_source(source, machine)
+            else:
+                with open(source, "w") as f:
+                    f.write(new_source(machine, rel_spec))
+                print("wrote %s" % source)
+            update_events(os.path.join(args.headers, "ES_Configure.h"), machine)
+        except SpecError as e:
+            print("error: %s" % e)
+            failed = True
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
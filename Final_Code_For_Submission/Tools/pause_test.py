@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+"""Checks on the kart that a caution pauses path following and the flag resumes it.
+
+Run it with the kart racing on the field. Once telemetry shows the kart in
+FollowingPathState this posts CautionFlagDropped, checks the kart pauses
+with its motors off and still in FollowingPathState, then posts FlagDropped
+and checks the motors are driven again. Before the fix for this a caution
+while following the path left the kart stopped for the rest of the race.
+
+Usage:
+    python3 Tools/pause_test.py --port COM4
+    python3 Tools/pause_test.py --port COM4 --pause 5
+
+Uses the link in console.py, so needs pyserial too. Exits 1 if a check fails.
+"""
+
+import argparse
+import sys
+import time
+
+from console import ConsoleError, Kart, Link
+
+# GamePlayState in GamePlay.h, DrivingState in Driving.h
+RUNNING, PAUSED = 0, 1
+FOLLOWING_PATH = 4
+
+CHANNELS = {"masterstate": 1, "drivingstate": 1, "portduty": 1, "stbdduty": 1}
+
+
+class Watcher:
+    """Keeps the newest telemetry values and waits for conditions on them."""
+
+    def __init__(self, kart):
+        self.kart = kart
+        self.values = {}
+        kart.link.on_telemetry = self._frame
+
+    def _frame(self, frame):
+        seq, ticks, values = frame
+        for channel, value in values.items():
+            self.values[self.kart.channels[channel]] = value
+
+    def game(self):
+        return self.values.get("masterstate", 0) >> 8
+
+    def driving(self):
+        return self.values.get("drivingstate")
+
+    def driven(self):
+        return self.values.get("portduty", 0) != 0 or self.values.get("stbdduty", 0) != 0
+
+    def wait(self, check, timeout):
+        deadline = time.monotonic() + timeout
+        while time.monotonic() < deadline:
+            self.kart.link.poll()
+            if self.values and check():
+                return True
+        return False
+
+
+def expect(ok, what):
+    print("%-50s %s" % (what, "ok" if ok else "FAILED"))
+    if not ok:
+        raise SystemExit(1)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", required=True)
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--pause", type=float, default=2.0, help="seconds to hold the caution")
+    parser.add_argument("--wait", type=float, default=60.0, help="seconds to wait for path following")
+    args = parser.parse_args()
+
+    link = Link(args.port, args.baud, log=sys.stderr)
+    try:
+        kart = Kart(link)
+        watch = Watcher(kart)
+        kart.telemetry(CHANNELS)
+
+        print("waiting for the kart to follow the path")
+        expect(watch.wait(lambda: watch.game() == RUNNING and watch.driving() == FOLLOWING_PATH, args.wait),
+               "following the path")
+
+        kart.post("CautionFlagDropped")
+        expect(watch.wait(lambda: watch.game() == PAUSED and not watch.driven(), 0.5),
+               "paused with the motors off")
+        expect(not watch.wait(watch.driven, args.pause), "motors stay off for the caution")
+        expect(watch.driving() == FOLLOWING_PATH, "still in FollowingPathState")
+
+        kart.post("FlagDropped")
+        expect(watch.wait(lambda: watch.game() == RUNNING, 0.5), "running again")
+        # Leaving FollowingPathState for stop-turn-drive is fine, sitting in
+        # it with the motors off is the stall
+        expect(watch.wait(lambda: watch.driven() or watch.driving() != FOLLOWING_PATH, 1.0),
+               "path following picked up again")
+    except ConsoleError as e:
+        sys.exit("error: %s" % e)
+    finally:
+        try:
+            link.on_telemetry = None
+            kart.stop_telemetry()
+        except (ConsoleError, NameError):
+            pass
+        link.close()
+
+
+if __name__ == "__main__":
+    main()
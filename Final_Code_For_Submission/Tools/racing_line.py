@@ -0,0 +1,249 @@
+#!/usr/bin/env python3
+"""Regenerate the racing line table from the Points.h constants.
+
+The lap runs BL -> BR -> TR -> TL -> BL (BottomStraight, RightStraight,
+TopStraight, LeftStraight). Each corner is rounded off with an arc of
+--radius pixels, and each section owns the straight plus the arc at its
+far end. The samples are evenly spaced in arc length within a section.
+
+Speeds are a fraction of the half-speed duty, which matches SetWheelSpeeds
+in Drive.c. They are limited by lateral acceleration in the arcs and by
+--accel along the loop in both directions, so the kart brakes before
+corners.
+
+The pixel speed of the kart is PIXELS_PER_3SEC_DEFAULT from PWM.h, the
+default of the pixels3s calibration. The table is only as good as that
+default: if the kart is recalibrated to a different speed for good, change
+the default and regenerate the table.
+
+Usage:
+    python3 Tools/racing_line.py                 # rewrite Source/RacingLineTable.c
+    python3 Tools/racing_line.py --svg line.svg  # also render for review
+"""
+
+import argparse
+import math
+import os
+import re
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.dirname(HERE)
+
+SAMPLES = 32
+SECTION_NAMES = ["BottomStraight", "RightStraight", "TopStraight", "LeftStraight"]
+
+
+def read_defines(path):
+    """Return the integer #defines in a header."""
+    defines = {}
+    with open(path) as f:
+        for line in f:
+            m = re.match(r"\s*#define\s+(\w+)\s+\(?(-?\d+)\)?", line)
+            if m:
+                defines[m.group(1)] = int(m.group(2))
+    return defines
+
+
+def unit(dx, dy):
+    length = math.hypot(dx, dy)
+    return dx / length, dy / length, length
+
+
+def heading(dx, dy):
+    """Kart theta for a direction, the heading vector is (-cos, sin)."""
+    return math.degrees(math.atan2(dy, -dx)) % 360
+
+
+def build_line(points, radius, samples):
+    """Sample the rounded loop, returning per-section starts and samples."""
+    n = len(points)
+    legs = []
+    for i in range(n):
+        ax, ay = points[i]
+        bx, by = points[(i + 1) % n]
+        legs.append(unit(bx - ax, by - ay))
+
+    # Tangent offset and turn for the corner at the end of every leg
+    corners = []
+    for i in range(n):
+        ux, uy, _ = legs[i]
+        wx, wy, _ = legs[(i + 1) % n]
+        cross = ux * wy - uy * wx
+        turn = math.atan2(cross, ux * wx + uy * wy)
+        corners.append((radius * math.tan(abs(turn) / 2), turn))
+
+    sections = []
+    for i in range(n):
+        ax, ay = points[i]
+        ux, uy, length = legs[i]
+        start_offset = corners[i - 1][0]
+        end_offset, turn = corners[i]
+        straight = length - start_offset - end_offset
+        if straight < 0:
+            sys.exit("radius too large for leg %d" % i)
+        arc = radius * abs(turn)
+        total = straight + arc
+        spacing = total / samples
+
+        # Kart theta increases when the path turns clockwise in x/y
+        theta_sign = -1 if turn > 0 else 1
+        sx = ax + ux * start_offset
+        sy = ay + uy * start_offset
+        ex = sx + ux * straight
+        ey = sy + uy * straight
+        # Arc centre is to the inside of the turn
+        side = 1 if turn > 0 else -1
+        cx = ex - uy * radius * side
+        cy = ey + ux * radius * side
+
+        pts = []
+        for k in range(samples):
+            s = k * spacing
+            if s <= straight:
+                x = sx + ux * s
+                y = sy + uy * s
+                dx, dy = ux, uy
+                curvature = 0.0
+            else:
+                phi = (s - straight) / radius * side
+                rx = ex - cx
+                ry = ey - cy
+                x = cx + rx * math.cos(phi) - ry * math.sin(phi)
+                y = cy + rx * math.sin(phi) + ry * math.cos(phi)
+                dx = ux * math.cos(phi) - uy * math.sin(phi)
+                dy = ux * math.sin(phi) + uy * math.cos(phi)
+                curvature = theta_sign / radius
+            pts.append({"x": x, "y": y, "heading": heading(dx, dy),
+                        "curvature": curvature, "s": s})
+        sections.append({"start": (sx, sy), "dir": (ux, uy),
+                         "spacing": spacing, "points": pts})
+    return sections
+
+
+def plan_speeds(sections, max_speed, lat_accel, accel, half_speed):
+    """Fill in speeds limited by lateral and longitudinal acceleration."""
+    flat = [p for sec in sections for p in sec["points"]]
+    gaps = [sec["spacing"] for sec in sections for _ in sec["points"]]
+    count = len(flat)
+
+    # Speeds are planned in pixels/sec and stored as a fraction of half speed
+    limit = max_speed * half_speed
+    for p in flat:
+        v = limit
+        if p["curvature"] != 0:
+            v = min(v, math.sqrt(lat_accel / abs(p["curvature"])))
+        p["v"] = v
+
+    # Run the accel limit forwards and backwards around the loop twice so
+    # the wrap from the last section to the first settles
+    for _ in range(2):
+        for i in range(count):
+            prev = flat[i - 1]
+            reach = math.sqrt(prev["v"] ** 2 + 2 * accel * gaps[i - 1])
+            flat[i]["v"] = min(flat[i]["v"], reach)
+        for i in range(count - 1, -1, -1):
+            nxt = flat[(i + 1) % count]
+            reach = math.sqrt(nxt["v"] ** 2 + 2 * accel * gaps[i])
+            flat[i]["v"] = min(flat[i]["v"], reach)
+
+    for p in flat:
+        p["speed"] = p["v"] / half_speed
+
+
+def write_table(path, sections, args):
+    lines = []
+    lines.append("/****************************************************************************")
+    lines.append(" Module")
+    lines.append("\tRacingLineTable.c")
+    lines.append("")
+    lines.append(" Description")
+    lines.append("\tGenerated by Tools/racing_line.py from the Points.h waypoints, do not edit")
+    lines.append("\tby hand. Corner radius %g px, max speed %g, lateral accel %g px/s^2," %
+                 (args.radius, args.max_speed, args.lat_accel))
+    lines.append("\taccel %g px/s^2. Speeds assume the default speed calibration," % args.accel)
+    lines.append("\tPIXELS_PER_3SEC_DEFAULT in PWM.h.")
+    lines.append("****************************************************************************/")
+    lines.append("")
+    lines.append('#include "Headers.h"')
+    lines.append("")
+    lines.append("const RACING_SECTION_t RacingLineSections[RACING_LINE_SECTIONS] = {")
+    for name, sec in zip(SECTION_NAMES, sections):
+        lines.append("\t// %s" % name)
+        lines.append("\t{%.2ff, %.2ff, %.4ff, %.4ff, %.3ff}," %
+                     (sec["start"][0], sec["start"][1], sec["dir"][0], sec["dir"][1], sec["spacing"]))
+    lines.append("};")
+    lines.append("")
+    lines.append("const RACING_POINT_t RacingLine[RACING_LINE_SECTIONS][RACING_LINE_SAMPLES] = {")
+    for name, sec in zip(SECTION_NAMES, sections):
+        lines.append("\t// %s" % name)
+        lines.append("\t{")
+        for p in sec["points"]:
+            lines.append("\t\t{%.2ff, %.2ff, %.1ff, %.5ff, %.3ff}," %
+                         (p["x"], p["y"], p["heading"], p["curvature"], p["speed"]))
+        lines.append("\t},")
+    lines.append("};")
+    with open(path, "w") as f:
+        f.write("\n".join(lines) + "\n")
+
+
+def write_svg(path, sections, d, points):
+    scale = 3
+    width = 260 * scale
+    height = 190 * scale
+    out = ['<svg xmlns="http://www.w3.org/2000/svg" width="%d" height="%d">' % (width, height),
+           '<rect width="100%" height="100%" fill="white"/>']
+    # Inner square and decision zones
+    out.append('<rect x="%d" y="%d" width="%d" height="%d" fill="#ddd" stroke="black"/>' %
+               (d["x1"] * scale, d["y1"] * scale, (d["x2"] - d["x1"]) * scale, (d["y2"] - d["y1"]) * scale))
+    out.append('<rect x="0" y="%d" width="%d" height="%d" fill="#fdd" opacity="0.5"/>' %
+               (d["SDZ_Ymin"] * scale, d["SDZ_X"] * scale, (d["SDZ_Ymax"] - d["SDZ_Ymin"]) * scale))
+    out.append('<rect x="%d" y="%d" width="%d" height="%d" fill="#ddf" opacity="0.5"/>' %
+               (d["ODZ_Xmin"] * scale, d["ODZ_Y"] * scale, (d["ODZ_Xmax"] - d["ODZ_Xmin"]) * scale,
+                (190 - d["ODZ_Y"]) * scale))
+    # Waypoint polygon
+    poly = " ".join("%g,%g" % (x * scale, y * scale) for x, y in points)
+    out.append('<polygon points="%s" fill="none" stroke="#999" stroke-dasharray="4"/>' % poly)
+    # Racing line coloured by speed, red is slow and green is fast
+    flat = [p for sec in sections for p in sec["points"]]
+    top = max(p["speed"] for p in flat)
+    for i, p in enumerate(flat):
+        q = flat[(i + 1) % len(flat)]
+        g = int(255 * p["speed"] / top)
+        out.append('<line x1="%g" y1="%g" x2="%g" y2="%g" stroke="rgb(%d,%d,0)" stroke-width="3"/>' %
+                   (p["x"] * scale, p["y"] * scale, q["x"] * scale, q["y"] * scale, 255 - g, g))
+    # Section starts and waypoints
+    for name, sec in zip(SECTION_NAMES, sections):
+        x, y = sec["start"]
+        out.append('<circle cx="%g" cy="%g" r="4" fill="black"/>' % (x * scale, y * scale))
+        out.append('<text x="%g" y="%g" font-size="12">%s</text>' % (x * scale + 6, y * scale - 6, name))
+    out.append("</svg>")
+    with open(path, "w") as f:
+        f.write("\n".join(out) + "\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--radius", type=float, default=30, help="corner radius in pixels")
+    parser.add_argument("--max-speed", type=float, default=1.0, help="cruise speed, fraction of half speed")
+    parser.add_argument("--lat-accel", type=float, default=18, help="lateral accel limit, pixels/s^2")
+    parser.add_argument("--accel", type=float, default=150, help="accel/brake limit, pixels/s^2")
+    parser.add_argument("--out", default=os.path.join(ROOT, "Source", "RacingLineTable.c"))
+    parser.add_argument("--svg", help="also render the line to this SVG file")
+    args = parser.parse_args()
+
+    d = read_defines(os.path.join(ROOT, "Headers", "Points.h"))
+    pwm = read_defines(os.path.join(ROOT, "Headers", "PWM.h"))
+    half_speed = pwm["PIXELS_PER_3SEC_DEFAULT"] / 3.0
+
+    points = [(d["BL_X"], d["BL_Y"]), (d["BR_X"], d["BR_Y"]),
+              (d["TR_X"], d["TR_Y"]), (d["TL_X"], d["TL_Y"])]
+    sections = build_line(points, args.radius, SAMPLES)
+    plan_speeds(sections, args.max_speed, args.lat_accel, args.accel, half_speed)
+    write_table(args.out, sections, args)
+    if args.svg:
+        write_svg(args.svg, sections, d, points)
+
+
+if __name__ == "__main__":
+    main()
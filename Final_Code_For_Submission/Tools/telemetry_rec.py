@@ -0,0 +1,61 @@
+#!/usr/bin/env python3
+"""Records kart telemetry to a CSV file.
+
+One row per telemetry frame: sequence number, kart time (ES timer ticks,
+976 to the second), then a column for each recorded channel, blank where
+the channel wasn't in that frame.
+Missing frames (sequence gaps) are counted on stderr as they happen and in
+the summary at the end. Ctrl-C stops the recording and the telemetry.
+
+Usage:
+    python3 Tools/telemetry_rec.py --port COM4 -o run1.csv kartx=1,karty=1,portduty=1,battery=50
+
+Uses the link in console.py, so needs pyserial too.
+"""
+
+import argparse
+import csv
+import sys
+
+from console import ConsoleError, Kart, Link, parse_rates
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", required=True)
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("-o", "--output", required=True, help="CSV file to write")
+    parser.add_argument("channels", help="CHANNEL[=N][,CHANNEL[=N]...], N is the decimation")
+    args = parser.parse_args()
+
+    rates = parse_rates(args.channels)
+    link = Link(args.port, args.baud, log=sys.stderr)
+    frames = missing = 0
+    try:
+        kart = Kart(link)
+        columns = [c for c in kart.channels if c in rates]
+        with open(args.output, "w", newline="") as f:
+            out = csv.writer(f)
+            out.writerow(["seq", "ticks"] + columns)
+            last = [None]
+
+            def record(seq, ticks, values):
+                nonlocal frames, missing
+                if last[0] is not None and seq != (last[0] + 1) & 0xFFFF:
+                    gap = (seq - last[0] - 1) & 0xFFFF
+                    missing += gap
+                    sys.stderr.write("%d frames missing before %d\n" % (gap, seq))
+                last[0] = seq
+                frames += 1
+                out.writerow([seq, ticks] + [values.get(c, "") for c in columns])
+
+            kart.watch(rates, record)
+    except ConsoleError as e:
+        sys.exit("error: %s" % e)
+    finally:
+        link.close()
+    print("%d frames, %d missing" % (frames, missing), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()